@@ -0,0 +1,335 @@
+#include "AIPlayer.h"
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+
+const std::chrono::microseconds AIPlayer::DEFAULT_TIME_BUDGET{ 1000 };
+
+namespace
+{
+	// the score of a dead end (a board the game can't go on from)
+	const double LOSING_SCORE = std::numeric_limits<double>::lowest();
+
+	// a shape at the spawn location
+	GridTetromino getSpawnShape(const Gameboard& board, TetShape shape)
+	{
+		GridTetromino spawned;
+		spawned.setShape(shape);
+		spawned.setGridLoc(board.getSpawnLoc());
+		return spawned;
+	}
+
+	// true if a shape can spawn on a board (like TetrisEngine::spawnNextShape())
+	bool canSpawn(const Gameboard& board, TetShape shape)
+	{
+		for (const Point& p : getSpawnShape(board, shape).getMappedBlockLocs())
+		{
+			if (p.getX() < 0 || p.getX() >= Gameboard::MAX_X || p.getY() >= Gameboard::MAX_Y || board.isOccupied(p.getX(), p.getY()))
+				return false;
+		}
+		return true;
+	}
+
+	// true if two shapes are at the same location & rotation
+	bool isSameState(const GridTetromino& a, const GridTetromino& b)
+	{
+		return a.getRotation() == b.getRotation() &&
+			a.getGridLoc().getX() == b.getGridLoc().getX() && a.getGridLoc().getY() == b.getGridLoc().getY();
+	}
+
+	// true if two placements cover the same cells (eg: an O, or an I rotated twice)
+	bool isSamePlacement(const MoveGenerator::Placement& a, const MoveGenerator::Placement& b)
+	{
+		const BlockList aBlocks = MoveGenerator::toGridTetromino(a).getMappedBlockLocs();
+		const BlockList bBlocks = MoveGenerator::toGridTetromino(b).getMappedBlockLocs();
+		for (const Point& p : aBlocks)
+		{
+			bool found = false;
+			for (const Point& q : bBlocks)
+			{
+				found = found || (p.getX() == q.getX() && p.getY() == q.getY());
+			}
+			if (!found)
+				return false;
+		}
+		return true;
+	}
+}
+
+// constructor
+// - param 1: the number of search threads (0 to use every hardware thread, 1 to search
+//            on the calling thread, eg: when many games are played at once)
+// - param 2: the beam width (the placements of the current shape searched deeper)
+// - param 3: the time a move may take (0: no limit, the search is then deterministic)
+// - param 4: the EvaluationWeights boards are scored with
+// - param 5: the log2 of the number of transposition table entries (0: no table)
+AIPlayer::AIPlayer(int searchThreads, int beamWidth, std::chrono::microseconds timeBudget, const EvaluationWeights& weights,
+	int transpositionTableBits) :
+	weights{ weights }, beamWidth{ std::max(1, beamWidth) }, timeBudget{ timeBudget }
+{
+	if (searchThreads != 1)
+		pool.reset(new WorkStealingPool(searchThreads));
+	if (transpositionTableBits > 0)
+		table.reset(new TranspositionTable(transpositionTableBits));
+	generators.resize(pool ? pool->getThreadCount() : 1);
+}
+
+// get ready for a new game (forget the plan)
+// - param 1: a 64 bit seed (not used, the bot is deterministic)
+// - return: nothing
+void AIPlayer::reset(std::uint64_t)
+{
+	placementsSeen = -1;
+	hasPlan = false;
+	path.clear();
+	pathIndex = 0;
+}
+
+// pick the next action: plan a placement for every new shape, then follow its path
+// - param 1: the engine (the game being played)
+// - return: a GameAction
+GameAction AIPlayer::chooseAction(const TetrisEngine& engine)
+{
+	if (engine.isGameOver())
+		return GameAction::NONE;
+
+	if (engine.getPlacementCount() != placementsSeen || !hasPlan || pathIndex >= path.size())
+	{
+		placementsSeen = engine.getPlacementCount();
+		hasPlan = choosePlacement(engine);
+	}
+	else if (!isSameState(engine.getCurrentShape(), expected) && !repath(engine))
+	{
+		// the shape fell past the target: choose again from where it is
+		hasPlan = choosePlacement(engine);
+	}
+	if (!hasPlan)
+		return GameAction::HARD_DROP;
+
+	// where the shape will be once the action is applied (unless a tick moves it too)
+	const GameAction action = path[pathIndex++];
+	switch (action)
+	{
+	case GameAction::MOVE_LEFT:
+		expected.move(-1, 0);
+		break;
+	case GameAction::MOVE_RIGHT:
+		expected.move(1, 0);
+		break;
+	case GameAction::ROTATE:
+		expected.rotateClockwise();
+		break;
+	case GameAction::SOFT_DROP:
+		expected.move(0, 1);
+		break;
+	default:
+		break;
+	}
+	return action;
+}
+
+// choose the placement of the engine's current shape (the beam search)
+// - param 1: the engine
+// - return: bool, false if the current shape has no placement
+bool AIPlayer::choosePlacement(const TetrisEngine& engine)
+{
+	const auto deadline = std::chrono::steady_clock::now() + timeBudget;
+	const bool limited = (timeBudget.count() > 0);
+	const Gameboard& board = engine.getBoard();
+	const TetShape nextShape = engine.getNextShape().getShape();
+
+	// score every placement of the current shape
+	const int count = rootGenerator.generate(board, engine.getCurrentShape());
+	if (count == 0)
+		return false;
+	candidates.clear();
+	candidates.reserve(count);
+	order.clear();
+	std::uint64_t evaluationCount = 0;
+	for (const MoveGenerator::Placement& placement : rootGenerator.getPlacements())
+	{
+		order.push_back(static_cast<int>(candidates.size()));
+		candidates.push_back(Candidate{ placement, board, 0, LOSING_SCORE, LOSING_SCORE, false });
+		Candidate& candidate = candidates.back();
+		if (applyPlacement(candidate.board, placement, &nextShape, candidate.linesCleared))
+			candidate.score = scorePlacement(board, placement, evaluationCount, &candidate.board, candidate.linesCleared);
+	}
+	evaluations.fetch_add(evaluationCount, std::memory_order_relaxed);
+	std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+		return candidates[a].score > candidates[b].score;
+	});
+
+	// search the best ones deeper with the next shape (as long as there is time)
+	const int beam = std::min(beamWidth, count);
+	auto expandBeamEntry = [&](std::int64_t i, int worker) {
+		Candidate& candidate = candidates[order[i]];
+		if (candidate.score == LOSING_SCORE || (limited && std::chrono::steady_clock::now() >= deadline))
+			return;
+		expand(candidate, nextShape, generators[worker]);
+	};
+	if (pool)
+		pool->parallelFor(beam, expandBeamEntry);
+	else
+	{
+		for (int i = 0; i < beam; i++)
+		{
+			expandBeamEntry(i, 0);
+		}
+	}
+
+	// the best expanded candidate (or the best one, if there was no time to expand any)
+	int best = order[0];
+	bool bestExpanded = false;
+	for (int i = 0; i < beam; i++)
+	{
+		const Candidate& candidate = candidates[order[i]];
+		if (candidate.expanded && (!bestExpanded || candidate.bestNextScore > candidates[best].bestNextScore))
+		{
+			best = order[i];
+			bestExpanded = true;
+		}
+	}
+
+	target = candidates[best].placement;
+	rootGenerator.getPath(target, path);
+	pathIndex = 0;
+	expected = engine.getCurrentShape();
+	return true;
+}
+
+// the placement being played (valid after choosePlacement() returned true)
+const MoveGenerator::Placement& AIPlayer::getTarget() const
+{
+	return target;
+}
+
+// the number of boards scored since the bot was made (the boards whose score
+// was found in the transposition table aren't counted)
+std::uint64_t AIPlayer::getEvaluationCount() const
+{
+	return evaluations.load(std::memory_order_relaxed);
+}
+
+// score a board
+// - param 1: the board
+// - param 2: the rows removed on the way to the board
+// - param 3: the EvaluationWeights
+// - return: double, the score (higher is better)
+double AIPlayer::evaluate(const Gameboard& board, int linesCleared, const EvaluationWeights& weights)
+{
+	int aggregateHeight = 0;
+	int bumpiness = 0;
+	int wells = 0;
+	for (int x = 0; x < Gameboard::MAX_X; x++)
+	{
+		const int height = board.getColumnHeight(x);
+		aggregateHeight += height;
+		if (x + 1 < Gameboard::MAX_X)
+			bumpiness += std::abs(height - board.getColumnHeight(x + 1));
+
+		// the walls are as high as the board
+		const int left = (x > 0) ? board.getColumnHeight(x - 1) : Gameboard::MAX_Y;
+		const int right = (x + 1 < Gameboard::MAX_X) ? board.getColumnHeight(x + 1) : Gameboard::MAX_Y;
+		const int depth = std::min(left, right) - height;
+		if (depth > 0)
+			wells += depth;
+	}
+	return weights.aggregateHeight * aggregateHeight + weights.holes * board.getHoleCount() +
+		weights.bumpiness * bumpiness + weights.wells * wells + weights.completedLines * linesCleared;
+}
+
+// lock a placement onto a board & remove the completed rows
+// - param 1: the board (the placement's board, changed to the board after it)
+// - param 2: the placement
+// - param 3: the shape that spawns next (spawning is tested before the rows are
+//            removed, like TetrisEngine), or nullptr not to test it
+// - param 4: the rows the placement removed
+// - return: bool, false if the next shape can't spawn (the game would be over)
+bool AIPlayer::applyPlacement(Gameboard& board, const MoveGenerator::Placement& placement,
+	const TetShape* nextShape, int& linesCleared)
+{
+	board.setContent(MoveGenerator::toGridTetromino(placement).getMappedBlockLocs(),
+		static_cast<int>(Tetromino::getShapeColor(placement.shape)));
+	linesCleared = 0;
+	if (nextShape && !canSpawn(board, *nextShape))
+		return false;
+	linesCleared = board.removeCompletedRows();
+	return true;
+}
+
+// score the next shape's placements on a candidate's board (one search thread)
+// - param 1: the candidate
+// - param 2: the next shape
+// - param 3: the worker's MoveGenerator
+// - return: nothing
+void AIPlayer::expand(Candidate& candidate, TetShape nextShape, MoveGenerator& generator) const
+{
+	candidate.bestNextScore = LOSING_SCORE;
+	generator.generate(candidate.board, getSpawnShape(candidate.board, nextShape));
+	std::uint64_t evaluationCount = 0;
+	for (const MoveGenerator::Placement& placement : generator.getPlacements())
+	{
+		candidate.bestNextScore = std::max(candidate.bestNextScore, scorePlacement(candidate.board, placement, evaluationCount));
+	}
+	// the candidate's rows count too
+	candidate.bestNextScore += weights.completedLines * candidate.linesCleared;
+	candidate.expanded = true;
+	evaluations.fetch_add(evaluationCount, std::memory_order_relaxed);
+}
+
+// the score of the board a placement makes, from the table if it's there
+//   (the score counts the rows the placement removes, not those removed before it)
+// - param 1: the board
+// - param 2: the placement
+// - param 3: the evaluations made (incremented unless the table had the score)
+// - param 4: the board after the placement (rows removed) if it's already made, or
+//            nullptr to make it here
+// - param 5: the rows the placement removed (with param 4)
+// - return: double, the score
+double AIPlayer::scorePlacement(const Gameboard& board, const MoveGenerator::Placement& placement, std::uint64_t& evaluationCount,
+	const Gameboard* placed, int placedLinesCleared) const
+{
+	// the board before its rows are removed decides the board after (& the rows removed)
+	std::uint64_t key = 0;
+	double score;
+	if (table)
+	{
+		key = TranspositionTable::makeKey(board.getHashWith(MoveGenerator::toGridTetromino(placement).getMappedBlockLocs()));
+		if (table->probe(key, score))
+			return score;
+	}
+
+	if (placed)
+		score = evaluate(*placed, placedLinesCleared, weights);
+	else
+	{
+		Gameboard child = board;
+		int linesCleared = 0;
+		applyPlacement(child, placement, nullptr, linesCleared);
+		score = evaluate(child, linesCleared, weights);
+	}
+	evaluationCount++;
+	if (table)
+		table->store(key, score);
+	return score;
+}
+
+// search the path to the target again, from where the shape is now
+// - param 1: the engine
+// - return: bool, false if the target can't be reached anymore
+bool AIPlayer::repath(const TetrisEngine& engine)
+{
+	rootGenerator.generate(engine.getBoard(), engine.getCurrentShape());
+	for (const MoveGenerator::Placement& placement : rootGenerator.getPlacements())
+	{
+		if (isSamePlacement(placement, target))
+		{
+			target = placement;
+			rootGenerator.getPath(target, path);
+			pathIndex = 0;
+			expected = engine.getCurrentShape();
+			return true;
+		}
+	}
+	return false;
+}
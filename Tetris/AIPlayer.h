@@ -0,0 +1,170 @@
+// The AIPlayer class is a bot (a GamePolicy) that plays by evaluating boards.
+//
+// A board is scored with a weighted sum of features computed from the Gameboard:
+// the aggregate (column) height, the holes, the bumpiness (the height differences of
+// neighbouring columns), the wells (columns lower than both neighbours) and the rows
+// the placements completed.
+//
+// When a new shape appears, every placement of the current shape (see MoveGenerator)
+// is locked onto a copy of the board & scored, and the best few (the beam) are
+// searched one shape deeper with the visible next shape.  The beam is spread over
+// worker threads, and the search stops expanding once its time budget is spent (the
+// best result found so far is used), so a move is always chosen in about a millisecond.
+//
+// The bot then plays the chosen placement's path one action per frame.  If gravity
+// (or anything else) moved the shape off the path, the path to the same placement is
+// searched again from where the shape is (or, if it can't be reached anymore, a new
+// placement is chosen).
+//
+// Boards are reached more than once: the boards the next shape's placements make are
+// the boards the following move starts from, and two shapes of the same kind make the
+// same board when placed in either order.  So the scores of the boards searched can be
+// kept in a TranspositionTable (keyed on the board before its completed rows are
+// removed, so a hit skips building the board too), shared by the search threads.
+// It saves about 1 evaluation in 10, but a lookup costs about as much as these
+// evaluations do, so it is off by default (it pays off when a board costs more to score).
+//
+// An AIPlayer can drive a TetrisGame (instead of the keyboard) or run headless
+// (eg: in a BatchSimulator, with one search thread per game).
+
+#ifndef AIPLAYER_H
+#define AIPLAYER_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include "GamePolicy.h"
+#include "Gameboard.h"
+#include "MoveGenerator.h"
+#include "TetrisEngine.h"
+#include "TranspositionTable.h"
+#include "WorkStealingPool.h"
+
+// the weight of each board feature (a board's score is the weighted sum, higher is better)
+struct EvaluationWeights
+{
+	double aggregateHeight{ -0.510066 };	// the sum of the column heights
+	double holes{ -0.35663 };				// the empty cells with a block above them
+	double bumpiness{ -0.184483 };			// the sum of the height differences of neighbouring columns
+	double wells{ -0.1 };					// the sum of the well depths (columns lower than both neighbours)
+	double completedLines{ 0.760666 };		// the rows removed on the way to the board
+};
+
+class AIPlayer : public GamePolicy
+{
+public:
+	// CONSTANTS
+	static const int DEFAULT_BEAM_WIDTH{ 12 };				// the placements of the current shape searched deeper
+	static const std::chrono::microseconds DEFAULT_TIME_BUDGET;	// the time a move may take, init to 1 ms
+
+private:
+	// a placement of the current shape, on the board it leaves
+	struct Candidate
+	{
+		MoveGenerator::Placement placement;
+		Gameboard board;		// the board after the placement (rows removed)
+		int linesCleared;		// the rows the placement removed
+		double score;			// the board's score
+		double bestNextScore;	// the best score of the next shape's placements on the board
+		bool expanded;			// true once the next shape's placements have been scored
+	};
+
+	// MEMBER VARIABLES
+	EvaluationWeights weights;					// how boards are scored
+	int beamWidth;								// the candidates searched with the next shape
+	std::chrono::microseconds timeBudget;		// the time a move may take (0: no limit)
+
+	std::unique_ptr<WorkStealingPool> pool;		// the search threads (none when searching on 1 thread)
+	MoveGenerator rootGenerator;				// the current shape's placements & paths
+	std::vector<MoveGenerator> generators;		// a generator per search thread (for the next shape)
+	std::vector<Candidate> candidates;			// the current shape's placements
+	std::vector<int> order;						// the candidates' indices, best score first
+	std::unique_ptr<TranspositionTable> table;	// the scores of the boards searched (none if disabled)
+	mutable std::atomic<std::uint64_t> evaluations{ 0 };	// the boards scored (not found in the table)
+
+	int placementsSeen{ -1 };					// the engine's placement count when the plan was made
+	bool hasPlan{ false };						// true while following a path
+	MoveGenerator::Placement target;			// the placement being played
+	std::vector<GameAction> path;				// the actions that reach the target
+	std::size_t pathIndex{ 0 };					// the next action of the path
+	GridTetromino expected;						// where the shape should be if the path is on track
+
+public:
+	// constructor
+	// - param 1: the number of search threads (0 to use every hardware thread, 1 to search
+	//            on the calling thread, eg: when many games are played at once)
+	// - param 2: the beam width (the placements of the current shape searched deeper)
+	// - param 3: the time a move may take (0: no limit, the search is then deterministic)
+	// - param 4: the EvaluationWeights boards are scored with
+	// - param 5: the log2 of the number of transposition table entries (0: no table)
+	AIPlayer(int searchThreads = 1, int beamWidth = DEFAULT_BEAM_WIDTH,
+		std::chrono::microseconds timeBudget = DEFAULT_TIME_BUDGET, const EvaluationWeights& weights = EvaluationWeights(),
+		int transpositionTableBits = 0);
+
+	// get ready for a new game (forget the plan)
+	// - param 1: a 64 bit seed (not used, the bot is deterministic)
+	// - return: nothing
+	void reset(std::uint64_t seed) override;
+
+	// pick the next action: plan a placement for every new shape, then follow its path
+	// - param 1: the engine (the game being played)
+	// - return: a GameAction
+	GameAction chooseAction(const TetrisEngine& engine) override;
+
+	// choose the placement of the engine's current shape (the beam search)
+	// - param 1: the engine
+	// - return: bool, false if the current shape has no placement
+	bool choosePlacement(const TetrisEngine& engine);
+
+	// the placement being played (valid after choosePlacement() returned true)
+	const MoveGenerator::Placement& getTarget() const;
+
+	// the number of boards scored since the bot was made (the boards whose score
+	// was found in the transposition table aren't counted)
+	std::uint64_t getEvaluationCount() const;
+
+	// score a board
+	// - param 1: the board
+	// - param 2: the rows removed on the way to the board
+	// - param 3: the EvaluationWeights
+	// - return: double, the score (higher is better)
+	static double evaluate(const Gameboard& board, int linesCleared, const EvaluationWeights& weights);
+
+	// lock a placement onto a board & remove the completed rows
+	// - param 1: the board (the placement's board, changed to the board after it)
+	// - param 2: the placement
+	// - param 3: the shape that spawns next (spawning is tested before the rows are
+	//            removed, like TetrisEngine), or nullptr not to test it
+	// - param 4: the rows the placement removed
+	// - return: bool, false if the next shape can't spawn (the game would be over)
+	static bool applyPlacement(Gameboard& board, const MoveGenerator::Placement& placement,
+		const TetShape* nextShape, int& linesCleared);
+
+private:
+	// the score of the board a placement makes, from the table if it's there
+	//   (the score counts the rows the placement removes, not those removed before it)
+	// - param 1: the board
+	// - param 2: the placement
+	// - param 3: the evaluations made (incremented unless the table had the score)
+	// - param 4: the board after the placement (rows removed) if it's already made, or
+	//            nullptr to make it here
+	// - param 5: the rows the placement removed (with param 4)
+	// - return: double, the score
+	double scorePlacement(const Gameboard& board, const MoveGenerator::Placement& placement, std::uint64_t& evaluationCount,
+		const Gameboard* placed = nullptr, int placedLinesCleared = 0) const;
+
+	// score the next shape's placements on a candidate's board (one search thread)
+	// - param 1: the candidate
+	// - param 2: the next shape
+	// - param 3: the worker's MoveGenerator
+	// - return: nothing
+	void expand(Candidate& candidate, TetShape nextShape, MoveGenerator& generator) const;
+
+	// search the path to the target again, from where the shape is now
+	// - param 1: the engine
+	// - return: bool, false if the target can't be reached anymore
+	bool repath(const TetrisEngine& engine);
+};
+
+#endif /* AIPLAYER_H */
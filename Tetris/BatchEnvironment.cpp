@@ -0,0 +1,507 @@
+#include "BatchEnvironment.h"
+#include <cassert>
+
+// constructor, reset() every game
+// - param 1: the number of games (N)
+// - param 2: the RandomizerPolicy the games' shapes are picked with
+// - param 3: the seed of game 0 (game i is seeded with firstSeed + i)
+BatchEnvironment::BatchEnvironment(int gameCount, RandomizerPolicy randomizerPolicy, std::uint64_t firstSeed) :
+	gameCount{ gameCount },
+	rowMasks(static_cast<std::size_t>(gameCount) * Gameboard::MAX_Y),
+	currentShapes(gameCount), rotations(gameCount), shapeX(gameCount), shapeY(gameCount), nextShapes(gameCount),
+	pieceGenerators(gameCount, PieceGenerator(0, randomizerPolicy)),
+	scores(gameCount), linesCleared(gameCount), placementCounts(gameCount), frames(gameCount),
+	framesPerTick(gameCount), framesSinceLastTick(gameCount), placed(gameCount), gameOver(gameCount),
+	observations(static_cast<std::size_t>(gameCount) * OBSERVATION_SIZE)
+{
+	assert(gameCount > 0);
+	reset(firstSeed);
+}
+
+// reset every game (game i is seeded with firstSeed + i)
+// - param 1: the seed of game 0
+// - return: nothing
+void BatchEnvironment::reset(std::uint64_t firstSeed)
+{
+	for (int game = 0; game < gameCount; game++)
+	{
+		resetGame(game, firstSeed + game);
+	}
+	updateObservations();
+}
+
+// reset one game for a new game (and update its observation)
+// - param 1: the game's index
+// - param 2: the game's seed
+// - return: nothing
+void BatchEnvironment::reset(int game, std::uint64_t seed)
+{
+	resetGame(game, seed);
+	updateObservation(game);
+}
+
+// apply an action to every game, then run one frame of every game
+//   (the same as TetrisEngine::applyAction() then TetrisEngine::stepFrame())
+//   and update the observations.
+// - param 1: gameCount actions, actions[i] for game i
+// - return: nothing
+void BatchEnvironment::step(const GameAction* actions)
+{
+	// 1) actions (only the games that are still playing)
+	for (int game = 0; game < gameCount; game++)
+	{
+		if (!gameOver[game])
+			applyAction(game, actions[game]);
+	}
+
+	// 2) count the frame (for the games still playing) towards every game's next tick
+	//    & run the ticks that are due
+	for (int game = 0; game < gameCount; game++)
+	{
+		const int playing = !gameOver[game];
+		framesSinceLastTick[game] += playing;
+		frames[game] += playing;
+	}
+	for (int game = 0; game < gameCount; game++)
+	{
+		if (framesSinceLastTick[game] >= framesPerTick[game])
+		{
+			framesSinceLastTick[game] = 0;
+			if (!placed[game] && !attemptMove(game, 0, 1))
+				lock(game);
+		}
+	}
+
+	// 3) placements
+	for (int game = 0; game < gameCount; game++)
+	{
+		if (placed[game])
+			processPlacement(game);
+	}
+
+	updateObservations();
+}
+
+// same as above
+// - param 1: a vector of gameCount actions
+// - return: nothing
+void BatchEnvironment::step(const std::vector<GameAction>& actions)
+{
+	assert(static_cast<int>(actions.size()) == gameCount);
+	step(actions.data());
+}
+
+// play one placement in each game of a range: rotate the current shape to a rotation,
+//   slide it to a column & hard drop it, then run the frame (the same as those
+//   TetrisEngine::applyAction() calls then TetrisEngine::stepFrame()).  A placement that
+//   can't be reached lands where the moves that were legal took the shape, & one out of
+//   range is a plain hard drop.  The observations aren't updated.
+// - param 1: gameCount placements, placements[i] (rotation * MAX_X + x) for game i
+// - param 2: the first game of the range
+// - param 3: the game after the last one of the range
+// - return: nothing
+void BatchEnvironment::stepPlacements(const std::int32_t* placements, int firstGame, int endGame)
+{
+	assert(firstGame >= 0 && endGame <= gameCount);
+	for (int game = firstGame; game < endGame; game++)
+	{
+		if (gameOver[game])
+			continue;
+
+		const int placement = placements[game];
+		if (placement >= 0 && placement < PLACEMENT_COUNT)
+		{
+			const int rotation = placement / Gameboard::MAX_X;
+			const int x = placement % Gameboard::MAX_X;
+			const int turns = (rotation - rotations[game] + Tetromino::ROTATION_COUNT) % Tetromino::ROTATION_COUNT;
+			for (int turn = 0; turn < turns; turn++)
+			{
+				applyAction(game, GameAction::ROTATE);
+			}
+			const int dx = (x < shapeX[game]) ? -1 : 1;
+			while (shapeX[game] != x && attemptMove(game, dx, 0))
+			{
+			}
+		}
+		applyAction(game, GameAction::HARD_DROP);
+		finishFrame(game);
+	}
+}
+
+// which placements a game's current shape can reach exactly (rotated where it is,
+//   then slid sideways), none if the game is over (& at least one otherwise)
+// - param 1: the game's index
+// - param 2: PLACEMENT_COUNT bytes, set to 1 for a reachable placement & 0 otherwise
+// - return: nothing
+void BatchEnvironment::getPlacementMask(int game, std::uint8_t* mask) const
+{
+	for (int placement = 0; placement < PLACEMENT_COUNT; placement++)
+	{
+		mask[placement] = 0;
+	}
+	if (gameOver[game])
+		return;
+
+	// where the shape is can always be played, even when the rows removed after the shape
+	// spawned dropped blocks onto it (no move is legal then, it's hard dropped where it is)
+	mask[rotations[game] * Gameboard::MAX_X + shapeX[game]] = 1;
+
+	// every rotation on the way to a rotation has to be legal (an O doesn't rotate), then
+	// the shape slides over the legal columns next to it
+	const int turnCount = (currentShapes[game] == static_cast<std::uint8_t>(TetShape::O)) ? 1 : Tetromino::ROTATION_COUNT;
+	for (int turn = 0; turn < turnCount; turn++)
+	{
+		const int rotation = (rotations[game] + turn) % Tetromino::ROTATION_COUNT;
+		const std::uint32_t legal = getLegalColumns(game, shapeY[game], rotation);
+		if (!((legal >> shapeX[game]) & 1))
+			break;
+		std::uint8_t* row = &mask[rotation * Gameboard::MAX_X];
+		for (int x = shapeX[game]; x >= 0 && ((legal >> x) & 1); x--)
+		{
+			row[x] = 1;
+		}
+		for (int x = shapeX[game] + 1; x < Gameboard::MAX_X && ((legal >> x) & 1); x++)
+		{
+			row[x] = 1;
+		}
+	}
+}
+
+// Getters ======================================================
+
+// the number of games (N)
+int BatchEnvironment::getGameCount() const
+{
+	return gameCount;
+}
+
+// the observations of every game, gameCount * OBSERVATION_SIZE cells:
+//   game i's cell (x, y) is at [i * OBSERVATION_SIZE + y * MAX_X + x]
+const std::uint8_t* BatchEnvironment::getObservations() const
+{
+	return observations.data();
+}
+
+// the row masks of every board, gameCount * MAX_Y masks (bit x of [i * MAX_Y + y] is cell (x, y))
+const std::uint16_t* BatchEnvironment::getRowMasks() const
+{
+	return rowMasks.data();
+}
+
+const std::int32_t* BatchEnvironment::getScores() const
+{
+	return scores.data();
+}
+
+const std::int32_t* BatchEnvironment::getLinesCleared() const
+{
+	return linesCleared.data();
+}
+
+const std::int32_t* BatchEnvironment::getPlacementCounts() const
+{
+	return placementCounts.data();
+}
+
+const std::int64_t* BatchEnvironment::getFrames() const
+{
+	return frames.data();
+}
+
+const std::uint8_t* BatchEnvironment::getGameOver() const
+{
+	return gameOver.data();
+}
+
+const std::uint8_t* BatchEnvironment::getCurrentShapes() const
+{
+	return currentShapes.data();
+}
+
+const std::uint8_t* BatchEnvironment::getRotations() const
+{
+	return rotations.data();
+}
+
+const std::int8_t* BatchEnvironment::getShapeX() const
+{
+	return shapeX.data();
+}
+
+const std::int8_t* BatchEnvironment::getShapeY() const
+{
+	return shapeY.data();
+}
+
+const std::uint8_t* BatchEnvironment::getNextShapes() const
+{
+	return nextShapes.data();
+}
+
+// Game logic (the same rules as TetrisEngine) ==================
+
+// reset one game's state (not its observation)
+// - param 1: the game's index
+// - param 2: the game's seed
+// - return: nothing
+void BatchEnvironment::resetGame(int game, std::uint64_t seed)
+{
+	std::uint16_t* rows = &rowMasks[static_cast<std::size_t>(game) * Gameboard::MAX_Y];
+	for (int y = 0; y < Gameboard::MAX_Y; y++)
+	{
+		rows[y] = 0;
+	}
+	scores[game] = 0;
+	linesCleared[game] = 0;
+	placementCounts[game] = 0;
+	frames[game] = 0;
+	framesPerTick[game] = TetrisEngine::getFramesPerTickForScore(0);
+	framesSinceLastTick[game] = 0;
+	placed[game] = 0;
+	gameOver[game] = 0;
+
+	// pick, spawn, pick again (like TetrisEngine::reset())
+	pieceGenerators[game].seed(seed);
+	currentShapes[game] = static_cast<std::uint8_t>(pieceGenerators[game].next());
+	rotations[game] = 0;
+	shapeX[game] = static_cast<std::int8_t>(Gameboard::MAX_X / 2);
+	shapeY[game] = 0;
+	nextShapes[game] = static_cast<std::uint8_t>(pieceGenerators[game].next());
+}
+
+// apply a player action to a game's current shape (see TetrisEngine::applyAction())
+// - param 1: the game's index
+// - param 2: the action
+// - return: nothing
+void BatchEnvironment::applyAction(int game, GameAction action)
+{
+	switch (action) {
+	case GameAction::ROTATE:
+		if (currentShapes[game] != static_cast<std::uint8_t>(TetShape::O))
+		{
+			const int rotation = (rotations[game] + 1) % Tetromino::ROTATION_COUNT;
+			if (isPositionLegal(game, shapeX[game], shapeY[game], rotation))
+				rotations[game] = static_cast<std::uint8_t>(rotation);
+		}
+		break;
+	case GameAction::MOVE_LEFT:
+		attemptMove(game, -1, 0);
+		break;
+	case GameAction::MOVE_RIGHT:
+		attemptMove(game, 1, 0);
+		break;
+	case GameAction::SOFT_DROP:
+		if (!attemptMove(game, 0, 1))
+			lock(game);
+		break;
+	case GameAction::HARD_DROP:
+		while (attemptMove(game, 0, 1))
+		{
+		}
+		lock(game);
+		break;
+	default:
+		break;
+	}
+}
+
+// count a frame of a game & run its tick if it's due, then process its placement
+//   (the second & third passes of step(), for one game)
+// - param 1: the game's index
+// - return: nothing
+void BatchEnvironment::finishFrame(int game)
+{
+	if (gameOver[game])
+		return;
+	framesSinceLastTick[game]++;
+	frames[game]++;
+	if (framesSinceLastTick[game] >= framesPerTick[game])
+	{
+		framesSinceLastTick[game] = 0;
+		if (!placed[game] && !attemptMove(game, 0, 1))
+			lock(game);
+	}
+	if (placed[game])
+		processPlacement(game);
+}
+
+// true if a game's current shape could be at (x, y) with a rotation:
+// every block within the left, right & bottom borders, on an empty cell
+// - param 1: the game's index
+// - params 2-4: the location & rotation to test
+// - return: bool
+bool BatchEnvironment::isPositionLegal(int game, int x, int y, int rotation) const
+{
+	const std::uint16_t* rows = &rowMasks[static_cast<std::size_t>(game) * Gameboard::MAX_Y];
+	const BlockOffset* offsets = Tetromino::getRotationOffsets(static_cast<TetShape>(currentShapes[game]), rotation);
+	for (int block = 0; block < Tetromino::BLOCK_COUNT; block++)
+	{
+		const int bx = x + offsets[block].x;
+		const int by = y + offsets[block].y;
+		if (bx < 0 || bx >= Gameboard::MAX_X || by >= Gameboard::MAX_Y)
+			return false;
+		if (by >= 0 && ((rows[by] >> bx) & 1))
+			return false;
+	}
+	return true;
+}
+
+// the columns where a game's current shape could be in a row with a rotation (see
+//   isPositionLegal()), tested all at once: the board's rows are shifted into a wider
+//   mask whose bits outside the board (the walls) are set, & each block's row is shifted
+//   by the block's x offset, so bit x of their union is set if a block collides at x
+// - param 1: the game's index
+// - param 2: the row (y) of the shape's grid location
+// - param 3: the rotation
+// - return: std::uint32_t, bit x is set if the shape can be at (x, y)
+std::uint32_t BatchEnvironment::getLegalColumns(int game, int y, int rotation) const
+{
+	const int WALL = 4;		// the bits left of the board (more than any block's x offset)
+	const std::uint32_t walls = ~(static_cast<std::uint32_t>(Gameboard::FULL_ROW_MASK) << WALL);
+	const std::uint16_t* rows = &rowMasks[static_cast<std::size_t>(game) * Gameboard::MAX_Y];
+	const BlockOffset* offsets = Tetromino::getRotationOffsets(static_cast<TetShape>(currentShapes[game]), rotation);
+	std::uint32_t colliding = 0;
+	for (int block = 0; block < Tetromino::BLOCK_COUNT; block++)
+	{
+		const int by = y + offsets[block].y;
+		if (by >= Gameboard::MAX_Y)
+			return 0;
+		const std::uint32_t row = walls | ((by >= 0) ? static_cast<std::uint32_t>(rows[by]) << WALL : 0);
+		colliding |= (offsets[block].x >= 0) ? row >> offsets[block].x : row << -offsets[block].x;
+	}
+	return (~colliding >> WALL) & Gameboard::FULL_ROW_MASK;
+}
+
+// move a game's current shape if the move is legal
+// - return: bool, true if it moved
+bool BatchEnvironment::attemptMove(int game, int dx, int dy)
+{
+	if (!isPositionLegal(game, shapeX[game] + dx, shapeY[game] + dy, rotations[game]))
+		return false;
+	shapeX[game] = static_cast<std::int8_t>(shapeX[game] + dx);
+	shapeY[game] = static_cast<std::int8_t>(shapeY[game] + dy);
+	return true;
+}
+
+// set the blocks of a game's current shape on its board & record the placement
+void BatchEnvironment::lock(int game)
+{
+	std::uint16_t* rows = &rowMasks[static_cast<std::size_t>(game) * Gameboard::MAX_Y];
+	const BlockOffset* offsets = Tetromino::getRotationOffsets(static_cast<TetShape>(currentShapes[game]), rotations[game]);
+	for (int block = 0; block < Tetromino::BLOCK_COUNT; block++)
+	{
+		const int bx = shapeX[game] + offsets[block].x;
+		const int by = shapeY[game] + offsets[block].y;
+		if (by >= 0)	// blocks above the board are lost (like Gameboard::setContent())
+			rows[by] |= static_cast<std::uint16_t>(1 << bx);
+	}
+	placed[game] = 1;
+}
+
+// spawn the next shape, remove completed rows & update the score
+// (or end the game if the next shape can't be spawned)
+void BatchEnvironment::processPlacement(int game)
+{
+	placed[game] = 0;
+
+	// the spawn is tested before the rows are removed (like TetrisEngine::processPlacement())
+	const std::uint8_t previousShape = currentShapes[game];
+	currentShapes[game] = nextShapes[game];
+	if (!isPositionLegal(game, Gameboard::MAX_X / 2, 0, 0))
+	{
+		currentShapes[game] = previousShape;
+		gameOver[game] = 1;
+		return;
+	}
+	rotations[game] = 0;
+	shapeX[game] = static_cast<std::int8_t>(Gameboard::MAX_X / 2);
+	shapeY[game] = 0;
+	nextShapes[game] = static_cast<std::uint8_t>(pieceGenerators[game].next());
+
+	const int rowsRemoved = compactCompletedRows(game);
+	linesCleared[game] += rowsRemoved;
+	placementCounts[game]++;
+	scores[game] += TetrisEngine::getScoreForRows(rowsRemoved);
+	framesPerTick[game] = TetrisEngine::getFramesPerTickForScore(scores[game]);
+}
+
+// remove a board's completed rows in one bottom-up pass
+// - param 1: the game's index
+// - return: int, the number of rows removed
+int BatchEnvironment::compactCompletedRows(int game)
+{
+	std::uint16_t* rows = &rowMasks[static_cast<std::size_t>(game) * Gameboard::MAX_Y];
+
+	// every row is copied down to the write row, which only moves up past rows that are kept
+	int write = Gameboard::MAX_Y - 1;
+	for (int read = Gameboard::MAX_Y - 1; read >= 0; read--)
+	{
+		const std::uint16_t row = rows[read];
+		rows[write] = row;
+		write -= (row != Gameboard::FULL_ROW_MASK);
+	}
+	for (int y = 0; y <= write; y++)
+	{
+		rows[y] = 0;
+	}
+	return write + 1;
+}
+
+// write every game's observation
+void BatchEnvironment::updateObservations()
+{
+	// the locked blocks: every row mask expanded into MAX_X cells (a branch free loop over
+	// one contiguous array, which the compiler vectorizes)
+	const std::size_t rowCount = static_cast<std::size_t>(gameCount) * Gameboard::MAX_Y;
+	const std::uint16_t* rows = rowMasks.data();
+	std::uint8_t* cells = observations.data();
+	for (std::size_t row = 0; row < rowCount; row++)
+	{
+		const unsigned int mask = rows[row];
+		for (int x = 0; x < Gameboard::MAX_X; x++)
+		{
+			cells[row * Gameboard::MAX_X + x] = static_cast<std::uint8_t>((mask >> x) & 1);
+		}
+	}
+
+	for (int game = 0; game < gameCount; game++)
+	{
+		drawFallingShape(game);
+	}
+}
+
+// write one game's observation
+// - param 1: the game's index
+// - return: nothing
+void BatchEnvironment::updateObservation(int game)
+{
+	const std::uint16_t* rows = &rowMasks[static_cast<std::size_t>(game) * Gameboard::MAX_Y];
+	std::uint8_t* cells = &observations[static_cast<std::size_t>(game) * OBSERVATION_SIZE];
+	for (int y = 0; y < Gameboard::MAX_Y; y++)
+	{
+		const unsigned int mask = rows[y];
+		for (int x = 0; x < Gameboard::MAX_X; x++)
+		{
+			cells[y * Gameboard::MAX_X + x] = static_cast<std::uint8_t>((mask >> x) & 1);
+		}
+	}
+	drawFallingShape(game);
+}
+
+// mark the cells of a game's falling shape in its observation (if the game is not over)
+// - param 1: the game's index
+// - return: nothing
+void BatchEnvironment::drawFallingShape(int game)
+{
+	if (gameOver[game])
+		return;
+	std::uint8_t* cells = &observations[static_cast<std::size_t>(game) * OBSERVATION_SIZE];
+	const BlockOffset* offsets = Tetromino::getRotationOffsets(static_cast<TetShape>(currentShapes[game]), rotations[game]);
+	for (int block = 0; block < Tetromino::BLOCK_COUNT; block++)
+	{
+		const int bx = shapeX[game] + offsets[block].x;
+		const int by = shapeY[game] + offsets[block].y;
+		if (by >= 0)
+			cells[by * Gameboard::MAX_X + bx] = OBSERVATION_FALLING;
+	}
+}
@@ -0,0 +1,211 @@
+// The BatchEnvironment class steps many games in lockstep, for training bots
+// (reinforcement learning), where thousands of games are played at once.
+//
+// Instead of one TetrisEngine (and one Gameboard) per game, the state of all N games
+// is stored as a structure of arrays: one array of row masks for every board (MAX_Y
+// masks per game, back to back), one array of current shapes, one of rotations, one
+// of scores, and so on.  A step() applies one GameAction per game and runs one frame
+// of every game, pass by pass, so each pass walks a few small contiguous arrays.
+//
+// The rules are exactly those of TetrisEngine (the same moves, rotations, ticks,
+// row clears, scoring and game over), so a game in the batch plays the same as a
+// TetrisEngine with the same seed, randomizer policy and actions.  Only occupancy is
+// kept (no block colors).
+//
+// After every step() the observations of all the games are written to one contiguous
+// buffer (getObservations()): OBSERVATION_SIZE bytes per game, MAX_Y rows of MAX_X
+// cells each, which the caller can read in place.
+//
+// A game that is over stays over (its actions are ignored) until it is reset().
+//
+// Games can also be played placement by placement (stepPlacements()): a placement
+// action (rotation * MAX_X + x) rotates the current shape, slides it to column x and
+// hard drops it, all in one frame, as a player pressing those keys would.
+// getPlacementMask() tells which placements the current shape can reach exactly.
+// Placement steps don't write the observations (placement level callers read the
+// boards & shapes through the getters, see TetrisEnv).
+
+#ifndef BATCHENVIRONMENT_H
+#define BATCHENVIRONMENT_H
+
+#include <cstdint>
+#include <vector>
+#include "Gameboard.h"
+#include "PieceGenerator.h"
+#include "TetrisEngine.h"
+
+class BatchEnvironment
+{
+public:
+	// CONSTANTS
+	static const int OBSERVATION_SIZE{ Gameboard::MAX_Y * Gameboard::MAX_X };	// the bytes of one game's observation
+	static const std::uint8_t OBSERVATION_EMPTY{ 0 };		// an empty cell
+	static const std::uint8_t OBSERVATION_LOCKED{ 1 };		// a cell holding a locked block
+	static const std::uint8_t OBSERVATION_FALLING{ 2 };		// a cell holding a block of the current shape
+	static const int PLACEMENT_COUNT{ Tetromino::ROTATION_COUNT * Gameboard::MAX_X };	// the placement actions
+
+private:
+	// MEMBER VARIABLES
+	int gameCount;								// the number of games (N)
+
+	// Board members (MAX_Y per game) ----------------------------
+	std::vector<std::uint16_t> rowMasks;		// the occupancy of every row of every board
+
+	// Shape members (1 per game) --------------------------------
+	std::vector<std::uint8_t> currentShapes;	// the TetShape of the falling shape
+	std::vector<std::uint8_t> rotations;		// the rotation of the falling shape
+	std::vector<std::int8_t> shapeX;			// the grid location of the falling shape
+	std::vector<std::int8_t> shapeY;
+	std::vector<std::uint8_t> nextShapes;		// the TetShape "on deck"
+	std::vector<PieceGenerator> pieceGenerators;	// every game's own piece generator
+
+	// Game members (1 per game) ---------------------------------
+	std::vector<std::int32_t> scores;
+	std::vector<std::int32_t> linesCleared;
+	std::vector<std::int32_t> placementCounts;
+	std::vector<std::int64_t> frames;
+	std::vector<std::int32_t> framesPerTick;
+	std::vector<std::int32_t> framesSinceLastTick;
+	std::vector<std::uint8_t> placed;			// a shape was locked this frame
+	std::vector<std::uint8_t> gameOver;			// the next shape could not be spawned
+
+	std::vector<std::uint8_t> observations;		// gameCount * OBSERVATION_SIZE cells
+
+public:
+	// constructor, reset() every game
+	// - param 1: the number of games (N)
+	// - param 2: the RandomizerPolicy the games' shapes are picked with
+	// - param 3: the seed of game 0 (game i is seeded with firstSeed + i)
+	BatchEnvironment(int gameCount, RandomizerPolicy randomizerPolicy = RandomizerPolicy::UNIFORM,
+		std::uint64_t firstSeed = 0);
+
+	// reset every game (game i is seeded with firstSeed + i)
+	// - param 1: the seed of game 0
+	// - return: nothing
+	void reset(std::uint64_t firstSeed);
+
+	// reset one game for a new game (and update its observation)
+	// - param 1: the game's index
+	// - param 2: the game's seed
+	// - return: nothing
+	void reset(int game, std::uint64_t seed);
+
+	// apply an action to every game, then run one frame of every game
+	//   (the same as TetrisEngine::applyAction() then TetrisEngine::stepFrame())
+	//   and update the observations.
+	// - param 1: gameCount actions, actions[i] for game i
+	// - return: nothing
+	void step(const GameAction* actions);
+
+	// same as above
+	// - param 1: a vector of gameCount actions
+	// - return: nothing
+	void step(const std::vector<GameAction>& actions);
+
+	// play one placement in each game of a range: rotate the current shape to a rotation,
+	//   slide it to a column & hard drop it, then run the frame (the same as those
+	//   TetrisEngine::applyAction() calls then TetrisEngine::stepFrame()).  A placement that
+	//   can't be reached lands where the moves that were legal took the shape, & one out of
+	//   range is a plain hard drop.  The observations aren't updated.
+	// - param 1: gameCount placements, placements[i] (rotation * MAX_X + x) for game i
+	// - param 2: the first game of the range
+	// - param 3: the game after the last one of the range
+	// - return: nothing
+	void stepPlacements(const std::int32_t* placements, int firstGame, int endGame);
+
+	// which placements a game's current shape can reach exactly (rotated where it is,
+	//   then slid sideways), none if the game is over (& at least one otherwise)
+	// - param 1: the game's index
+	// - param 2: PLACEMENT_COUNT bytes, set to 1 for a reachable placement & 0 otherwise
+	// - return: nothing
+	void getPlacementMask(int game, std::uint8_t* mask) const;
+
+	// Getters ======================================================
+	// (the arrays hold one value per game, in game order)
+
+	// the number of games (N)
+	int getGameCount() const;
+
+	// the observations of every game, gameCount * OBSERVATION_SIZE cells:
+	//   game i's cell (x, y) is at [i * OBSERVATION_SIZE + y * MAX_X + x]
+	const std::uint8_t* getObservations() const;
+
+	// the row masks of every board, gameCount * MAX_Y masks (bit x of [i * MAX_Y + y] is cell (x, y))
+	const std::uint16_t* getRowMasks() const;
+
+	const std::int32_t* getScores() const;
+	const std::int32_t* getLinesCleared() const;
+	const std::int32_t* getPlacementCounts() const;
+	const std::int64_t* getFrames() const;
+	const std::uint8_t* getGameOver() const;
+	const std::uint8_t* getCurrentShapes() const;	// TetShape values
+	const std::uint8_t* getRotations() const;
+	const std::int8_t* getShapeX() const;
+	const std::int8_t* getShapeY() const;
+	const std::uint8_t* getNextShapes() const;		// TetShape values
+
+private:
+	// reset one game's state (not its observation)
+	// - param 1: the game's index
+	// - param 2: the game's seed
+	// - return: nothing
+	void resetGame(int game, std::uint64_t seed);
+
+	// apply a player action to a game's current shape (see TetrisEngine::applyAction())
+	// - param 1: the game's index
+	// - param 2: the action
+	// - return: nothing
+	void applyAction(int game, GameAction action);
+
+	// count a frame of a game & run its tick if it's due, then process its placement
+	//   (the second & third passes of step(), for one game)
+	// - param 1: the game's index
+	// - return: nothing
+	void finishFrame(int game);
+
+	// true if a game's current shape could be at (x, y) with a rotation:
+	// every block within the left, right & bottom borders, on an empty cell
+	// - param 1: the game's index
+	// - params 2-4: the location & rotation to test
+	// - return: bool
+	bool isPositionLegal(int game, int x, int y, int rotation) const;
+
+	// the columns where a game's current shape could be in a row with a rotation (see
+	//   isPositionLegal()), tested all at once
+	// - param 1: the game's index
+	// - param 2: the row (y) of the shape's grid location
+	// - param 3: the rotation
+	// - return: std::uint32_t, bit x is set if the shape can be at (x, y)
+	std::uint32_t getLegalColumns(int game, int y, int rotation) const;
+
+	// move a game's current shape if the move is legal
+	// - return: bool, true if it moved
+	bool attemptMove(int game, int dx, int dy);
+
+	// set the blocks of a game's current shape on its board & record the placement
+	void lock(int game);
+
+	// spawn the next shape, remove completed rows & update the score
+	// (or end the game if the next shape can't be spawned)
+	void processPlacement(int game);
+
+	// remove a board's completed rows in one bottom-up pass
+	// - param 1: the game's index
+	// - return: int, the number of rows removed
+	int compactCompletedRows(int game);
+
+	// write every game's observation
+	void updateObservations();
+
+	// write one game's observation
+	// - param 1: the game's index
+	// - return: nothing
+	void updateObservation(int game);
+
+	// mark the cells of a game's falling shape in its observation (if the game is not over)
+	// - param 1: the game's index
+	// - return: nothing
+	void drawFallingShape(int game);
+};
+
+#endif /* BATCHENVIRONMENT_H */
@@ -0,0 +1,148 @@
+#include "BatchSimulator.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+// summarize a set of values
+// - param 1: the values (sorted in place)
+// - return: the Distribution of the values (all 0 if there are none)
+Distribution Distribution::of(std::vector<std::int64_t>& values)
+{
+	Distribution d{};
+	if (values.empty())
+		return d;
+
+	std::sort(values.begin(), values.end());
+	const std::size_t n = values.size();
+
+	double sum = 0;
+	for (std::int64_t value : values)
+	{
+		sum += static_cast<double>(value);
+	}
+	d.mean = sum / n;
+
+	double squares = 0;
+	for (std::int64_t value : values)
+	{
+		squares += (value - d.mean) * (value - d.mean);
+	}
+	d.standardDeviation = std::sqrt(squares / n);
+
+	// nearest rank percentiles
+	auto percentile = [&](std::size_t p) { return values[std::max<std::size_t>((n * p + 99) / 100, 1) - 1]; };
+	d.min = values.front();
+	d.p10 = percentile(10);
+	d.median = percentile(50);
+	d.p90 = percentile(90);
+	d.p99 = percentile(99);
+	d.max = values.back();
+	return d;
+}
+
+// print the distribution as a row of a report
+// - param 1: the name of the value
+// - return: nothing
+void Distribution::printToConsole(const char* name) const
+{
+	std::cout << "  " << name << ": mean " << mean << " (sd " << standardDeviation << ")"
+		<< "  min " << min << "  p10 " << p10 << "  median " << median
+		<< "  p90 " << p90 << "  p99 " << p99 << "  max " << max << "\n";
+}
+
+// print the report (the summaries, not every game)
+// - params: none
+// - return: nothing
+void BatchReport::printToConsole() const
+{
+	std::cout << games << " games on " << threads << " threads in " << seconds << " s: "
+		<< gamesPerSecond << " games/s (" << gamesPerSecondPerThread << " games/s per thread)\n";
+	score.printToConsole("score ");
+	linesCleared.printToConsole("lines ");
+	placements.printToConsole("pieces");
+	frames.printToConsole("frames");
+}
+
+// constructor, start the threads and make every worker's policy instance
+// - param 1: makes the policy (called once per worker thread)
+// - param 2: the number of threads (0 to use every hardware thread)
+// - param 3: the RandomizerPolicy the games' shapes are picked with
+// - param 4: a game stops after this many pieces (0: play until the game is over)
+BatchSimulator::BatchSimulator(const GamePolicy::Factory& makePolicy, int threadCount,
+	RandomizerPolicy randomizerPolicy, int maxPlacements) :
+	pool{ threadCount }, randomizerPolicy{ randomizerPolicy }, maxPlacements{ maxPlacements }
+{
+	for (int i = 0; i < pool.getThreadCount(); i++)
+	{
+		std::unique_ptr<Worker> worker(new Worker{ TetrisEngine(0, randomizerPolicy), makePolicy(), {} });
+		workers.push_back(std::move(worker));
+	}
+}
+
+// play a batch of games (game i is played with seed firstSeed + i)
+// - param 1: the seed of the first game
+// - param 2: the number of games
+// - return: a BatchReport
+BatchReport BatchSimulator::run(std::uint64_t firstSeed, int gameCount)
+{
+	BatchReport report{};
+	report.games = std::max(gameCount, 0);
+	report.threads = pool.getThreadCount();
+	report.results.resize(report.games);
+
+	const auto start = std::chrono::steady_clock::now();
+	pool.parallelFor(report.games, [&](std::int64_t game, int worker) {
+		Worker& w = *workers[worker];
+		report.results[game] = playGame(w.engine, *w.policy, firstSeed + game, maxPlacements);
+	});
+	report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	if (report.seconds > 0)
+	{
+		report.gamesPerSecond = report.games / report.seconds;
+		report.gamesPerSecondPerThread = report.gamesPerSecond / report.threads;
+	}
+
+	std::vector<std::int64_t> values(report.games);
+	auto summarize = [&](std::int64_t (*field)(const GameResult&)) {
+		for (int i = 0; i < report.games; i++)
+		{
+			values[i] = field(report.results[i]);
+		}
+		return Distribution::of(values);
+	};
+	report.score = summarize([](const GameResult& r) -> std::int64_t { return r.score; });
+	report.linesCleared = summarize([](const GameResult& r) -> std::int64_t { return r.linesCleared; });
+	report.placements = summarize([](const GameResult& r) -> std::int64_t { return r.placements; });
+	report.frames = summarize([](const GameResult& r) -> std::int64_t { return r.frames; });
+	return report;
+}
+
+// the number of worker threads
+int BatchSimulator::getThreadCount() const
+{
+	return pool.getThreadCount();
+}
+
+// play one complete game (headless): every frame, ask the policy for an action,
+// apply it, then step the frame.
+// - param 1: the engine to play on (reset with the seed first)
+// - param 2: the policy playing (reset with a seed derived from the game's seed)
+// - param 3: the game's seed
+// - param 4: stop after this many pieces (0: play until the game is over)
+// - return: the GameResult
+GameResult BatchSimulator::playGame(TetrisEngine& engine, GamePolicy& policy, std::uint64_t seed, int maxPlacements)
+{
+	engine.reset(seed);
+	policy.reset(Random::deriveSeed(seed, 1));
+
+	while (!engine.isGameOver() && (maxPlacements == 0 || engine.getPlacementCount() < maxPlacements))
+	{
+		const GameAction action = policy.chooseAction(engine);
+		if (action != GameAction::NONE)
+			engine.applyAction(action);
+		engine.stepFrame();
+	}
+	return GameResult{ seed, engine.getScore(), engine.getLinesCleared(), engine.getPlacementCount(), engine.getFrame() };
+}
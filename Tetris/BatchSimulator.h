@@ -0,0 +1,121 @@
+// The BatchSimulator class plays a large number of complete games with a bot
+// (a GamePolicy), headless and across every core, and reports how the bot did.
+//
+// Game i of a batch is played with seed firstSeed + i, so a batch is reproducible:
+// the same policy, seeds and settings always give the same results, whatever the
+// number of threads.  The games are spread over a WorkStealingPool.  Every worker
+// owns its engine & policy instance (allocated once, reused for all its games), so
+// the games share nothing but the (preallocated) results array.
+
+#ifndef BATCHSIMULATOR_H
+#define BATCHSIMULATOR_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "GamePolicy.h"
+#include "PieceGenerator.h"
+#include "TetrisEngine.h"
+#include "WorkStealingPool.h"
+
+// the outcome of one game
+struct GameResult
+{
+	std::uint64_t seed;		// the game's seed
+	int score;				// the final score
+	int linesCleared;		// the rows removed
+	int placements;			// the shapes placed (pieces)
+	std::int64_t frames;	// the game length (in frames)
+};
+
+// a summary of the distribution of a value over the games of a batch
+struct Distribution
+{
+	double mean;
+	double standardDeviation;
+	std::int64_t min;
+	std::int64_t p10;		// 10th percentile
+	std::int64_t median;
+	std::int64_t p90;		// 90th percentile
+	std::int64_t p99;		// 99th percentile
+	std::int64_t max;
+
+	// summarize a set of values
+	// - param 1: the values (sorted in place)
+	// - return: the Distribution of the values (all 0 if there are none)
+	static Distribution of(std::vector<std::int64_t>& values);
+
+	// print the distribution as a row of a report
+	// - param 1: the name of the value
+	// - return: nothing
+	void printToConsole(const char* name) const;
+};
+
+// everything a batch reports
+struct BatchReport
+{
+	int games;						// the number of games played
+	int threads;					// the number of worker threads used
+	double seconds;					// the wall-clock time the batch took
+	double gamesPerSecond;
+	double gamesPerSecondPerThread;	// the throughput per core (the metric to compare)
+
+	Distribution score;
+	Distribution linesCleared;
+	Distribution placements;
+	Distribution frames;
+
+	std::vector<GameResult> results;	// every game's result, in seed order
+
+	// print the report (the summaries, not every game)
+	// - params: none
+	// - return: nothing
+	void printToConsole() const;
+};
+
+class BatchSimulator
+{
+private:
+	// a worker's own game & bot (separately allocated, so workers never share a cache line)
+	struct Worker
+	{
+		TetrisEngine engine;
+		std::unique_ptr<GamePolicy> policy;
+		char padding[64];
+	};
+
+	// MEMBER VARIABLES
+	WorkStealingPool pool;							// the worker threads
+	std::vector<std::unique_ptr<Worker>> workers;	// a Worker per thread
+	RandomizerPolicy randomizerPolicy;				// how the games' shapes are picked
+	int maxPlacements;								// a game stops after this many pieces (0: no limit)
+
+public:
+	// constructor, start the threads and make every worker's policy instance
+	// - param 1: makes the policy (called once per worker thread)
+	// - param 2: the number of threads (0 to use every hardware thread)
+	// - param 3: the RandomizerPolicy the games' shapes are picked with
+	// - param 4: a game stops after this many pieces (0: play until the game is over)
+	BatchSimulator(const GamePolicy::Factory& makePolicy, int threadCount = 0,
+		RandomizerPolicy randomizerPolicy = RandomizerPolicy::UNIFORM, int maxPlacements = 0);
+
+	// play a batch of games (game i is played with seed firstSeed + i)
+	// - param 1: the seed of the first game
+	// - param 2: the number of games
+	// - return: a BatchReport
+	BatchReport run(std::uint64_t firstSeed, int gameCount);
+
+	// the number of worker threads
+	int getThreadCount() const;
+
+	// play one complete game (headless): every frame, ask the policy for an action,
+	// apply it, then step the frame.
+	// - param 1: the engine to play on (reset with the seed first)
+	// - param 2: the policy playing (reset with a seed derived from the game's seed)
+	// - param 3: the game's seed
+	// - param 4: stop after this many pieces (0: play until the game is over)
+	// - return: the GameResult
+	static GameResult playGame(TetrisEngine& engine, GamePolicy& policy, std::uint64_t seed, int maxPlacements = 0);
+};
+
+#endif /* BATCHSIMULATOR_H */
@@ -0,0 +1,48 @@
+// Small bit-twiddling helpers used by the bitboard code (Gameboard's row and
+// column masks).  They map to a single instruction where the compiler offers
+// an intrinsic for it, and to a portable fallback otherwise.
+
+#ifndef BITS_H
+#define BITS_H
+
+#include <bitset>
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// count the set bits of a mask
+// - param 1: a 32 bit mask
+// - return: the number of bits set
+inline int countSetBits(std::uint32_t mask)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_popcount(mask);
+#else
+	return static_cast<int>(std::bitset<32>(mask).count());
+#endif
+}
+
+// find the lowest set bit of a mask
+// - param 1: a 32 bit mask, which must not be 0
+// - return: the index of the lowest set bit (the number of trailing 0 bits)
+inline int countTrailingZeros(std::uint32_t mask)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_ctz(mask);
+#elif defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return static_cast<int>(index);
+#else
+	int index = 0;
+	while (!(mask & 1u)) {
+		mask >>= 1;
+		index++;
+	}
+	return index;
+#endif
+}
+
+#endif /* BITS_H */
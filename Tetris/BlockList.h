@@ -0,0 +1,79 @@
+// The BlockList is a small, fixed-capacity list of Points used to hold the blocks
+// of a tetromino.
+//
+// Every tetromino is made of exactly 4 blocks, so there is no need for the heap:
+// the Points are stored inline and copying a BlockList (and so copying a
+// Tetromino or GridTetromino) is a plain copy of 4 Points.
+// It offers the subset of std::vector's interface the tetromino classes use
+// (size, clear, push_back, operator[], at, begin/end), so code that walks blockLocs
+// reads the same as it did when blockLocs was a std::vector<Point>.
+
+#ifndef BLOCKLIST_H
+#define BLOCKLIST_H
+
+#include <assert.h>
+#include <initializer_list>
+#include <vector>
+#include "Point.h"
+
+class BlockList
+{
+public:
+	// CONSTANTS
+	static const int CAPACITY{ 4 };		// the most blocks a BlockList can hold
+
+private:
+	// MEMBER VARIABLES
+	Point points[CAPACITY];	// the blocks, only the first count are in use
+	int count{ 0 };			// the number of blocks in use
+
+public:
+	// constructor, an empty list
+	BlockList() {}
+
+	// constructor, a list holding the given points (at most CAPACITY)
+	BlockList(std::initializer_list<Point> init) {
+		for (const Point& p : init) {
+			push_back(p);
+		}
+	}
+
+	// the number of blocks in the list
+	int size() const { return count; }
+
+	// true if the list holds no blocks
+	bool empty() const { return count == 0; }
+
+	// remove every block from the list
+	void clear() { count = 0; }
+
+	// add a block to the end of the list (assert there is room for it)
+	void push_back(const Point& p) {
+		assert(count < CAPACITY && "BlockList is full");
+		points[count++] = p;
+	}
+
+	// access a block by index (the index is only checked by at())
+	Point& operator[](int index) { return points[index]; }
+	const Point& operator[](int index) const { return points[index]; }
+
+	Point& at(int index) {
+		assert(index >= 0 && index < count && "BlockList index out of range");
+		return points[index];
+	}
+	const Point& at(int index) const {
+		assert(index >= 0 && index < count && "BlockList index out of range");
+		return points[index];
+	}
+
+	// iterators, so a BlockList can be used in a range-based for loop
+	Point* begin() { return points; }
+	Point* end() { return points + count; }
+	const Point* begin() const { return points; }
+	const Point* end() const { return points + count; }
+
+	// copy the blocks into a std::vector (for callers that need one)
+	std::vector<Point> toVector() const { return std::vector<Point>(begin(), end()); }
+};
+
+#endif /* BLOCKLIST_H */
@@ -0,0 +1,210 @@
+#include "CorpusAnalyzer.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+
+const int CorpusStatistics::MAX_ROWS;
+
+namespace
+{
+	const std::int64_t SUMMARY_GRAIN{ 4096 };	// the index entries a worker takes at a time
+	const std::int64_t ANALYSIS_GRAIN{ 8 };		// the replays a worker plays back at a time
+}
+
+// print the summary
+// - params: none
+// - return: nothing
+void CorpusSummary::printToConsole() const
+{
+	std::cout << replays << " replays (" << gamesOver << " ended, " << replayBytes / 1024 << " KB) summarized on "
+		<< threads << " threads in " << seconds * 1000 << " ms\n";
+	score.printToConsole("score ");
+	linesCleared.printToConsole("lines ");
+	placements.printToConsole("pieces");
+	frames.printToConsole("frames");
+}
+
+// the mean score of the games after a number of placements
+// - param 1: the number of placements, in [1, CURVE_LENGTH]
+// - return: double, the mean (0 if no game made that many)
+double CorpusStatistics::getMeanScore(int placements) const
+{
+	assert(placements >= 1 && placements <= CURVE_LENGTH && "CorpusStatistics::getMeanScore() - not on the curve");
+	const std::uint64_t games = gamesAt[placements - 1];
+	return (games == 0) ? 0 : static_cast<double>(scoreAt[placements - 1]) / games;
+}
+
+// add the counts of another CorpusStatistics (eg: one filled on another thread)
+// - param 1: the other CorpusStatistics
+// - return: nothing
+void CorpusStatistics::merge(const CorpusStatistics& other)
+{
+	replays += other.replays;
+	unreadable += other.unreadable;
+	divergent += other.divergent;
+	replayBytes += other.replayBytes;
+	placements += other.placements;
+	for (int rows = 0; rows <= MAX_ROWS; rows++)
+	{
+		clears[rows] += other.clears[rows];
+	}
+	for (int shape = 0; shape < Tetromino::SHAPE_COUNT; shape++)
+	{
+		deaths[shape] += other.deaths[shape];
+	}
+	survivors += other.survivors;
+	for (int i = 0; i < CURVE_LENGTH; i++)
+	{
+		gamesAt[i] += other.gamesAt[i];
+		scoreAt[i] += other.scoreAt[i];
+	}
+}
+
+// print the statistics (the score curve at a few placements)
+// - params: none
+// - return: nothing
+void CorpusStatistics::printToConsole() const
+{
+	const double megabytes = replayBytes / (1024.0 * 1024.0);
+	std::cout << replays << " replays (" << unreadable << " unreadable, " << divergent << " divergent) played back on "
+		<< threads << " threads in " << seconds << " s: " << ((seconds > 0) ? replays / seconds : 0) << " replays/s, "
+		<< ((seconds > 0) ? megabytes / seconds : 0) << " MB/s\n";
+
+	std::cout << "  rows per placement:";
+	for (int rows = 0; rows <= MAX_ROWS; rows++)
+	{
+		std::cout << "  " << rows << ": " << ((placements > 0) ? 100.0 * clears[rows] / placements : 0) << "%";
+	}
+	std::cout << "\n  ended by:";
+	const char* shapeNames = "SZLJOIT";		// in TetShape order
+	for (int shape = 0; shape < Tetromino::SHAPE_COUNT; shape++)
+	{
+		std::cout << "  " << shapeNames[shape] << ": " << deaths[shape];
+	}
+	std::cout << "  (not ended: " << survivors << ")\n  mean score after:";
+	for (int at : { 10, 50, 100, 250, 500, 1000 })
+	{
+		if (at <= CURVE_LENGTH && gamesAt[at - 1] > 0)
+			std::cout << "  " << at << " pieces: " << getMeanScore(at) << " (" << gamesAt[at - 1] << " games)";
+	}
+	std::cout << "\n";
+}
+
+// constructor, start the threads
+// - param 1: the number of threads (0 to use every hardware thread)
+CorpusAnalyzer::CorpusAnalyzer(int threadCount) : pool{ threadCount }
+{
+	for (int i = 0; i < pool.getThreadCount(); i++)
+	{
+		workers.push_back(std::unique_ptr<Worker>(new Worker{ TetrisEngine(), Replay(), CorpusSummary{}, CorpusStatistics{} }));
+	}
+}
+
+// summarize a range of a corpus' replays from the index
+// - param 1: the corpus (open)
+// - param 2: the first replay
+// - param 3: the end of the range (past the last replay; clamped to the corpus' size)
+// - return: a CorpusSummary
+CorpusSummary CorpusAnalyzer::summarize(const ReplayCorpus& corpus, std::uint64_t first, std::uint64_t end)
+{
+	end = std::min(end, corpus.getReplayCount());
+	first = std::min(first, end);
+	const std::size_t count = static_cast<std::size_t>(end - first);
+	std::vector<std::int64_t> score(count), linesCleared(count), placements(count), frames(count);
+
+	const auto start = std::chrono::steady_clock::now();
+	for (std::unique_ptr<Worker>& worker : workers)
+	{
+		worker->summary = CorpusSummary{};
+	}
+	pool.parallelFor(static_cast<std::int64_t>(count), [&](std::int64_t i, int worker) {
+		const ReplayCorpus::Entry entry = corpus.getEntry(first + i);
+		score[i] = entry.result.score;
+		linesCleared[i] = entry.result.linesCleared;
+		placements[i] = entry.result.placementCount;
+		frames[i] = entry.result.frames;
+		CorpusSummary& summary = workers[worker]->summary;
+		summary.gamesOver += entry.result.gameOver;
+		summary.replayBytes += entry.size;
+	}, SUMMARY_GRAIN);
+
+	CorpusSummary summary{};
+	summary.replays = count;
+	summary.threads = pool.getThreadCount();
+	for (const std::unique_ptr<Worker>& worker : workers)
+	{
+		summary.gamesOver += worker->summary.gamesOver;
+		summary.replayBytes += worker->summary.replayBytes;
+	}
+	summary.score = Distribution::of(score);
+	summary.linesCleared = Distribution::of(linesCleared);
+	summary.placements = Distribution::of(placements);
+	summary.frames = Distribution::of(frames);
+	summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return summary;
+}
+
+// play back a range of a corpus' replays & count what happened in them
+// - param 1: the corpus (open)
+// - param 2: the first replay
+// - param 3: the end of the range (past the last replay; clamped to the corpus' size)
+// - return: the CorpusStatistics
+CorpusStatistics CorpusAnalyzer::analyze(const ReplayCorpus& corpus, std::uint64_t first, std::uint64_t end)
+{
+	end = std::min(end, corpus.getReplayCount());
+	first = std::min(first, end);
+
+	const auto start = std::chrono::steady_clock::now();
+	for (std::unique_ptr<Worker>& worker : workers)
+	{
+		worker->statistics = CorpusStatistics{};
+	}
+	pool.parallelFor(static_cast<std::int64_t>(end - first), [&](std::int64_t i, int worker) {
+		Worker& w = *workers[worker];
+		CorpusStatistics& statistics = w.statistics;
+		std::size_t size;
+		const std::uint8_t* data = corpus.getReplayData(first + i, size);
+		if (data == nullptr || !w.replay.decode(data, size))
+		{
+			statistics.unreadable++;
+			return;
+		}
+		statistics.replays++;
+		statistics.replayBytes += size;
+
+		w.replay.play(w.engine, [&statistics](const TetrisEngine& engine) {
+			const int placement = engine.getPlacementCount();
+			statistics.placements++;
+			statistics.clears[std::min(engine.getRowsClearedLastPlacement(), CorpusStatistics::MAX_ROWS)]++;
+			if (placement <= CorpusStatistics::CURVE_LENGTH)
+			{
+				statistics.gamesAt[placement - 1]++;
+				statistics.scoreAt[placement - 1] += engine.getScore();
+			}
+		});
+
+		// a game ends when the next shape has no room to spawn
+		if (w.engine.isGameOver())
+			statistics.deaths[static_cast<int>(w.engine.getNextShape().getShape())]++;
+		else
+			statistics.survivors++;
+		if (ReplayResult::of(w.engine) != w.replay.getResult())
+			statistics.divergent++;
+	}, ANALYSIS_GRAIN);
+
+	CorpusStatistics statistics{};
+	for (const std::unique_ptr<Worker>& worker : workers)
+	{
+		statistics.merge(worker->statistics);
+	}
+	statistics.threads = pool.getThreadCount();
+	statistics.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return statistics;
+}
+
+// the number of worker threads
+int CorpusAnalyzer::getThreadCount() const
+{
+	return pool.getThreadCount();
+}
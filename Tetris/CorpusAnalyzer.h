@@ -0,0 +1,127 @@
+// The CorpusAnalyzer class computes statistics over a ReplayCorpus, across every core.
+//
+// Two passes, over any range of the corpus' replays:
+//   - summarize() reads only the index (the recorded result of every replay), so it
+//     runs as fast as the index can be read: the distributions of the final scores,
+//     rows, pieces & game lengths.
+//   - analyze() plays every replay back, following each game piece by piece: the mean
+//     score after each placement (the score curve), how many rows each placement
+//     removed, and what ended the games (the shape that had no room to spawn).  A replay
+//     that doesn't end like it was recorded is counted as divergent.
+//
+// The replays are spread over a WorkStealingPool in small runs of the index.  Every
+// worker owns its engine, Replay & counts (allocated once, reused for all its replays),
+// so the replays are read in place from the mapped corpus and the workers share
+// nothing; their counts are merged at the end.
+
+#ifndef CORPUSANALYZER_H
+#define CORPUSANALYZER_H
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+#include "BatchSimulator.h"
+#include "Replay.h"
+#include "ReplayCorpus.h"
+#include "TetrisEngine.h"
+#include "Tetromino.h"
+#include "WorkStealingPool.h"
+
+// a summary of the replays of a corpus, from the index alone
+struct CorpusSummary
+{
+	std::uint64_t replays;			// the replays summarized
+	std::uint64_t gamesOver;		// the ones of games that ended (the others stopped before)
+	std::uint64_t replayBytes;		// the size of the replays
+	int threads;					// the number of worker threads used
+	double seconds;					// the wall-clock time the pass took
+
+	Distribution score;
+	Distribution linesCleared;
+	Distribution placements;
+	Distribution frames;
+
+	// print the summary
+	// - params: none
+	// - return: nothing
+	void printToConsole() const;
+};
+
+// what playing back the replays of a corpus showed
+struct CorpusStatistics
+{
+	static const int CURVE_LENGTH{ 1000 };	// the placements the score curve follows
+	static const int MAX_ROWS{ 4 };			// the most rows a placement removes
+
+	std::uint64_t replays;						// the replays played back
+	std::uint64_t unreadable;					// the replays that couldn't be decoded
+	std::uint64_t divergent;					// the ones that didn't end like they were recorded
+	std::uint64_t replayBytes;					// the size of the replays read
+	std::uint64_t placements;
+	std::uint64_t clears[MAX_ROWS + 1];			// the placements that removed 0, 1... rows
+	std::uint64_t deaths[Tetromino::SHAPE_COUNT];	// the games that ended, by the shape that couldn't spawn
+	std::uint64_t survivors;					// the games that hadn't ended when the recording stopped
+	std::uint64_t gamesAt[CURVE_LENGTH];		// the games that made at least i + 1 placements
+	std::uint64_t scoreAt[CURVE_LENGTH];		// their total score after placement i + 1
+	int threads;								// the number of worker threads used
+	double seconds;								// the wall-clock time the pass took
+
+	// the mean score of the games after a number of placements
+	// - param 1: the number of placements, in [1, CURVE_LENGTH]
+	// - return: double, the mean (0 if no game made that many)
+	double getMeanScore(int placements) const;
+
+	// add the counts of another CorpusStatistics (eg: one filled on another thread)
+	// - param 1: the other CorpusStatistics
+	// - return: nothing
+	void merge(const CorpusStatistics& other);
+
+	// print the statistics (the score curve at a few placements)
+	// - params: none
+	// - return: nothing
+	void printToConsole() const;
+};
+
+class CorpusAnalyzer
+{
+private:
+	// a worker's own engine, replay & counts (separately allocated, so workers never share a cache line)
+	struct Worker
+	{
+		TetrisEngine engine;
+		Replay replay;
+		CorpusSummary summary;			// the counts of the worker's part of a summarize()
+		CorpusStatistics statistics;	// the counts of the worker's part of an analyze()
+	};
+
+	// MEMBER VARIABLES
+	WorkStealingPool pool;							// the worker threads
+	std::vector<std::unique_ptr<Worker>> workers;	// a Worker per thread
+
+public:
+	// constructor, start the threads
+	// - param 1: the number of threads (0 to use every hardware thread)
+	explicit CorpusAnalyzer(int threadCount = 0);
+
+	// summarize a range of a corpus' replays from the index
+	// - param 1: the corpus (open)
+	// - param 2: the first replay
+	// - param 3: the end of the range (past the last replay; clamped to the corpus' size)
+	// - return: a CorpusSummary
+	CorpusSummary summarize(const ReplayCorpus& corpus, std::uint64_t first = 0,
+		std::uint64_t end = std::numeric_limits<std::uint64_t>::max());
+
+	// play back a range of a corpus' replays & count what happened in them
+	// - param 1: the corpus (open)
+	// - param 2: the first replay
+	// - param 3: the end of the range (past the last replay; clamped to the corpus' size)
+	// - return: the CorpusStatistics
+	CorpusStatistics analyze(const ReplayCorpus& corpus, std::uint64_t first = 0,
+		std::uint64_t end = std::numeric_limits<std::uint64_t>::max());
+
+	// the number of worker threads
+	int getThreadCount() const;
+};
+
+#endif /* CORPUSANALYZER_H */
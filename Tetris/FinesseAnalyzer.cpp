@@ -0,0 +1,230 @@
+#include "FinesseAnalyzer.h"
+#include <algorithm>
+#include <cassert>
+#include "GridTetromino.h"
+
+namespace
+{
+	// the optimal KeySequence of every shape, rotation & column
+	struct FinesseTable
+	{
+		FinesseAnalyzer::KeySequence sequences[Tetromino::SHAPE_COUNT][Tetromino::ROTATION_COUNT][Gameboard::MAX_X];
+
+		FinesseTable()
+		{
+			for (int s = 0; s < Tetromino::SHAPE_COUNT; s++)
+			{
+				build(static_cast<TetShape>(s));
+			}
+		}
+
+		// search a shape's states (rotation, x) from the spawn location, breadth first,
+		// & give every state the shortest sequence that lands on its cells
+		void build(TetShape shape)
+		{
+			const int STATE_COUNT{ Tetromino::ROTATION_COUNT * Gameboard::MAX_X };
+			int depth[STATE_COUNT];
+			int parent[STATE_COUNT];
+			GameAction parentAction[STATE_COUNT];
+			std::uint64_t cells[STATE_COUNT];	// the cells the state lands on (see getLandedCells())
+			int queue[STATE_COUNT];
+			std::fill(depth, depth + STATE_COUNT, -1);
+
+			GridTetromino spawned;
+			spawned.setShape(shape);
+			spawned.setGridLoc(Gameboard().getSpawnLoc());
+			const int start = getState(spawned);
+			depth[start] = 0;
+			parent[start] = -1;
+			cells[start] = getLandedCells(spawned);
+			int queueEnd = 0;
+			queue[queueEnd++] = start;
+
+			// the key order breaks ties: rotations first, then moves
+			const GameAction moves[] = { GameAction::ROTATE, GameAction::MOVE_LEFT, GameAction::MOVE_RIGHT };
+			for (int queueIndex = 0; queueIndex < queueEnd; queueIndex++)
+			{
+				const int from = queue[queueIndex];
+				for (GameAction move : moves)
+				{
+					GridTetromino next = getShape(shape, from, spawned.getGridLoc().getY());
+					if (move == GameAction::ROTATE)
+						next.rotateClockwise();
+					else
+						next.move(move == GameAction::MOVE_LEFT ? -1 : 1, 0);
+					if (!isInside(next) || depth[getState(next)] >= 0)
+						continue;
+					const int state = getState(next);
+					depth[state] = depth[from] + 1;
+					parent[state] = from;
+					parentAction[state] = move;
+					cells[state] = getLandedCells(next);
+					queue[queueEnd++] = state;
+				}
+			}
+
+			// every state: the shortest of the states landing on the same cells
+			for (int state = 0; state < STATE_COUNT; state++)
+			{
+				FinesseAnalyzer::KeySequence& sequence = sequences[static_cast<int>(shape)][state / Gameboard::MAX_X][state % Gameboard::MAX_X];
+				sequence.keyCount = 0;
+				if (depth[state] < 0)
+					continue;
+				int best = state;
+				for (int other = 0; other < STATE_COUNT; other++)
+				{
+					if (depth[other] >= 0 && cells[other] == cells[state] && depth[other] < depth[best])
+						best = other;
+				}
+				sequence.keyCount = depth[best] + 1;
+				assert(sequence.keyCount <= FinesseAnalyzer::MAX_KEYS && "FinesseTable - a sequence is too long");
+				sequence.keys[depth[best]] = GameAction::HARD_DROP;
+				for (int at = best, i = depth[best] - 1; i >= 0; at = parent[at], i--)
+				{
+					sequence.keys[i] = parentAction[at];
+				}
+			}
+		}
+
+		// the index of a shape's state
+		static int getState(const GridTetromino& shape)
+		{
+			return shape.getRotation() * Gameboard::MAX_X + shape.getGridLoc().getX();
+		}
+
+		// a state as a shape (at the spawn row)
+		static GridTetromino getShape(TetShape shape, int state, int y)
+		{
+			GridTetromino result;
+			result.setShape(shape);
+			for (int turn = 0; turn < state / Gameboard::MAX_X; turn++)
+			{
+				result.rotateClockwise();
+			}
+			result.setGridLoc(Point(state % Gameboard::MAX_X, y));
+			return result;
+		}
+
+		// true if every block is within the left & right borders (the board is empty)
+		static bool isInside(const GridTetromino& shape)
+		{
+			for (const Point& p : shape.getMappedBlockLocs())
+			{
+				if (p.getX() < 0 || p.getX() >= Gameboard::MAX_X)
+					return false;
+			}
+			return true;
+		}
+
+		// the cells a shape covers once hard dropped on an empty board (its blocks, with
+		// the lowest one on row 0): bit (x + MAX_X * (rows above the lowest block))
+		static std::uint64_t getLandedCells(const GridTetromino& shape)
+		{
+			const BlockList blocks = shape.getMappedBlockLocs();
+			int lowest = blocks[0].getY();
+			for (const Point& p : blocks)
+			{
+				lowest = std::max(lowest, p.getY());
+			}
+			std::uint64_t cells = 0;
+			for (const Point& p : blocks)
+			{
+				cells |= std::uint64_t{ 1 } << (p.getX() + Gameboard::MAX_X * (lowest - p.getY()));
+			}
+			return cells;
+		}
+	};
+
+	const FinesseTable& getFinesseTable()
+	{
+		static const FinesseTable table;
+		return table;
+	}
+}
+
+// the fewest keys that take a shape from the spawn location to a rotation & column,
+//   then hard drop it (looked up in the precomputed table)
+// - param 1: the shape
+// - param 2: the rotation
+// - param 3: the x of the shape's grid location
+// - return: a KeySequence (keyCount 0 if the shape can't be there)
+const FinesseAnalyzer::KeySequence& FinesseAnalyzer::getOptimalSequence(TetShape shape, int rotation, int x)
+{
+	assert(rotation >= 0 && rotation < Tetromino::ROTATION_COUNT && x >= 0 && x < Gameboard::MAX_X);
+	return getFinesseTable().sequences[static_cast<int>(shape)][rotation][x];
+}
+
+// the faults of a placement: the keys pressed beyond the optimum (0 if none, or if
+//   the placement can't be reached)
+// - params 1-3: the placed shape, rotation & x
+// - param 4: the keys pressed to place it (including the drop)
+// - return: int, the faults
+int FinesseAnalyzer::getFaults(TetShape shape, int rotation, int x, int keysPressed)
+{
+	const KeySequence& optimal = getOptimalSequence(shape, rotation, x);
+	if (optimal.keyCount == 0)
+		return 0;
+	return std::max(0, keysPressed - optimal.keyCount);
+}
+
+// count a placement
+// - params 1-3: the placed shape, rotation & x
+// - param 4: the keys pressed to place it (including the drop)
+// - return: int, the placement's faults
+int FinesseAnalyzer::addPlacement(TetShape shape, int rotation, int x, int keysPressed)
+{
+	const int faults = getFaults(shape, rotation, x, keysPressed);
+	placementCount++;
+	keyCount += keysPressed;
+	optimalKeyCount += getOptimalSequence(shape, rotation, x).keyCount;
+	faultCount += faults;
+	faultyPlacementCount += (faults > 0);
+	return faults;
+}
+
+// add the counts of another analyzer (eg: one filled on another thread)
+// - param 1: the other analyzer
+// - return: nothing
+void FinesseAnalyzer::merge(const FinesseAnalyzer& other)
+{
+	placementCount += other.placementCount;
+	keyCount += other.keyCount;
+	optimalKeyCount += other.optimalKeyCount;
+	faultCount += other.faultCount;
+	faultyPlacementCount += other.faultyPlacementCount;
+}
+
+// forget every placement counted
+// - params: none
+// - return: nothing
+void FinesseAnalyzer::reset()
+{
+	*this = FinesseAnalyzer();
+}
+
+// Getters ======================================================
+
+std::uint64_t FinesseAnalyzer::getPlacementCount() const
+{
+	return placementCount;
+}
+
+std::uint64_t FinesseAnalyzer::getKeyCount() const
+{
+	return keyCount;
+}
+
+std::uint64_t FinesseAnalyzer::getOptimalKeyCount() const
+{
+	return optimalKeyCount;
+}
+
+std::uint64_t FinesseAnalyzer::getFaultCount() const
+{
+	return faultCount;
+}
+
+std::uint64_t FinesseAnalyzer::getFaultyPlacementCount() const
+{
+	return faultyPlacementCount;
+}
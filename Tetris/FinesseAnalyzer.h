@@ -0,0 +1,89 @@
+// The FinesseAnalyzer class scores how efficiently a player places shapes ("finesse"):
+// the keys pressed to place a shape, against the fewest keys that reach the same place.
+//
+// The fewest keys are precomputed once (the first time they're needed), for every
+// shape, rotation & column: a breadth first search from the spawn location over the
+// moves a key makes (rotate, move left, move right), ending with the hard drop.  The
+// search is done on an empty board, so the table doesn't depend on the stack, and a
+// placement is any state that lands on the same cells (eg: an I or an S rotated twice,
+// or any rotation of an O), so the shortest of them is the optimum.  A lookup is then
+// an array index, cheap enough to score every placement of a live game, or millions of
+// archived placements.
+//
+// A placement's faults are the keys pressed beyond the optimum.  Placements that need
+// more than a straight drop (tucks & spins under an overhang) count as faults too.
+//
+// An analyzer accumulates the placements of one or more games; analyzers filled on
+// different threads can be merged.
+
+#ifndef FINESSEANALYZER_H
+#define FINESSEANALYZER_H
+
+#include <cstdint>
+#include "Gameboard.h"
+#include "TetrisEngine.h"
+#include "Tetromino.h"
+
+class FinesseAnalyzer
+{
+public:
+	// CONSTANTS
+	static const int MAX_KEYS{ 12 };	// the most keys an optimal sequence can have
+
+	// the keys that place a shape (the last one is the HARD_DROP)
+	struct KeySequence
+	{
+		int keyCount;					// 0 if the placement can't be reached
+		GameAction keys[MAX_KEYS];
+	};
+
+private:
+	// MEMBER VARIABLES
+	std::uint64_t placementCount{ 0 };			// the placements counted
+	std::uint64_t keyCount{ 0 };				// the keys they were made with
+	std::uint64_t optimalKeyCount{ 0 };			// the fewest keys that make them
+	std::uint64_t faultCount{ 0 };				// the keys pressed beyond the optimum
+	std::uint64_t faultyPlacementCount{ 0 };	// the placements with at least one fault
+
+public:
+	// the fewest keys that take a shape from the spawn location to a rotation & column,
+	//   then hard drop it (looked up in the precomputed table)
+	// - param 1: the shape
+	// - param 2: the rotation
+	// - param 3: the x of the shape's grid location
+	// - return: a KeySequence (keyCount 0 if the shape can't be there)
+	static const KeySequence& getOptimalSequence(TetShape shape, int rotation, int x);
+
+	// the faults of a placement: the keys pressed beyond the optimum (0 if none, or if
+	//   the placement can't be reached)
+	// - params 1-3: the placed shape, rotation & x
+	// - param 4: the keys pressed to place it (including the drop)
+	// - return: int, the faults
+	static int getFaults(TetShape shape, int rotation, int x, int keysPressed);
+
+	// count a placement
+	// - params 1-3: the placed shape, rotation & x
+	// - param 4: the keys pressed to place it (including the drop)
+	// - return: int, the placement's faults
+	int addPlacement(TetShape shape, int rotation, int x, int keysPressed);
+
+	// add the counts of another analyzer (eg: one filled on another thread)
+	// - param 1: the other analyzer
+	// - return: nothing
+	void merge(const FinesseAnalyzer& other);
+
+	// forget every placement counted
+	// - params: none
+	// - return: nothing
+	void reset();
+
+	// Getters ======================================================
+
+	std::uint64_t getPlacementCount() const;
+	std::uint64_t getKeyCount() const;
+	std::uint64_t getOptimalKeyCount() const;
+	std::uint64_t getFaultCount() const;
+	std::uint64_t getFaultyPlacementCount() const;
+};
+
+#endif /* FINESSEANALYZER_H */
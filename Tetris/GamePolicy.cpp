@@ -0,0 +1,40 @@
+#include "GamePolicy.h"
+
+// get ready for a new game (forget any plans, restart any randomness)
+// - param 1: a 64 bit seed for the game
+// - return: nothing
+void RandomPolicy::reset(std::uint64_t seed)
+{
+	random.seed(seed);
+	placementsSeen = -1;
+	movesLeft = 0;
+	rotationsLeft = 0;
+	direction = GameAction::NONE;
+}
+
+// for every new shape: rotate it 0-3 times, move it 0-5 columns left or right,
+// then hard drop it
+// - param 1: the engine (the game being played)
+// - return: a GameAction
+GameAction RandomPolicy::chooseAction(const TetrisEngine& engine)
+{
+	if (engine.getPlacementCount() != placementsSeen)
+	{
+		placementsSeen = engine.getPlacementCount();
+		rotationsLeft = random.nextInt(Tetromino::ROTATION_COUNT);
+		movesLeft = random.nextInt(6);
+		direction = random.nextInt(2) ? GameAction::MOVE_LEFT : GameAction::MOVE_RIGHT;
+	}
+
+	if (rotationsLeft > 0)
+	{
+		rotationsLeft--;
+		return GameAction::ROTATE;
+	}
+	if (movesLeft > 0)
+	{
+		movesLeft--;
+		return direction;
+	}
+	return GameAction::HARD_DROP;
+}
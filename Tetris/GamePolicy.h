@@ -0,0 +1,62 @@
+// The GamePolicy class is the interface for anything that plays a TetrisEngine
+// without a keyboard: a bot picks the next GameAction from the engine's state.
+//
+// A policy is called once per frame (before the frame is stepped), and may keep state
+// between calls (eg: a planned sequence of actions).  Policies are not shared between
+// threads: a batch of games gives every worker its own instance, made by a
+// GamePolicy::Factory.
+//
+// RandomPolicy is the simplest policy: random moves, then a drop.  It is the baseline
+// the other bots are measured against.
+
+#ifndef GAMEPOLICY_H
+#define GAMEPOLICY_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include "Random.h"
+#include "TetrisEngine.h"
+
+class GamePolicy
+{
+public:
+	// makes a new instance of a policy (one per worker thread)
+	using Factory = std::function<std::unique_ptr<GamePolicy>()>;
+
+	virtual ~GamePolicy() = default;
+
+	// get ready for a new game (forget any plans, restart any randomness)
+	// - param 1: a 64 bit seed for the game
+	// - return: nothing
+	virtual void reset(std::uint64_t seed) = 0;
+
+	// pick the action to apply in the engine's next frame
+	// - param 1: the engine (the game being played)
+	// - return: a GameAction (GameAction::NONE to let the frame pass)
+	virtual GameAction chooseAction(const TetrisEngine& engine) = 0;
+};
+
+class RandomPolicy : public GamePolicy
+{
+private:
+	Random random;						// the policy's own random stream
+	int placementsSeen{ -1 };			// the engine's placement count when the current plan was made
+	int movesLeft{ 0 };					// the moves (left or right) still to make before the drop
+	int rotationsLeft{ 0 };				// the rotations still to make before the drop
+	GameAction direction{ GameAction::NONE };	// the direction to move in
+
+public:
+	// get ready for a new game (forget any plans, restart any randomness)
+	// - param 1: a 64 bit seed for the game
+	// - return: nothing
+	void reset(std::uint64_t seed) override;
+
+	// for every new shape: rotate it 0-3 times, move it 0-5 columns left or right,
+	// then hard drop it
+	// - param 1: the engine (the game being played)
+	// - return: a GameAction
+	GameAction chooseAction(const TetrisEngine& engine) override;
+};
+
+#endif /* GAMEPOLICY_H */
@@ -1,23 +1,75 @@
 #include "Gameboard.h"
 #include "iomanip"
 #include "Point.h"
+#include "Bits.h"
+#include "Random.h"
 #include <assert.h>
+#include <cstring>
+
+namespace
+{
+    const int HALF_ROW_BITS = (Gameboard::MAX_X + 1) / 2;   // the columns in each half of a row
+
+    // the Zobrist keys, combined per half row: halfRowKeys[y][half][mask] is the XOR
+    // of the keys of the locations of row y's half (0: the left columns, 1: the right)
+    // set in mask.  The keys are fixed (a splitmix64 stream), so hashes never change.
+    struct ZobristKeys
+    {
+        std::uint64_t halfRowKeys[Gameboard::MAX_Y][2][1 << HALF_ROW_BITS];
+
+        ZobristKeys()
+        {
+            std::uint64_t state = 0x5A0B81575EEDull;
+            for (int y = 0; y < Gameboard::MAX_Y; y++)
+            {
+                for (int half = 0; half < 2; half++)
+                {
+                    std::uint64_t keys[HALF_ROW_BITS];
+                    for (std::uint64_t& key : keys)
+                    {
+                        key = Random::splitMix64(state);
+                    }
+                    for (int mask = 0; mask < (1 << HALF_ROW_BITS); mask++)
+                    {
+                        std::uint64_t combined = 0;
+                        for (int bit = 0; bit < HALF_ROW_BITS; bit++)
+                        {
+                            if ((mask >> bit) & 1)
+                                combined ^= keys[bit];
+                        }
+                        halfRowKeys[y][half][mask] = combined;
+                    }
+                }
+            }
+        }
+    };
+
+    // the keys (built on first use, so boards made during static initialization work too)
+    const ZobristKeys& getZobristKeys()
+    {
+        static const ZobristKeys keys;
+        return keys;
+    }
+}
 
 Gameboard::Gameboard() { empty(); }
 
 // fill the board with EMPTY_BLOCK
-//   (iterate through each rowIndex and fillRow() with EMPTY_BLOCK))
+//   (memset the grid to EMPTY_BLOCK and every row mask to 0)
 // - params: none
 // - return: nothing
 void Gameboard::empty()
 {
-    for (int x = 0; x < MAX_X; x++)
-    {
-        for (int y = 0; y < MAX_Y; y++)
-        {
-            grid[y][x] = EMPTY_BLOCK;
-        }
-    }
+    std::memset(grid, EMPTY_BLOCK, sizeof(grid));
+    std::memset(rowMasks, 0, sizeof(rowMasks));
+    std::memset(columnMasks, 0, sizeof(columnMasks));
+    std::memset(columnHeights, 0, sizeof(columnHeights));
+    std::memset(columnHoles, 0, sizeof(columnHoles));
+    std::memset(rowFillCounts, 0, sizeof(rowFillCounts));
+    holeCount = 0;
+    stackHeight = 0;
+    hash = 0;
+    generation++;
 }
 
 // print the grid contents to the console (for debugging purposes)
@@ -35,7 +87,7 @@ void Gameboard::printToConsole() const
             if (grid[y][x] == EMPTY_BLOCK)
                 std::cout << "." << std::setw(2);
             else
-                std::cout << grid[y][x] << std::setw(2);
+                std::cout << static_cast<int>(grid[y][x]) << std::setw(2);
         }
         std::cout << "\n";
     }
@@ -77,7 +129,28 @@ void Gameboard::setContent(int x, int y, int value)
 {
     if (!isValidPoint(x, y))
         return;
-    grid[y][x] = value;
+    assert(value >= INT8_MIN && value <= INT8_MAX && "Content does not fit the grid");
+    grid[y][x] = static_cast<std::int8_t>(value);
+    generation++;
+
+    const bool wasOccupied = (rowMasks[y] >> x) & 1;
+    const bool occupied = (value != EMPTY_BLOCK);
+    if (wasOccupied == occupied)
+        return;
+    hash ^= getRowHash(y, static_cast<std::uint16_t>(1 << x));
+    if (occupied)
+    {
+        rowMasks[y] |= static_cast<std::uint16_t>(1 << x);
+        columnMasks[x] |= (1u << y);
+        rowFillCounts[y]++;
+    }
+    else
+    {
+        rowMasks[y] &= static_cast<std::uint16_t>(~(1 << x));
+        columnMasks[x] &= ~(1u << y);
+        rowFillCounts[y]--;
+    }
+    updateColumnStats(x);
 }
 
 // set the content for a set of points (ignore invalid points)
@@ -91,6 +164,17 @@ void Gameboard::setContent(const std::vector<Point> &points, int value)
     }
 }
 
+// set the content for a (fixed size) list of points (ignore invalid points)
+// - param 1: a BlockList of Points representing locations
+// - param 2: an int representing the content we want to set.
+void Gameboard::setContent(const BlockList &points, int value)
+{
+    for (const Point& p : points)
+    {
+        setContent(p, value);
+    }
+}
+
 // Determine if (valid) all points passed in are empty
 // *** IMPORTANT: Assume invalid x,y values can be passed to this method.
 // Invalid meaning outside the bounds of the grid.
@@ -100,37 +184,321 @@ void Gameboard::setContent(const std::vector<Point> &points, int value)
 // - return: true if the content at ALL VALID points is EMPTY_BLOCK, false otherwise
 bool Gameboard::areAllLocsEmpty(const std::vector<Point>& points) const
 {
-    bool allEmpty = true;
-    for (Point p : points)
+    for (const Point& p : points)
     {
-        if (!isValidPoint(p))
-            continue;
-        if (grid[p.getY()][p.getX()] != EMPTY_BLOCK) {
-            allEmpty = false;
-        }
+        if (isOccupied(p.getX(), p.getY()))
+            return false;
+    }
+    return true;
+}
+
+// Same as above, for a (fixed size) list of points (doesn't allocate)
+// - param 1: a BlockList of Points representing locations to test
+// - return: true if the content at ALL VALID points is EMPTY_BLOCK, false otherwise
+bool Gameboard::areAllLocsEmpty(const BlockList& points) const
+{
+    for (const Point& p : points)
+    {
+        if (isOccupied(p.getX(), p.getY()))
+            return false;
     }
-    return allEmpty;
+    return true;
+}
+
+// Determine if a given XY is occupied (holds content other than EMPTY_BLOCK)
+// Invalid x,y values are not occupied.
+// - param 1: an int for X (column)
+// - param 2: an int for Y (row)
+// - return: true if the (valid) x,y holds content, false otherwise
+bool Gameboard::isOccupied(int x, int y) const
+{
+    if (!isValidPoint(x, y))
+        return false;
+    return (rowMasks[y] >> x) & 1;
+}
+
+// get the occupancy bitmask of a row (bit x set = column x holds content)
+// assert the row index is valid
+// - param 1: an int representing the row index
+// - return: the row's occupancy mask (FULL_ROW_MASK if the row is completed)
+std::uint16_t Gameboard::getRowMask(int index) const
+{
+    assert(index >= 0 && index < MAX_Y);
+    return rowMasks[index];
 }
 
 // Remove all completed rows from the board
-//   use getCompletedRowIndices() and removeRows()
+//   use compactCompletedRows()
 // - params: none
 // - return: the count of completed rows removed
 int Gameboard::removeCompletedRows()
 {
-    int count = getCompletedRowIndices().size();
-    removeRows(getCompletedRowIndices());
-    return count;
+    return compactCompletedRows().count;
+}
+
+// Remove all completed rows from the board in a single bottom-up pass:
+//   walk the rows from the bottom up, skip completed rows and write every
+//   other row straight into its final position, then fill the rows left
+//   over at the top with EMPTY_BLOCK.
+//   (each row is copied at most once, whatever the number of completed rows)
+// - params: none
+// - return: a RowClearResult, the count & mask of the completed rows removed
+Gameboard::RowClearResult Gameboard::compactCompletedRows()
+{
+    RowClearResult result{ 0, 0 };
+    int target = MAX_Y - 1;     // where the next kept row goes
+    for (int y = MAX_Y - 1; y >= 0; y--)
+    {
+        if (rowMasks[y] == FULL_ROW_MASK)
+        {
+            result.count++;
+            result.rowMask |= (1u << y);
+            hash ^= getRowHash(y, rowMasks[y]);
+            continue;
+        }
+        if (target != y)
+        {
+            // the row's keys change with its row index
+            hash ^= getRowHash(y, rowMasks[y]) ^ getRowHash(target, rowMasks[y]);
+            std::memcpy(grid[target], grid[y], sizeof(grid[target]));
+            rowMasks[target] = rowMasks[y];
+            rowFillCounts[target] = rowFillCounts[y];
+        }
+        target--;
+    }
+    if (result.count == 0)
+        return result;
+
+    for (int y = target; y >= 0; y--)
+    {
+        std::memset(grid[y], EMPTY_BLOCK, sizeof(grid[y]));
+        rowMasks[y] = 0;
+        rowFillCounts[y] = 0;
+    }
+
+    // the removed rows were full, so each column just loses the removed rows' bits
+    // (every bit above a removed row shifts down by one for each removed row below it)
+    for (int x = 0; x < MAX_X; x++)
+    {
+        std::uint32_t mask = columnMasks[x];
+        for (std::uint32_t rows = result.rowMask; rows; rows &= rows - 1)
+        {
+            const int y = countTrailingZeros(rows);
+            const std::uint32_t below = mask & ~((2u << y) - 1);    // rows under y stay put
+            const std::uint32_t above = mask & ((1u << y) - 1);     // rows over y drop one
+            mask = below | (above << 1);
+        }
+        columnMasks[x] = mask;
+        updateColumnStats(x);
+    }
+    generation++;
+    return result;
+}
+
+// Put back the rows removed by compactCompletedRows() (eg: to undo a placement):
+//   walk the rows from the top down, writing each removed row back at its
+//   index and every other row back up where it came from (the inverse of the
+//   compaction, each row is copied at most once).
+// - param 1: the RowClearResult compactCompletedRows() returned
+// - param 2: the contents of the removed rows, top row first (result.count of them)
+// - return: nothing
+void Gameboard::restoreCompletedRows(const RowClearResult& result, const std::int8_t removedRows[][MAX_X])
+{
+    if (result.count == 0)
+        return;
+
+    // a kept row y sits result.count rows lower, less the removed rows above it
+    // (so reading from source >= y while writing y, top down, never overwrites a row not read yet)
+    int source = result.count;
+    int removed = 0;
+    for (int y = 0; y < MAX_Y; y++)
+    {
+        if ((result.rowMask >> y) & 1)
+        {
+            std::memcpy(grid[y], removedRows[removed++], sizeof(grid[y]));
+            rowMasks[y] = FULL_ROW_MASK;
+            rowFillCounts[y] = MAX_X;
+            continue;
+        }
+        if (source != y)
+        {
+            std::memcpy(grid[y], grid[source], sizeof(grid[y]));
+            rowMasks[y] = rowMasks[source];
+            rowFillCounts[y] = rowFillCounts[source];
+        }
+        source++;
+    }
+    assert(removed == result.count && source == MAX_Y);
+
+    // undo each column's removals, the last one removed first
+    // (the rows under a removed row stay put, those over it go back up by one)
+    for (int x = 0; x < MAX_X; x++)
+    {
+        std::uint32_t mask = columnMasks[x];
+        for (int y = MAX_Y - 1; y >= 0; y--)
+        {
+            if (!((result.rowMask >> y) & 1))
+                continue;
+            const std::uint32_t below = mask & ~((2u << y) - 1);
+            const std::uint32_t above = (mask >> 1) & ((1u << y) - 1);
+            mask = below | above | (1u << y);
+        }
+        columnMasks[x] = mask;
+        updateColumnStats(x);
+    }
+    hash = computeHash();
+    generation++;
+}
+
+// put back a snapshot of a board (a copy of this or any other board)
+//   Like assignment, but counted as a change of this board: the generation
+//   moves on from this board's own (an assignment would copy the snapshot's,
+//   which a cache of this board may have seen with other content).
+// - param 1: the snapshot
+// - return: nothing
+void Gameboard::restore(const Gameboard& snapshot)
+{
+    const unsigned int nextGeneration = generation + 1;
+    *this = snapshot;
+    generation = nextGeneration;
 }
 
 // A getter for the spawn location
 // - params: none
 // - returns: a Point, representing our private spawnLoc
 // return the spawn location
-Point Gameboard::getSpawnLoc() {
+Point Gameboard::getSpawnLoc() const {
     return spawnLoc;
 }
 
+// A getter for the content generation. Every change to the grid content
+// (setContent, row removal, empty...) bumps it, so anything derived from
+// the grid only needs to be rebuilt when the generation it was built from
+// no longer matches.  A constructed board is never at generation 0.
+// - params: none
+// - returns: an unsigned int, the current generation
+unsigned int Gameboard::getGeneration() const {
+    return generation;
+}
+
+// A getter for the occupancy hash: the XOR of a fixed random 64 bit key for
+// each occupied location (0 for an empty board).  Kept up to date by every
+// change to the grid: setContent() flips the location's key when its
+// occupancy changes, and removing rows re-derives the hash of the rows that
+// moved from their row masks (two table lookups per row).
+// - params: none
+// - returns: a 64 bit hash, equal for boards with the same occupied locations
+std::uint64_t Gameboard::getHash() const {
+    return hash;
+}
+
+// the hash the board would have with a set of (empty) locations occupied, eg:
+// once a tetromino is locked at its mapped block locs (before any completed rows
+// are removed).  Lets a search look a board up without building it.
+// Invalid and occupied points are ignored.
+// - param 1: a BlockList of Points representing locations
+// - returns: a 64 bit hash
+std::uint64_t Gameboard::getHashWith(const BlockList& points) const {
+    std::uint64_t result = hash;
+    for (const Point& p : points) {
+        if (isValidPoint(p) && !isOccupied(p.getX(), p.getY()))
+            result ^= getRowHash(p.getY(), static_cast<std::uint16_t>(1 << p.getX()));
+    }
+    return result;
+}
+
+// get the height of a column: MAX_Y - the row index of its highest block
+// (0 for an empty column, MAX_Y for a column filled to the top row)
+// assert the column index is valid
+// - param 1: an int representing the column index (x)
+// - return: an int, the column height
+int Gameboard::getColumnHeight(int x) const
+{
+    assert(x >= 0 && x < MAX_X);
+    return columnHeights[x];
+}
+
+// get the number of holes in a column: empty locations below its highest block
+// assert the column index is valid
+// - param 1: an int representing the column index (x)
+// - return: an int, the number of holes in the column
+int Gameboard::getColumnHoleCount(int x) const
+{
+    assert(x >= 0 && x < MAX_X);
+    return columnHoles[x];
+}
+
+// get the occupancy bitmask of a column (bit y set = row y holds content)
+// assert the column index is valid
+// - param 1: an int representing the column index (x)
+// - return: the column's occupancy mask
+std::uint32_t Gameboard::getColumnMask(int x) const
+{
+    assert(x >= 0 && x < MAX_X);
+    return columnMasks[x];
+}
+
+// get the number of blocks in a row
+// assert the row index is valid
+// - param 1: an int representing the row index (y)
+// - return: an int, the number of blocks in the row (MAX_X if completed)
+int Gameboard::getRowFillCount(int y) const
+{
+    assert(y >= 0 && y < MAX_Y);
+    return rowFillCounts[y];
+}
+
+// get the total number of holes on the board (the sum of every column's holes)
+// - params: none
+// - return: an int, the number of holes
+int Gameboard::getHoleCount() const
+{
+    return holeCount;
+}
+
+// get the height of the tallest column
+// - params: none
+// - return: an int, 0 for an empty board
+int Gameboard::getStackHeight() const
+{
+    return stackHeight;
+}
+
+// get the row index of the highest block on the board
+// - params: none
+// - return: an int, the highest occupied row (MAX_Y for an empty board)
+int Gameboard::getHighestOccupiedRow() const
+{
+    return MAX_Y - stackHeight;
+}
+
+// Determine how far a set of locations (eg: a tetromino's mapped block locs)
+// can move straight down before one of them would hit content or go below
+// the bottom of the grid.  Computed directly from the column masks: find the
+// first occupied row under each location; the smallest gap wins (so only the
+// lowest location in each column matters).  Rows above the grid are empty.
+// Assumes the locations themselves are legal (within the left, right and
+// bottom borders and not occupied).
+// - param 1: a BlockList of Points representing locations
+// - return: an int, the number of rows the locations can drop (0 or more)
+int Gameboard::getDropDistance(const BlockList& points) const
+{
+    int distance = MAX_Y;
+    for (const Point& p : points)
+    {
+        assert(p.getX() >= 0 && p.getX() < MAX_X && p.getY() < MAX_Y);
+        // the first row below p that holds content (or the floor at MAX_Y).
+        // (a block of the same shape lower in the column only gives a smaller
+        // distance for this column, so every point can be tested on its own)
+        const int firstRowBelow = (p.getY() + 1 > 0) ? p.getY() + 1 : 0;
+        const std::uint32_t below = columnMasks[p.getX()] >> firstRowBelow;
+        const int landingRow = below ? firstRowBelow + countTrailingZeros(below) : MAX_Y;
+        if (landingRow - p.getY() - 1 < distance)
+            distance = landingRow - p.getY() - 1;
+    }
+    return distance;
+}
+
 // private methods
 
 // Determine if a given Point is a valid grid location
@@ -156,22 +524,90 @@ bool Gameboard::isValidPoint(int x, int y) const
     return true;
 }
 
+// bring a column's height & hole count (and the board's hole count & stack
+// height) up to date after its column mask changed.  O(1) via bit counting.
+// - param 1: an int representing the column index (x)
+// - return: nothing
+void Gameboard::updateColumnStats(int x)
+{
+    const std::uint32_t mask = columnMasks[x];
+    const int oldHeight = columnHeights[x];
+    const int height = mask ? MAX_Y - countTrailingZeros(mask) : 0;
+    const int holes = height - countSetBits(mask);
+
+    holeCount += holes - columnHoles[x];
+    columnHeights[x] = static_cast<std::uint8_t>(height);
+    columnHoles[x] = static_cast<std::uint8_t>(holes);
+
+    if (height > stackHeight)
+    {
+        stackHeight = height;
+    }
+    else if (height < oldHeight && oldHeight == stackHeight)
+    {
+        // the tallest column got shorter, find the new tallest
+        stackHeight = 0;
+        for (int col = 0; col < MAX_X; col++)
+        {
+            if (columnHeights[col] > stackHeight)
+                stackHeight = columnHeights[col];
+        }
+    }
+}
+
+// the hash of a row: the XOR of the keys of its occupied locations
+// (the keys of each half row are combined in a table, so it's two lookups)
+// - param 1: an int representing the row index (y)
+// - param 2: the row's occupancy mask
+// - return: the row's share of the hash (0 for an empty row)
+std::uint64_t Gameboard::getRowHash(int y, std::uint16_t mask)
+{
+    const ZobristKeys& keys = getZobristKeys();
+    const int halfMask = (1 << HALF_ROW_BITS) - 1;
+    return keys.halfRowKeys[y][0][mask & halfMask] ^ keys.halfRowKeys[y][1][mask >> HALF_ROW_BITS];
+}
+
+// the hash of the whole board, re-derived from the row masks
+//   (getHash() should always equal it)
+// - params: none
+// - return: the occupancy hash
+std::uint64_t Gameboard::computeHash() const
+{
+    std::uint64_t result = 0;
+    for (int y = 0; y < MAX_Y; y++)
+    {
+        result ^= getRowHash(y, rowMasks[y]);
+    }
+    return result;
+}
+
+// bring a row's fill count and the column masks & stats up to date after
+// a whole row's content changed (fillRow(), copyRowIntoRow()).
+// - param 1: an int representing the row index (y)
+// - return: nothing
+void Gameboard::updateRowStats(int y)
+{
+    rowFillCounts[y] = static_cast<std::uint8_t>(countSetBits(rowMasks[y]));
+    for (int x = 0; x < MAX_X; x++)
+    {
+        const std::uint32_t bit = static_cast<std::uint32_t>((rowMasks[y] >> x) & 1) << y;
+        if ((columnMasks[x] & (1u << y)) != bit)
+        {
+            columnMasks[x] ^= (1u << y);
+            updateColumnStats(x);
+        }
+    }
+}
+
 // return a bool indicating if a given row is full (no EMPTY_BLOCK in the row)
+//   (compare the row mask against FULL_ROW_MASK)
 // assert the row index is valid
 // - param 1: an int representing the row index we want to test
 // - return: bool representing if the row is completed
 bool Gameboard::isRowCompleted(int index) const
 {
     assert(index >= 0 && index < MAX_Y);
-    int count = 0;
-    for (int x = 0; x < MAX_X; x++)
-    {
-        if (grid[index][x] != EMPTY_BLOCK)
-            count++;
-    }
-    if (count == MAX_X)
-        return true;
-    return false;
+    return rowMasks[index] == FULL_ROW_MASK;
 }
 
 // fill a given grid row with specified content
@@ -180,10 +616,13 @@ bool Gameboard::isRowCompleted(int index) const
 // - return: nothing
 void Gameboard::fillRow(int index, int value)
 {
-    for (int x = 0; x < MAX_X; x++)
-    {
-        grid[index][x] = value;
-    }
+    assert(value >= INT8_MIN && value <= INT8_MAX && "Content does not fit the grid");
+    std::memset(grid[index], value, sizeof(grid[index]));
+    hash ^= getRowHash(index, rowMasks[index]);
+    rowMasks[index] = (value == EMPTY_BLOCK) ? 0 : FULL_ROW_MASK;
+    hash ^= getRowHash(index, rowMasks[index]);
+    updateRowStats(index);
+    generation++;
 }
 
 // scan the board for completed rows.
@@ -209,10 +648,11 @@ std::vector<int> Gameboard::getCompletedRowIndices() const
 // - return: nothing
 void Gameboard::copyRowIntoRow(int source, int target)
 {
-    for (int x = 0; x < MAX_X; x++)
-    {
-        grid[target][x] = grid[source][x];
-    }
+    std::memcpy(grid[target], grid[source], sizeof(grid[target]));
+    hash ^= getRowHash(target, rowMasks[target]) ^ getRowHash(target, rowMasks[source]);
+    rowMasks[target] = rowMasks[source];
+    updateRowStats(target);
+    generation++;
 }
 
 // In gameplay, when a full row is completed (filled with content)
@@ -22,7 +22,14 @@
 // of color(content) have been copied("locked") onto the board from tetrominos that have
 // already been placed(either intentionally or not).
 //
-// - The game board is represented by a 2D array of integers(the grid).
+// - The game board is represented by a 2D array of small integers(the grid),
+//      plus one occupancy bitmask per row (rowMasks) - bit x of rowMasks[y] is set
+//      when grid[y][x] holds content. Occupancy questions (is a row complete? are
+//      these locations empty?) are answered from the masks alone.
+// - The board also keeps a 64 bit (Zobrist) hash of its occupancy: the XOR of a fixed
+//      random key for every occupied location.  Boards with the same occupied
+//      locations (whatever their colors) have the same hash, so a search can recognise
+//      a board it has already seen (see TranspositionTable).
 // - The array contains content(integers) which represent either :
 //    - an EMPTY_BLOCK(-1),
 //    - a color from the Tetromino::TetColor enum.
@@ -50,28 +57,61 @@
 #ifndef GAMEBOARD_H
 #define GAMEBOARD_H
 
+#include <cstdint>
 #include <vector>
+#include "BlockList.h"
 #include "Point.h"
 
 class Gameboard
 {
     friend class TestSuite;
-	friend int main();
+	friend int main(int argc, char* argv[]);
 
 public:
 	// CONSTANTS
 	static const int MAX_X = 10;		// gameboard x dimension
 	static const int MAX_Y = 19;		// gameboard y dimension
 	static const int EMPTY_BLOCK = -1;	// contents of an empty block
+	static const std::uint16_t FULL_ROW_MASK = (1 << MAX_X) - 1;	// the row mask of a completed row
+
+	// the outcome of removing the completed rows (see compactCompletedRows())
+	struct RowClearResult
+	{
+		int count;				// the number of completed rows removed
+		std::uint32_t rowMask;	// bit y set = row y (before the removal) was completed
+	};
 
 private:
 	// MEMBER VARIABLES -------------------------------------------------
 
-	// the gameboard - a grid of X and Y offsets.  
+	// the gameboard - a grid of X and Y offsets, holding the content (color) of each location.
 	//  ([0][0] is top left, [MAX_Y-1][MAX_X-1] is bottom right) 
-	int grid[MAX_Y][MAX_X];
+	//  Content is stored compactly (as int8_t) so it must fit in -128..127.
+	std::int8_t grid[MAX_Y][MAX_X];
+	// the occupancy of each grid row - bit x is set when grid[y][x] != EMPTY_BLOCK.
+	std::uint16_t rowMasks[MAX_Y];
+
+	// Occupancy statistics, kept up to date by every change to the grid so that
+	// reading them never requires a scan of the grid:
+	// the occupancy of each grid column - bit y is set when grid[y][x] != EMPTY_BLOCK.
+	std::uint32_t columnMasks[MAX_X];
+	// the height of each column (MAX_Y - the row of its highest block, 0 if empty).
+	std::uint8_t columnHeights[MAX_X];
+	// the number of holes (empty locations below the column height) in each column.
+	std::uint8_t columnHoles[MAX_X];
+	// the number of blocks in each row.
+	std::uint8_t rowFillCounts[MAX_Y];
+	// the sum of columnHoles.
+	int holeCount;
+	// the height of the tallest column.
+	int stackHeight;
+	// the Zobrist hash of the occupancy (the XOR of the key of every occupied location).
+	std::uint64_t hash;
 	// the gameboard offset to spawn a new tetromino at.
-	const Point spawnLoc{ MAX_X / 2, 0 };
+	//  (not const, so boards can be assigned: a Gameboard is trivially copyable)
+	Point spawnLoc{ MAX_X / 2, 0 };
+	// bumped every time the grid content changes (lets a renderer cache the board).
+	unsigned int generation{ 0 };
 	
 public:	
 	// METHODS -------------------------------------------------
@@ -80,7 +120,7 @@ public:
 	Gameboard();
 
 	// fill the board with EMPTY_BLOCK 
-	//   (iterate through each rowIndex and fillRow() with EMPTY_BLOCK))
+	//   (memset the grid to EMPTY_BLOCK and every row mask to 0)
 	// - params: none
 	// - return: nothing
 	void empty();
@@ -122,6 +162,11 @@ public:
 	// - param 2: an int representing the content we want to set.
 	void setContent(const std::vector<Point>& points, int value);		
 
+	// set the content for a (fixed size) list of points (ignore invalid points)
+	// - param 1: a BlockList of Points representing locations
+	// - param 2: an int representing the content we want to set.
+	void setContent(const BlockList& points, int value);
+
 	// Determine if (valid) all points passed in are empty
 	// *** IMPORTANT: Assume invalid x,y values can be passed to this method.
 	// Invalid meaning outside the bounds of the grid.
@@ -131,16 +176,138 @@ public:
 	// - return: true if the content at ALL VALID points is EMPTY_BLOCK, false otherwise
 	bool areAllLocsEmpty(const std::vector<Point>& points) const;
 
+	// Same as above, for a (fixed size) list of points (doesn't allocate)
+	// - param 1: a BlockList of Points representing locations to test
+	// - return: true if the content at ALL VALID points is EMPTY_BLOCK, false otherwise
+	bool areAllLocsEmpty(const BlockList& points) const;
+
+	// Determine if a given XY is occupied (holds content other than EMPTY_BLOCK)
+	// Invalid x,y values are not occupied.
+	// - param 1: an int for X (column)
+	// - param 2: an int for Y (row)
+	// - return: true if the (valid) x,y holds content, false otherwise
+	bool isOccupied(int x, int y) const;
+
+	// get the occupancy bitmask of a row (bit x set = column x holds content)
+	// assert the row index is valid
+	// - param 1: an int representing the row index
+	// - return: the row's occupancy mask (FULL_ROW_MASK if the row is completed)
+	std::uint16_t getRowMask(int index) const;
+
 	// Remove all completed rows from the board
-	//   use getCompletedRowIndices() and removeRows() 
+	//   use compactCompletedRows()
 	// - params: none
 	// - return: the count of completed rows removed
 	int removeCompletedRows();
 
+	// Remove all completed rows from the board in a single bottom-up pass:
+	//   walk the rows from the bottom up, skip completed rows and write every
+	//   other row straight into its final position, then fill the rows left
+	//   over at the top with EMPTY_BLOCK.
+	//   (each row is copied at most once, whatever the number of completed rows)
+	// - params: none
+	// - return: a RowClearResult, the count & mask of the completed rows removed
+	RowClearResult compactCompletedRows();
+
+	// Put back the rows removed by compactCompletedRows() (eg: to undo a placement):
+	//   walk the rows from the top down, writing each removed row back at its
+	//   index and every other row back up where it came from (the inverse of the
+	//   compaction, each row is copied at most once).
+	// - param 1: the RowClearResult compactCompletedRows() returned
+	// - param 2: the contents of the removed rows, top row first (result.count of them)
+	// - return: nothing
+	void restoreCompletedRows(const RowClearResult& result, const std::int8_t removedRows[][MAX_X]);
+
+	// put back a snapshot of a board (a copy of this or any other board)
+	//   Like assignment, but counted as a change of this board: the generation
+	//   moves on from this board's own (an assignment would copy the snapshot's,
+	//   which a cache of this board may have seen with other content).
+	// - param 1: the snapshot
+	// - return: nothing
+	void restore(const Gameboard& snapshot);
+
 	// A getter for the spawn location
 	// - params: none
 	// - returns: a Point, representing our private spawnLoc
-	Point getSpawnLoc();
+	Point getSpawnLoc() const;
+
+	// A getter for the content generation. Every change to the grid content
+	// (setContent, row removal, empty...) bumps it, so anything derived from
+	// the grid only needs to be rebuilt when the generation it was built from
+	// no longer matches.  A constructed board is never at generation 0.
+	// - params: none
+	// - returns: an unsigned int, the current generation
+	unsigned int getGeneration() const;
+
+	// A getter for the occupancy hash: the XOR of a fixed random 64 bit key for
+	// each occupied location (0 for an empty board).  Kept up to date by every
+	// change to the grid: setContent() flips the location's key when its
+	// occupancy changes, and removing rows re-derives the hash of the rows that
+	// moved from their row masks (two table lookups per row).
+	// - params: none
+	// - returns: a 64 bit hash, equal for boards with the same occupied locations
+	std::uint64_t getHash() const;
+
+	// the hash the board would have with a set of (empty) locations occupied, eg:
+	// once a tetromino is locked at its mapped block locs (before any completed rows
+	// are removed).  Lets a search look a board up without building it.
+	// Invalid and occupied points are ignored.
+	// - param 1: a BlockList of Points representing locations
+	// - returns: a 64 bit hash
+	std::uint64_t getHashWith(const BlockList& points) const;
+
+	// Occupancy statistics (all maintained incrementally, so each is O(1)) -----
+
+	// get the height of a column: MAX_Y - the row index of its highest block
+	// (0 for an empty column, MAX_Y for a column filled to the top row)
+	// assert the column index is valid
+	// - param 1: an int representing the column index (x)
+	// - return: an int, the column height
+	int getColumnHeight(int x) const;
+
+	// get the number of holes in a column: empty locations below its highest block
+	// assert the column index is valid
+	// - param 1: an int representing the column index (x)
+	// - return: an int, the number of holes in the column
+	int getColumnHoleCount(int x) const;
+
+	// get the occupancy bitmask of a column (bit y set = row y holds content)
+	// assert the column index is valid
+	// - param 1: an int representing the column index (x)
+	// - return: the column's occupancy mask
+	std::uint32_t getColumnMask(int x) const;
+
+	// get the number of blocks in a row
+	// assert the row index is valid
+	// - param 1: an int representing the row index (y)
+	// - return: an int, the number of blocks in the row (MAX_X if completed)
+	int getRowFillCount(int y) const;
+
+	// get the total number of holes on the board (the sum of every column's holes)
+	// - params: none
+	// - return: an int, the number of holes
+	int getHoleCount() const;
+
+	// get the height of the tallest column
+	// - params: none
+	// - return: an int, 0 for an empty board
+	int getStackHeight() const;
+
+	// get the row index of the highest block on the board
+	// - params: none
+	// - return: an int, the highest occupied row (MAX_Y for an empty board)
+	int getHighestOccupiedRow() const;
+
+	// Determine how far a set of locations (eg: a tetromino's mapped block locs)
+	// can move straight down before one of them would hit content or go below
+	// the bottom of the grid.  Computed directly from the column masks: find the
+	// first occupied row under each location; the smallest gap wins (so only the
+	// lowest location in each column matters).  Rows above the grid are empty.
+	// Assumes the locations themselves are legal (within the left, right and
+	// bottom borders and not occupied).
+	// - param 1: a BlockList of Points representing locations
+	// - return: an int, the number of rows the locations can drop (0 or more)
+	int getDropDistance(const BlockList& points) const;
 
 private:  // This is commented out to allow us to test. 
 
@@ -155,7 +322,33 @@ private:  // This is commented out to allow us to test.
 	// - return: true if the x,y is a valid grid location, false otherwise
 	bool isValidPoint(int x, int y) const;
 
+	// bring a column's height & hole count (and the board's hole count & stack
+	// height) up to date after its column mask changed.  O(1) via bit counting.
+	// - param 1: an int representing the column index (x)
+	// - return: nothing
+	void updateColumnStats(int x);
+
+	// the hash of a row: the XOR of the keys of its occupied locations
+	// (the keys of each half row are combined in a table, so it's two lookups)
+	// - param 1: an int representing the row index (y)
+	// - param 2: the row's occupancy mask
+	// - return: the row's share of the hash (0 for an empty row)
+	static std::uint64_t getRowHash(int y, std::uint16_t mask);
+
+	// the hash of the whole board, re-derived from the row masks
+	//   (getHash() should always equal it)
+	// - params: none
+	// - return: the occupancy hash
+	std::uint64_t computeHash() const;
+
+	// bring a row's fill count and the column masks & stats up to date after
+	// a whole row's content changed (fillRow(), copyRowIntoRow()).
+	// - param 1: an int representing the row index (y)
+	// - return: nothing
+	void updateRowStats(int y);
+
 	// return a bool indicating if a given row is full (no EMPTY_BLOCK in the row)
+	//   (compare the row mask against FULL_ROW_MASK)
 	// assert the row index is valid
 	// - param 1: an int representing the row index we want to test
 	// - return: bool representing if the row is completed
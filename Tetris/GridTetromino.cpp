@@ -3,7 +3,7 @@
 // a getter for the tetromino's location
 // - params: none
 // - return: a Point (the private member variable gridLoc) 
-Point GridTetromino::getGridLoc() { return Point(-1, -1); }
+Point GridTetromino::getGridLoc() const { return gridLoc; }
 
 // a setter for the tetronimo's location 
 // - param 1: int x
@@ -45,4 +45,17 @@ std::vector<Point> GridTetromino::getBlockLocsMappedToGrid() const {
 		points.push_back(Point(p.getX() + gridLoc.getX(), p.getY() + gridLoc.getY()));
 	}
 	return points;
+}
+
+// Same as getBlockLocsMappedToGrid(), but the mapped Points are returned
+// in a (fixed size) BlockList, so nothing is allocated.  Use this one on
+// hot paths (legality checks, drops, drawing).
+// params: none:
+// return: a BlockList of the mapped Points.
+BlockList GridTetromino::getMappedBlockLocs() const {
+	BlockList points;
+	for (const Point& p : blockLocs) {
+		points.push_back(Point(p.getX() + gridLoc.getX(), p.getY() + gridLoc.getY()));
+	}
+	return points;
 }
\ No newline at end of file
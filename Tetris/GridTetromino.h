@@ -3,6 +3,7 @@
 //  - The concept of the tetromino's location on the gameboard/grid. (gridLoc)
 //  - The ability to change a tetromino's location
 //  - The ability to retrieve a vector of tetromino block locations mapped to the gridLoc.
+//    (or a BlockList of them, which doesn't allocate)
 //
 //  [expected .cpp size: ~ 40 lines]
 
@@ -32,7 +33,7 @@ public:
 	// a getter for the tetromino's location
 	// - params: none
 	// - return: a Point (the private member variable gridLoc) 
-	Point getGridLoc();
+	Point getGridLoc() const;
 
 	// a setter for the tetronimo's location 
 	// - param 1: int x
@@ -63,6 +64,13 @@ public:
 	// return: a vector of Point objects.
 	std::vector<Point> getBlockLocsMappedToGrid() const;
 
+	// Same as getBlockLocsMappedToGrid(), but the mapped Points are returned
+	// in a (fixed size) BlockList, so nothing is allocated.  Use this one on
+	// hot paths (legality checks, drops, drawing).
+	// params: none:
+	// return: a BlockList of the mapped Points.
+	BlockList getMappedBlockLocs() const;
+
 };
 
 #endif /* GRIDTETROMINO_H */
\ No newline at end of file
@@ -4,16 +4,229 @@
 #include <iostream>
 #include "TetrisGame.h"
 #include "TestSuite.h"
+#include "AIPlayer.h"
+#include "BatchSimulator.h"
+#include "CorpusAnalyzer.h"
+#include "Perft.h"
+#include "Random.h"
+#include "Replay.h"
+#include "ReplayCorpus.h"
+#include "ReplayVerifier.h"
+#include "RolloutEvaluator.h"
+#include "TetrisEnv.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
 
 
-int main()
+// Tetris [--batch [games] [first seed] [threads] [random|ai]] | [--perft [depth] [threads]]
+//        | [--rollouts [rollouts] [depth] [threads]] | [--env [games] [steps] [threads]]
+//        | [--replay [file]] | [--corpus-add corpus replay...] | [--corpus corpus [threads]]
+//        | [--verify corpus [threads]]
+//   --batch plays games headless with a bot (random by default) and prints the results
+//   (the ai bot searches without a time limit, & games stop after 10000 placements),
+//   --perft counts the placement tree of an empty board (shapes I O T S Z L J),
+//   --rollouts rolls out every opening placement of each shape (on an empty board),
+//   --env plays random placements through the TetrisEnv C API & prints the steps per second,
+//   --replay plays a replay back headless (last_game.replay, the last game played, by default)
+//   & checks it ends like it was recorded,
+//   --corpus-add appends replay files to a corpus (created if it doesn't exist),
+//   --corpus summarizes a corpus from its index, then plays every replay back for statistics,
+//   --verify checks every replay of a corpus plays back like it was recorded (eg: after
+//   changing the engine) & reports where the ones that don't diverge,
+//   instead of opening the game window.
+int main(int argc, char* argv[])
 {	
-	// seed random
-	srand(static_cast <unsigned int> (time(0)));
+	// seed random (the game's pieces come from its own generator, seeded with the same value)
+	const std::uint64_t seed = static_cast<std::uint64_t>(time(0));
+	srand(static_cast <unsigned int> (seed));
 
 	// run some sanity tests on our classes to ensure they're working as expected.
 	TestSuite::runTestSuite();
 
+	if (argc > 1 && std::strcmp(argv[1], "--batch") == 0)
+	{
+		const int games = (argc > 2) ? std::atoi(argv[2]) : 1000;
+		const std::uint64_t firstSeed = (argc > 3) ? std::strtoull(argv[3], nullptr, 10) : seed;
+		const int threads = (argc > 4) ? std::atoi(argv[4]) : 0;
+		const bool ai = (argc > 5) && std::strcmp(argv[5], "ai") == 0;
+
+		// the games are spread over the threads: each bot searches on its game's thread
+		GamePolicy::Factory makePolicy = [] { return std::unique_ptr<GamePolicy>(new RandomPolicy()); };
+		if (ai)
+			makePolicy = [] { return std::unique_ptr<GamePolicy>(new AIPlayer(1, AIPlayer::DEFAULT_BEAM_WIDTH, std::chrono::microseconds(0))); };
+		BatchSimulator simulator(makePolicy, threads, RandomizerPolicy::UNIFORM, ai ? 10000 : 0);
+		simulator.run(firstSeed, games).printToConsole();
+		return 0;
+	}
+
+	if (argc > 1 && std::strcmp(argv[1], "--perft") == 0)
+	{
+		const int depth = (argc > 2) ? std::atoi(argv[2]) : 4;
+		const int threads = (argc > 3) ? std::atoi(argv[3]) : 0;
+
+		Gameboard board;
+		board.empty();
+		Perft perft(threads);
+		perft.run(board, { TetShape::I, TetShape::O, TetShape::T, TetShape::S, TetShape::Z, TetShape::L, TetShape::J }, depth).printToConsole();
+		return 0;
+	}
+
+	if (argc > 1 && std::strcmp(argv[1], "--rollouts") == 0)
+	{
+		RolloutSettings settings;
+		settings.rollouts = (argc > 2) ? std::atoi(argv[2]) : 1000;
+		settings.depth = (argc > 3) ? std::atoi(argv[3]) : 20;
+		settings.seed = seed;
+		const int threads = (argc > 4) ? std::atoi(argv[4]) : 0;
+
+		// the best opening placement of each shape: most rows, then most survivals
+		Gameboard board;
+		board.empty();
+		MoveGenerator generator;
+		RolloutEvaluator evaluator(threads);
+		for (int s = 0; s < Tetromino::SHAPE_COUNT; s++)
+		{
+			GridTetromino shape;
+			shape.setShape(static_cast<TetShape>(s));
+			shape.setGridLoc(board.getSpawnLoc());
+			generator.generate(board, shape);
+			const RolloutReport report = evaluator.evaluate(board, generator.getPlacements(), nullptr, settings);
+
+			std::size_t best = 0;
+			for (std::size_t c = 1; c < report.results.size(); c++)
+			{
+				const RolloutResult& r = report.results[c];
+				if (r.meanLines > report.results[best].meanLines ||
+					(r.meanLines == report.results[best].meanLines && r.survivalRate > report.results[best].survivalRate))
+					best = c;
+			}
+			const MoveGenerator::Placement& placement = generator.getPlacements()[best];
+			std::cout << "shape " << s << ": best of " << report.results.size() << " placements is rotation " << placement.rotation
+				<< " at [" << placement.x << "," << placement.y << "]: " << report.results[best].meanLines << " rows, "
+				<< report.results[best].survivalRate * 100 << "% survive (" << report.stepsPerSecondPerThread << " steps/s per thread)\n";
+		}
+		return 0;
+	}
+
+	if (argc > 1 && std::strcmp(argv[1], "--env") == 0)
+	{
+		const int games = (argc > 2) ? std::atoi(argv[2]) : 4096;
+		const int steps = (argc > 3) ? std::atoi(argv[3]) : 1000;
+		const int threads = (argc > 4) ? std::atoi(argv[4]) : 0;
+
+		TetrisEnv* env = tetrisEnvCreate(games, static_cast<int>(RandomizerPolicy::SEVEN_BAG), threads);
+		if (!env)
+			return 1;
+		std::vector<std::uint8_t> board(games * TETRIS_ENV_ROWS * TETRIS_ENV_COLUMNS), shapes(games * 2), heights(games * TETRIS_ENV_COLUMNS);
+		std::vector<std::uint8_t> masks(games * TETRIS_ENV_ACTIONS), dones(games);
+		std::vector<float> rewards(games);
+		std::vector<std::int32_t> actions(games);
+		std::vector<std::uint64_t> seeds(games);
+		for (int i = 0; i < games; i++)
+		{
+			seeds[i] = seed + i;
+		}
+		const TetrisEnvBuffers buffers{ board.data(), shapes.data(), heights.data(), masks.data(), rewards.data(), dones.data() };
+		tetrisEnvSetBuffers(env, &buffers);
+		tetrisEnvReset(env, seeds.data(), nullptr);
+
+		// a random legal placement in every game (the games that end start over)
+		Random random(seed);
+		double stepSeconds = 0;
+		for (int step = 0; step < steps; step++)
+		{
+			for (int i = 0; i < games; i++)
+			{
+				int action = random.nextInt(TETRIS_ENV_ACTIONS);
+				while (!dones[i] && !masks[i * TETRIS_ENV_ACTIONS + action])
+				{
+					action = (action + 1) % TETRIS_ENV_ACTIONS;
+				}
+				actions[i] = action;
+			}
+			const auto start = std::chrono::steady_clock::now();
+			tetrisEnvStep(env, actions.data());
+			stepSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			tetrisEnvReset(env, seeds.data(), dones.data());
+		}
+		std::cout << games << " games, " << steps << " steps: " << static_cast<double>(games) * steps / stepSeconds << " steps/s\n";
+		tetrisEnvDestroy(env);
+		return 0;
+	}
+
+	if (argc > 1 && std::strcmp(argv[1], "--replay") == 0)
+	{
+		Replay replay;
+		if (!replay.load((argc > 2) ? argv[2] : "last_game.replay"))
+		{
+			std::cout << "not a replay\n";
+			return 1;
+		}
+		const auto start = std::chrono::steady_clock::now();
+		TetrisEngine engine;
+		ReplayDivergence divergence;
+		const bool identical = replay.verify(engine, divergence);
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		const ReplayResult result = ReplayResult::of(engine);
+		std::cout << replay.getInputs().size() << " inputs, " << result.frames << " frames: score " << result.score << ", "
+			<< result.linesCleared << " rows, " << result.placementCount << " placements, replayed in " << seconds * 1000 << " ms (";
+		if (identical)
+			std::cout << "as recorded)\n";
+		else
+			std::cout << "DIFFERENT from the recording from frame " << divergence.frame << ")\n";
+		return identical ? 0 : 1;
+	}
+
+	if (argc > 2 && std::strcmp(argv[1], "--corpus-add") == 0)
+	{
+		ReplayCorpusWriter writer;
+		if (!writer.open(argv[2]))
+		{
+			std::cout << "not a corpus\n";
+			return 1;
+		}
+		Replay replay;
+		for (int i = 3; i < argc; i++)
+		{
+			if (!replay.load(argv[i]) || !writer.add(replay))
+				std::cout << argv[i] << ": not added\n";
+		}
+		std::cout << writer.getReplayCount() << " replays in " << argv[2] << "\n";
+		return writer.close() ? 0 : 1;
+	}
+
+	if (argc > 2 && std::strcmp(argv[1], "--corpus") == 0)
+	{
+		const int threads = (argc > 3) ? std::atoi(argv[3]) : 0;
+		ReplayCorpus corpus;
+		if (!corpus.open(argv[2]))
+		{
+			std::cout << "not a corpus\n";
+			return 1;
+		}
+		CorpusAnalyzer analyzer(threads);
+		analyzer.summarize(corpus).printToConsole();
+		analyzer.analyze(corpus).printToConsole();
+		return 0;
+	}
+
+	if (argc > 2 && std::strcmp(argv[1], "--verify") == 0)
+	{
+		const int threads = (argc > 3) ? std::atoi(argv[3]) : 0;
+		ReplayCorpus corpus;
+		if (!corpus.open(argv[2]))
+		{
+			std::cout << "not a corpus\n";
+			return 1;
+		}
+		ReplayVerifier verifier(threads);
+		const VerificationReport report = verifier.verify(corpus);
+		report.printToConsole();
+		return report.isIdentical() ? 0 : 1;
+	}
+
 	sf::Sprite blockSprite;			// the tetromino block sprite
 	sf::Texture blockTexture;		// the tetromino block texture
 	sf::Sprite backgroundSprite;	// the background sprite
@@ -34,8 +247,16 @@ int main()
 	const Point gameboardOffset{ 54, 125 };		// the pixel offset of the top left of the gameboard 
 	const Point nextShapeOffset{ 490, 210 };	// the pixel offset of the next shape Tetromino
 
+	// the bot that plays when A is pressed (searching on every hardware thread),
+	// declared before the game so it outlives it
+	AIPlayer aiPlayer(0);
+
 	// set up a tetris game
-	TetrisGame game(window, blockSprite, gameboardOffset, nextShapeOffset);
+	TetrisGame game(window, blockSprite, gameboardOffset, nextShapeOffset, seed);
+	game.setAutoPlayer(&aiPlayer);
+
+	// every finished game can be played back with --replay
+	game.setReplayPath("last_game.replay");
 
 	// set up a clock so we can determine seconds per game loop
 	sf::Clock clock;		
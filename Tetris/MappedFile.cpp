@@ -0,0 +1,110 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// destructor, unmap the file
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+// map a file (unmapping the one mapped before)
+// - param 1: the file's path
+// - return: bool, false if the file couldn't be opened or mapped (or is empty)
+bool MappedFile::open(const std::string& path)
+{
+	close();
+#ifdef _WIN32
+	file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		file = nullptr;
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0 ||
+		static_cast<std::uint64_t>(fileSize.QuadPart) > static_cast<std::uint64_t>(SIZE_MAX))
+	{
+		close();
+		return false;
+	}
+	mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr)
+	{
+		close();
+		return false;
+	}
+	data = static_cast<const std::uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (data == nullptr)
+	{
+		close();
+		return false;
+	}
+	size = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+	const int descriptor = ::open(path.c_str(), O_RDONLY);
+	if (descriptor < 0)
+		return false;
+	struct stat status;
+	if (fstat(descriptor, &status) != 0 || status.st_size <= 0)
+	{
+		::close(descriptor);
+		return false;
+	}
+	void* mapped = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+	::close(descriptor);	// the mapping keeps the file open
+	if (mapped == MAP_FAILED)
+		return false;
+	data = static_cast<const std::uint8_t*>(mapped);
+	size = static_cast<std::size_t>(status.st_size);
+#endif
+	return true;
+}
+
+// unmap the file (nothing if none is mapped)
+// - params: none
+// - return: nothing
+void MappedFile::close()
+{
+#ifdef _WIN32
+	if (data != nullptr)
+		UnmapViewOfFile(data);
+	if (mapping != nullptr)
+		CloseHandle(mapping);
+	if (file != nullptr)
+		CloseHandle(file);
+	mapping = nullptr;
+	file = nullptr;
+#else
+	if (data != nullptr)
+		munmap(const_cast<std::uint8_t*>(data), size);
+#endif
+	data = nullptr;
+	size = 0;
+}
+
+// Getters ======================================================
+
+bool MappedFile::isOpen() const
+{
+	return data != nullptr;
+}
+
+const std::uint8_t* MappedFile::getData() const
+{
+	return data;
+}
+
+std::size_t MappedFile::getSize() const
+{
+	return size;
+}
@@ -0,0 +1,52 @@
+// The MappedFile class maps a file into memory, read only, so its bytes can be read in
+// place: no reads into buffers, and the pages are shared by every thread & cached by the
+// operating system.  (CreateFileMapping()/MapViewOfFile() on Windows, mmap() elsewhere.)
+//
+// A MappedFile owns its mapping: it can't be copied, and the mapping ends when it is
+// closed or destroyed (any pointer into it is then invalid).
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class MappedFile
+{
+private:
+	// MEMBER VARIABLES
+	const std::uint8_t* data{ nullptr };	// the first byte (nullptr if no file is mapped)
+	std::size_t size{ 0 };
+#ifdef _WIN32
+	void* file{ nullptr };					// the file's HANDLE
+	void* mapping{ nullptr };				// the file mapping's HANDLE
+#endif
+
+public:
+	MappedFile() = default;
+
+	// destructor, unmap the file
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// map a file (unmapping the one mapped before)
+	// - param 1: the file's path
+	// - return: bool, false if the file couldn't be opened or mapped (or is empty)
+	bool open(const std::string& path);
+
+	// unmap the file (nothing if none is mapped)
+	// - params: none
+	// - return: nothing
+	void close();
+
+	// Getters ======================================================
+
+	bool isOpen() const;
+	const std::uint8_t* getData() const;	// the file's first byte
+	std::size_t getSize() const;			// in bytes
+};
+
+#endif /* MAPPEDFILE_H */
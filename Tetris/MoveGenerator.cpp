@@ -0,0 +1,227 @@
+#include "MoveGenerator.h"
+#include <algorithm>
+#include <cassert>
+#include "Bits.h"
+
+// constructor, pack every shape rotation into row masks
+MoveGenerator::MoveGenerator() : shape{ TetShape::O }
+{
+	for (int s = 0; s < Tetromino::SHAPE_COUNT; s++)
+	{
+		for (int rotation = 0; rotation < Tetromino::ROTATION_COUNT; rotation++)
+		{
+			const BlockOffset* offsets = Tetromino::getRotationOffsets(static_cast<TetShape>(s), rotation);
+			ShapeMask& mask = shapeMasks[s][rotation];
+			mask.minX = mask.maxX = offsets[0].x;
+			mask.minY = offsets[0].y;
+			int maxY = offsets[0].y;
+			for (int block = 1; block < Tetromino::BLOCK_COUNT; block++)
+			{
+				mask.minX = std::min(mask.minX, offsets[block].x);
+				mask.maxX = std::max(mask.maxX, offsets[block].x);
+				mask.minY = std::min(mask.minY, offsets[block].y);
+				maxY = std::max(maxY, offsets[block].y);
+			}
+			mask.rowCount = maxY - mask.minY + 1;
+
+			for (std::uint16_t& row : mask.rows)
+			{
+				row = 0;
+			}
+			for (int block = 0; block < Tetromino::BLOCK_COUNT; block++)
+			{
+				mask.rows[offsets[block].y - mask.minY] |= static_cast<std::uint16_t>(1 << (offsets[block].x - mask.minX));
+			}
+		}
+	}
+	std::fill(std::begin(visited), std::end(visited), 0u);
+	std::fill(std::begin(landed), std::end(landed), 0u);
+}
+
+// find every placement of a shape on a board
+// - param 1: the board
+// - param 2: the shape, at the location & rotation the search starts from
+//            (eg: TetrisEngine::getCurrentShape())
+// - return: int, the number of placements found (0 if the start isn't legal)
+int MoveGenerator::generate(const Gameboard& board, const GridTetromino& start)
+{
+	placements.clear();
+	placementCells.clear();
+	stackTop = Gameboard::MAX_Y;
+	for (int y = Gameboard::MAX_Y - 1; y >= 0; y--)
+	{
+		boardRows[y] = board.getRowMask(y);
+		if (boardRows[y])
+			stackTop = y;
+	}
+	for (int x = 0; x < Gameboard::MAX_X; x++)
+	{
+		boardColumns[x] = board.getColumnMask(x);
+	}
+	shape = start.getShape();
+
+	// a new stamp "clears" every state (the array is only really cleared when the stamp wraps)
+	if (++search == 0)
+	{
+		std::fill(std::begin(visited), std::end(visited), 0u);
+		std::fill(std::begin(landed), std::end(landed), 0u);
+		search = 1;
+	}
+
+	int queueEnd = 0;
+	if (!visit(start.getGridLoc().getX(), start.getGridLoc().getY(), start.getRotation(), -1, GameAction::NONE, queueEnd))
+		return 0;
+
+	const bool canRotate = (shape != TetShape::O);
+	for (int queueStart = 0; queueStart < queueEnd; queueStart++)
+	{
+		const int state = queue[queueStart];
+		const int rotation = state / (STATE_WIDTH * STATE_HEIGHT);
+		const int y = (state / STATE_WIDTH) % STATE_HEIGHT - STATE_OFFSET;
+		const int x = state % STATE_WIDTH - STATE_OFFSET;
+
+		// a hard drop from here: the landing spot is a placement (unless one covering
+		// the same cells was already found, with a path at least as short)
+		const int landingY = y + getDropDistance(x, y, rotation);
+		const int landingState = getStateIndex(x, landingY, rotation);
+		if (landed[landingState] != search)
+		{
+			landed[landingState] = search;
+			const std::uint64_t cells = getCellsKey(x, landingY, rotation);
+			if (std::find(placementCells.begin(), placementCells.end(), cells) == placementCells.end())
+			{
+				placementCells.push_back(cells);
+				placements.push_back(Placement{ shape, rotation, x, landingY, depth[state] + 1, state });
+			}
+		}
+
+		visit(x - 1, y, rotation, state, GameAction::MOVE_LEFT, queueEnd);
+		visit(x + 1, y, rotation, state, GameAction::MOVE_RIGHT, queueEnd);
+		if (canRotate)
+			visit(x, y, (rotation + 1) % Tetromino::ROTATION_COUNT, state, GameAction::ROTATE, queueEnd);
+
+		// high above the stack (where no rotation of the shape, even one row lower, can
+		// touch a block) the rows a soft drop passes have nothing new to offer: their moves,
+		// rotations & hard drops are reached just as fast by making them first, in this row.
+		// So the soft drops go straight down to the first row within reach of the stack.
+		const int dropY = std::max(y + 1, stackTop - STATE_OFFSET - 1);
+		visit(x, dropY, rotation, state, GameAction::SOFT_DROP, queueEnd, dropY - y);
+	}
+	return static_cast<int>(placements.size());
+}
+
+// the placements found by the last generate() (valid until the next generate())
+const std::vector<MoveGenerator::Placement>& MoveGenerator::getPlacements() const
+{
+	return placements;
+}
+
+// the actions that take the searched shape from its start to a placement
+//   (ending with the HARD_DROP that locks it)
+// - param 1: one of the placements of the last generate()
+// - param 2: the path (replaced)
+// - return: nothing
+void MoveGenerator::getPath(const Placement& placement, std::vector<GameAction>& path) const
+{
+	path.resize(placement.pathLength);
+	int i = placement.pathLength - 1;
+	path[i] = GameAction::HARD_DROP;
+	for (int state = placement.fromState; parent[state] >= 0; state = parent[state])
+	{
+		// (a state's action is repeated for every action it adds to the path: see visit())
+		for (int repeat = depth[state] - depth[parent[state]]; repeat > 0; repeat--)
+		{
+			path[--i] = static_cast<GameAction>(parentAction[state]);
+		}
+	}
+	assert(i == 0);
+}
+
+// a placement as a GridTetromino (eg: to get its mapped block locs)
+// - param 1: a Placement
+// - return: a GridTetromino at the placement
+GridTetromino MoveGenerator::toGridTetromino(const Placement& placement)
+{
+	GridTetromino shape;
+	shape.setShape(placement.shape);
+	shape.setRotation(placement.rotation);
+	shape.setGridLoc(placement.x, placement.y);
+	return shape;
+}
+
+// the index of a state
+int MoveGenerator::getStateIndex(int x, int y, int rotation)
+{
+	return (rotation * STATE_HEIGHT + (y + STATE_OFFSET)) * STATE_WIDTH + (x + STATE_OFFSET);
+}
+
+// true if the searched shape fits on the board at (x, y) with a rotation
+// (every block within the left, right & bottom borders, on an empty cell)
+bool MoveGenerator::isLegal(int x, int y, int rotation) const
+{
+	const ShapeMask& mask = shapeMasks[static_cast<int>(shape)][rotation];
+	const int left = x + mask.minX;
+	const int top = y + mask.minY;
+	if (left < 0 || x + mask.maxX >= Gameboard::MAX_X || top + mask.rowCount > Gameboard::MAX_Y)
+		return false;
+	for (int row = 0; row < mask.rowCount; row++)
+	{
+		if (top + row >= 0 && (boardRows[top + row] & (mask.rows[row] << left)))
+			return false;
+	}
+	return true;
+}
+
+// the number of rows the searched shape can fall from (x, y) with a rotation
+//   (like Gameboard::getDropDistance(): the nearest content below each block, from the column masks)
+int MoveGenerator::getDropDistance(int x, int y, int rotation) const
+{
+	const BlockOffset* offsets = Tetromino::getRotationOffsets(shape, rotation);
+	int distance = Gameboard::MAX_Y;
+	for (int block = 0; block < Tetromino::BLOCK_COUNT; block++)
+	{
+		const int bx = x + offsets[block].x;
+		const int by = y + offsets[block].y;
+		const int firstRowBelow = (by + 1 > 0) ? by + 1 : 0;
+		const std::uint32_t below = boardColumns[bx] >> firstRowBelow;
+		const int landingRow = below ? firstRowBelow + countTrailingZeros(below) : Gameboard::MAX_Y;
+		distance = std::min(distance, landingRow - by - 1);
+	}
+	return distance;
+}
+
+// reach a state (if it's legal & not reached yet), & queue it
+//   (every state is tested once per search: an illegal state is marked visited too)
+//   the action can be made several times (soft drops down several rows), the state's
+//   depth then counts every one of them
+// - return: bool, true if the state was queued
+bool MoveGenerator::visit(int x, int y, int rotation, int from, GameAction action, int& queueEnd, int repeat)
+{
+	if (x + STATE_OFFSET < 0 || x + STATE_OFFSET >= STATE_WIDTH || y + STATE_OFFSET < 0 || y + STATE_OFFSET >= STATE_HEIGHT)
+		return false;
+	const int state = getStateIndex(x, y, rotation);
+	if (visited[state] == search)
+		return false;
+	visited[state] = search;
+	if (!isLegal(x, y, rotation))
+		return false;
+
+	parent[state] = static_cast<std::int16_t>(from);
+	parentAction[state] = static_cast<std::uint8_t>(action);
+	depth[state] = static_cast<std::uint16_t>(from < 0 ? 0 : depth[from] + repeat);
+	queue[queueEnd++] = static_cast<std::int16_t>(state);
+	return true;
+}
+
+// the cells a shape rotation covers at (x, y), packed in 64 bits (equal cells, equal keys)
+//   bits 0-5: the top row (+ STATE_OFFSET), then 10 bits per row of the shape
+std::uint64_t MoveGenerator::getCellsKey(int x, int y, int rotation) const
+{
+	const ShapeMask& mask = shapeMasks[static_cast<int>(shape)][rotation];
+	std::uint64_t key = static_cast<std::uint64_t>(y + mask.minY + STATE_OFFSET);
+	for (int row = 0; row < mask.rowCount; row++)
+	{
+		key |= static_cast<std::uint64_t>(mask.rows[row] << (x + mask.minX)) << (6 + row * Gameboard::MAX_X);
+	}
+	return key;
+}
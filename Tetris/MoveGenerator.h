@@ -0,0 +1,129 @@
+// The MoveGenerator class finds every place the current shape can come to rest
+// (every "placement"), and the inputs that take the shape there.
+//
+// It searches (breadth first) over the shape's states (x, y, rotation), from the
+// shape's current state, with the same moves a player has: move left, move right,
+// rotate (clockwise) and soft drop.  From every state reached, a hard drop gives a
+// placement.  So placements that need a slide or a rotation under an overhang are
+// found too.  Placements that cover the same cells (eg: an O, or an I/S/Z rotated
+// twice) are only reported once, with the shortest path that reaches them.
+// High above the stack the search only moves sideways & rotates in the start row,
+// then soft drops straight down to the first row within reach of the stack, in one
+// step (the rows between can't lead anywhere new).
+//
+// Collisions are tested against a copy of the board's row masks, with each shape
+// rotation's blocks pre-packed into row masks (one AND per row of the shape), and
+// hard drops are measured on the board's column masks (like Gameboard::getDropDistance()).
+// A MoveGenerator owns all its buffers, so generate() doesn't allocate (once the
+// placement list has grown) and each thread should own its own generator.
+//
+// The paths assume no gravity tick happens while they are played; apply a path's
+// actions in a single frame (eg: queue them all for the same frame).
+
+#ifndef MOVEGENERATOR_H
+#define MOVEGENERATOR_H
+
+#include <cstdint>
+#include <vector>
+#include "Gameboard.h"
+#include "GridTetromino.h"
+#include "TetrisEngine.h"
+
+class MoveGenerator
+{
+public:
+	// a final resting position of the shape
+	struct Placement
+	{
+		TetShape shape;
+		int rotation;
+		int x;				// the grid location of the shape
+		int y;
+		int pathLength;		// the number of actions in the path (see getPath())
+		int fromState;		// the searched state the path hard drops from
+	};
+
+private:
+	// CONSTANTS
+	static const int STATE_OFFSET{ 2 };							// the furthest a block is from its shape's grid location
+	static const int STATE_WIDTH{ Gameboard::MAX_X + 2 * STATE_OFFSET };	// the x locations a state can have
+	static const int STATE_HEIGHT{ Gameboard::MAX_Y + 2 * STATE_OFFSET };	// the y locations a state can have
+	static const int STATE_COUNT{ STATE_WIDTH * STATE_HEIGHT * Tetromino::ROTATION_COUNT };
+
+	// one rotation of a shape, packed into row masks
+	struct ShapeMask
+	{
+		int minX, maxX;			// the block offsets' x range
+		int minY;				// the top block offset
+		int rowCount;			// the number of rows the shape spans
+		std::uint16_t rows[Tetromino::BLOCK_COUNT];	// bit (x - minX) of rows[y - minY] is set for each block
+	};
+
+	// MEMBER VARIABLES
+	ShapeMask shapeMasks[Tetromino::SHAPE_COUNT][Tetromino::ROTATION_COUNT];
+	std::uint16_t boardRows[Gameboard::MAX_Y];	// the board searched (its row masks)
+	std::uint32_t boardColumns[Gameboard::MAX_X];	// (& its column masks)
+	TetShape shape;								// the shape searched
+	int stackTop;								// the board's highest occupied row (MAX_Y if empty)
+
+	// the search (a state's entries are only valid when its visited stamp is the current search)
+	std::uint32_t search{ 0 };					// the current search's stamp
+	std::uint32_t visited[STATE_COUNT];			// the stamp of the last search that reached (or tested) a state
+	std::uint32_t landed[STATE_COUNT];			// the stamp of the last search that hard dropped onto a state
+	std::int16_t parent[STATE_COUNT];			// the state a state was reached from (-1 for the start)
+	std::uint8_t parentAction[STATE_COUNT];		// the GameAction that reached a state (made depth - the parent's depth times)
+	std::uint16_t depth[STATE_COUNT];			// the number of actions that reach a state
+	std::int16_t queue[STATE_COUNT];			// the breadth first search queue
+
+	std::vector<Placement> placements;			// the placements found by the last generate()
+	std::vector<std::uint64_t> placementCells;	// the cells covered by each placement (see getCellsKey())
+
+public:
+	// constructor, pack every shape rotation into row masks
+	MoveGenerator();
+
+	// find every placement of a shape on a board
+	// - param 1: the board
+	// - param 2: the shape, at the location & rotation the search starts from
+	//            (eg: TetrisEngine::getCurrentShape())
+	// - return: int, the number of placements found (0 if the start isn't legal)
+	int generate(const Gameboard& board, const GridTetromino& start);
+
+	// the placements found by the last generate() (valid until the next generate())
+	const std::vector<Placement>& getPlacements() const;
+
+	// the actions that take the searched shape from its start to a placement
+	//   (ending with the HARD_DROP that locks it)
+	// - param 1: one of the placements of the last generate()
+	// - param 2: the path (replaced)
+	// - return: nothing
+	void getPath(const Placement& placement, std::vector<GameAction>& path) const;
+
+	// a placement as a GridTetromino (eg: to get its mapped block locs)
+	// - param 1: a Placement
+	// - return: a GridTetromino at the placement
+	static GridTetromino toGridTetromino(const Placement& placement);
+
+private:
+	// the index of a state
+	static int getStateIndex(int x, int y, int rotation);
+
+	// true if the searched shape fits on the board at (x, y) with a rotation
+	// (every block within the left, right & bottom borders, on an empty cell)
+	bool isLegal(int x, int y, int rotation) const;
+
+	// the number of rows the searched shape can fall from (x, y) with a rotation
+	int getDropDistance(int x, int y, int rotation) const;
+
+	// reach a state (if it's legal & not reached yet), & queue it
+	//   (every state is tested once per search: an illegal state is marked visited too)
+	//   the action can be made several times (soft drops down several rows), the state's
+	//   depth then counts every one of them
+	// - return: bool, true if the state was queued
+	bool visit(int x, int y, int rotation, int from, GameAction action, int& queueEnd, int repeat = 1);
+
+	// the cells a shape rotation covers at (x, y), packed in 64 bits (equal cells, equal keys)
+	std::uint64_t getCellsKey(int x, int y, int rotation) const;
+};
+
+#endif /* MOVEGENERATOR_H */
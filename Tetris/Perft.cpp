@@ -0,0 +1,219 @@
+#include "Perft.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <unordered_set>
+#include "Random.h"
+#include "UndoStack.h"
+
+namespace
+{
+	// a board's occupancy (its row masks), to find the distinct leaf boards
+	struct BoardKey
+	{
+		std::uint16_t rows[Gameboard::MAX_Y];
+
+		bool operator==(const BoardKey& other) const
+		{
+			return std::memcmp(rows, other.rows, sizeof(rows)) == 0;
+		}
+	};
+
+	struct BoardKeyHash
+	{
+		std::size_t operator()(const BoardKey& key) const
+		{
+			std::uint64_t state = 0;
+			for (std::uint16_t row : key.rows)
+			{
+				state = (state << 7) ^ (state >> 57) ^ row;
+			}
+			return static_cast<std::size_t>(Random::splitMix64(state));
+		}
+	};
+
+	using BoardSet = std::unordered_set<BoardKey, BoardKeyHash>;
+
+	// one worker's own search state
+	struct PerftWorker
+	{
+		Gameboard board;						// the board searched (placed on & undone, never copied)
+		UndoStack undoStack;					// the placements made on the board
+		std::vector<MoveGenerator> generators;	// one per depth (each depth's placements stay valid under it)
+		BoardSet leafBoards;					// the distinct leaf boards found by this worker
+		std::uint64_t nodes{ 0 };				// the placements this worker generated
+		std::uint64_t generations{ 0 };			// the MoveGenerator::generate() calls it made
+	};
+
+	// the settings of a run (shared by every worker)
+	struct PerftSearch
+	{
+		const std::vector<TetShape>& shapes;
+		int depth;
+		bool countDistinctBoards;
+
+		// the shape placed at a depth
+		TetShape getShape(int ply) const
+		{
+			return shapes[ply % shapes.size()];
+		}
+	};
+
+	// a shape at the spawn location
+	GridTetromino getSpawnShape(const Gameboard& board, TetShape shape)
+	{
+		GridTetromino spawned;
+		spawned.setShape(shape);
+		spawned.setGridLoc(board.getSpawnLoc());
+		return spawned;
+	}
+
+	// true if a shape can spawn on a board (like TetrisEngine::spawnNextShape())
+	bool canSpawn(const Gameboard& board, TetShape shape)
+	{
+		for (const Point& p : getSpawnShape(board, shape).getMappedBlockLocs())
+		{
+			if (p.getX() < 0 || p.getX() >= Gameboard::MAX_X || p.getY() >= Gameboard::MAX_Y || board.isOccupied(p.getX(), p.getY()))
+				return false;
+		}
+		return true;
+	}
+
+	std::uint64_t countLeaves(PerftWorker& worker, const PerftSearch& search, int ply);
+
+	// the leaves under a placement: lock it onto the worker's board, spawn the next shape,
+	// remove the completed rows & count the leaves of the next depth (then undo it all)
+	std::uint64_t expand(PerftWorker& worker, const PerftSearch& search, const MoveGenerator::Placement& placement, int ply)
+	{
+		Gameboard& board = worker.board;
+		worker.undoStack.lock(board, MoveGenerator::toGridTetromino(placement).getMappedBlockLocs(),
+			static_cast<int>(Tetromino::getShapeColor(placement.shape)));
+
+		std::uint64_t leaves = 0;
+		if (ply == search.depth - 1)
+		{
+			if (search.countDistinctBoards)
+			{
+				worker.undoStack.removeCompletedRows(board);
+				BoardKey key;
+				for (int y = 0; y < Gameboard::MAX_Y; y++)
+				{
+					key.rows[y] = board.getRowMask(y);
+				}
+				worker.leafBoards.insert(key);
+			}
+			leaves = 1;
+		}
+		else if (canSpawn(board, search.getShape(ply + 1)))
+		{
+			// the next shape spawns before the rows are removed (like TetrisEngine)
+			worker.undoStack.removeCompletedRows(board);
+			leaves = countLeaves(worker, search, ply + 1);
+		}
+		worker.undoStack.undo(board);
+		return leaves;
+	}
+
+	// the leaves under the worker's board, where the shape of depth ply is about to be placed
+	std::uint64_t countLeaves(PerftWorker& worker, const PerftSearch& search, int ply)
+	{
+		MoveGenerator& generator = worker.generators[ply];
+		const int count = generator.generate(worker.board, getSpawnShape(worker.board, search.getShape(ply)));
+		worker.nodes += count;
+		worker.generations++;
+
+		// the last depth: nothing to place below, the placements are the leaves
+		if (ply == search.depth - 1 && !search.countDistinctBoards)
+			return count;
+
+		std::uint64_t leaves = 0;
+		for (const MoveGenerator::Placement& placement : generator.getPlacements())
+		{
+			leaves += expand(worker, search, placement, ply);
+		}
+		return leaves;
+	}
+}
+
+// print the result
+// - params: none
+// - return: nothing
+void PerftResult::printToConsole() const
+{
+	std::cout << "perft " << depth << ": " << leaves << " leaves";
+	if (distinctBoards)
+		std::cout << ", " << distinctBoards << " distinct boards";
+	std::cout << ", " << nodes << " nodes in " << seconds << " s (" << nodesPerSecond << " nodes/s, "
+		<< generationsPerSecond << " generate()/s)\n";
+}
+
+// constructor, start the threads
+// - param 1: the number of threads (0 to use every hardware thread)
+Perft::Perft(int threadCount) : pool{ threadCount }
+{
+}
+
+// count the placement tree
+// - param 1: the starting board
+// - param 2: the shapes to place, in order (repeated if shorter than depth)
+// - param 3: the number of placements (>= 1)
+// - param 4: true to count the distinct leaf boards (slower, stores every leaf board)
+// - return: a PerftResult
+PerftResult Perft::run(const Gameboard& board, const std::vector<TetShape>& shapes, int depth, bool countDistinctBoards)
+{
+	PerftResult result{};
+	result.depth = depth;
+	if (depth < 1 || shapes.empty())
+		return result;
+
+	const auto start = std::chrono::steady_clock::now();
+	const PerftSearch search{ shapes, depth, countDistinctBoards };
+
+	// the root placements (copied: the root generator isn't used by the workers)
+	MoveGenerator rootGenerator;
+	rootGenerator.generate(board, getSpawnShape(board, search.getShape(0)));
+	const std::vector<MoveGenerator::Placement> rootPlacements = rootGenerator.getPlacements();
+	result.leavesPerRootPlacement.resize(rootPlacements.size());
+
+	std::vector<std::unique_ptr<PerftWorker>> workers;
+	for (int i = 0; i < pool.getThreadCount(); i++)
+	{
+		workers.emplace_back(new PerftWorker());
+		workers.back()->board = board;
+		workers.back()->generators.resize(depth);
+	}
+
+	pool.parallelFor(static_cast<std::int64_t>(rootPlacements.size()), [&](std::int64_t i, int worker) {
+		result.leavesPerRootPlacement[i] = expand(*workers[worker], search, rootPlacements[i], 0);
+	});
+
+	result.nodes = rootPlacements.size();
+	result.generations = 1;
+	BoardSet leafBoards;
+	for (const std::unique_ptr<PerftWorker>& worker : workers)
+	{
+		result.nodes += worker->nodes;
+		result.generations += worker->generations;
+		leafBoards.insert(worker->leafBoards.begin(), worker->leafBoards.end());
+	}
+	for (std::uint64_t leaves : result.leavesPerRootPlacement)
+	{
+		result.leaves += leaves;
+	}
+	result.distinctBoards = leafBoards.size();
+
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	if (result.seconds > 0)
+	{
+		result.nodesPerSecond = result.nodes / result.seconds;
+		result.generationsPerSecond = result.generations / result.seconds;
+	}
+	return result;
+}
+
+// the number of worker threads
+int Perft::getThreadCount() const
+{
+	return pool.getThreadCount();
+}
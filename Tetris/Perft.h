@@ -0,0 +1,68 @@
+// The Perft class counts the placement tree of a board (like "perft" in chess):
+// starting from a board and a fixed sequence of shapes, every placement of the first
+// shape (see MoveGenerator) is locked onto the board, its completed rows are removed
+// (Gameboard::removeCompletedRows()), and so on for every shape, depth placements deep.
+//
+// It reports the number of leaves (placement sequences of length depth), the number of
+// distinct boards among them (optional: they have to be stored), the number of nodes
+// (placements generated at every depth) and the nodes per second.  The counts for a
+// given board, sequence & depth never change, so they validate the move generator and
+// the board updates, and the nodes per second is a reproducible throughput benchmark.
+//
+// Like the game, a shape that can't spawn (on the board before its rows are removed)
+// ends that branch.  The root placements are split over a WorkStealingPool; every
+// worker has its own board (placements are made on it & taken back with an UndoStack,
+// so boards are never copied), move generators (one per depth) & set of leaf boards.
+
+#ifndef PERFT_H
+#define PERFT_H
+
+#include <cstdint>
+#include <vector>
+#include "Gameboard.h"
+#include "MoveGenerator.h"
+#include "Tetromino.h"
+#include "WorkStealingPool.h"
+
+// everything a perft run reports
+struct PerftResult
+{
+	int depth;
+	std::uint64_t leaves;			// the placement sequences of length depth
+	std::uint64_t distinctBoards;	// the distinct boards after depth placements (0 if not counted)
+	std::uint64_t nodes;			// the placements generated at every depth
+	std::uint64_t generations;		// the MoveGenerator::generate() calls (the boards searched)
+	double seconds;					// the wall-clock time the run took
+	double nodesPerSecond;
+	double generationsPerSecond;
+	std::vector<std::uint64_t> leavesPerRootPlacement;	// the leaves under each root placement ("divide")
+
+	// print the result
+	// - params: none
+	// - return: nothing
+	void printToConsole() const;
+};
+
+class Perft
+{
+private:
+	WorkStealingPool pool;	// the worker threads
+
+public:
+	// constructor, start the threads
+	// - param 1: the number of threads (0 to use every hardware thread)
+	explicit Perft(int threadCount = 0);
+
+	// count the placement tree
+	// - param 1: the starting board
+	// - param 2: the shapes to place, in order (repeated if shorter than depth)
+	// - param 3: the number of placements (>= 1)
+	// - param 4: true to count the distinct leaf boards (slower, stores every leaf board)
+	// - return: a PerftResult
+	PerftResult run(const Gameboard& board, const std::vector<TetShape>& shapes, int depth, bool countDistinctBoards = false);
+
+	// the number of worker threads
+	int getThreadCount() const;
+};
+
+#endif /* PERFT_H */
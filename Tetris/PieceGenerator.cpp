@@ -0,0 +1,133 @@
+#include "PieceGenerator.h"
+
+// constructor, seed() the generator
+// - param 1: a 64 bit seed
+// - param 2: the RandomizerPolicy to pick shapes with
+PieceGenerator::PieceGenerator(std::uint64_t seed, RandomizerPolicy policy) : policy{ policy }
+{
+	this->seed(seed);
+}
+
+// restart the generator: the same seed (and policy) always produce the same shapes
+// - param 1: a 64 bit seed
+// - return: nothing
+void PieceGenerator::seed(std::uint64_t seed)
+{
+	seedValue = seed;
+	random.seed(seed);
+
+	bagIndex = Tetromino::SHAPE_COUNT;	// empty, the first next() refills it
+
+	for (int i = 0; i < POOL_SIZE; i++)
+	{
+		pool[i] = static_cast<TetShape>(i % Tetromino::SHAPE_COUNT);
+	}
+	for (int i = 0; i < HISTORY_SIZE; i++)	// TGM starts with an S/Z history
+	{
+		history[i] = (i % 2) ? TetShape::Z : TetShape::S;
+	}
+	for (int& drought : droughts)
+	{
+		drought = 0;
+	}
+}
+
+// change the policy, and restart the generator from its seed
+// - param 1: the RandomizerPolicy to pick shapes with
+// - return: nothing
+void PieceGenerator::setPolicy(RandomizerPolicy policy)
+{
+	this->policy = policy;
+	seed(seedValue);
+}
+
+// get the seed the generator was (re)started from
+std::uint64_t PieceGenerator::getSeed() const
+{
+	return seedValue;
+}
+
+// get the policy shapes are picked with
+RandomizerPolicy PieceGenerator::getPolicy() const
+{
+	return policy;
+}
+
+// pick the next shape
+// - params: none
+// - return: a TetShape
+TetShape PieceGenerator::next()
+{
+	switch (policy)
+	{
+	case RandomizerPolicy::SEVEN_BAG:
+		if (bagIndex == Tetromino::SHAPE_COUNT)
+			refillBag();
+		return bag[bagIndex++];
+	case RandomizerPolicy::BAG_WITH_HISTORY:
+		return nextFromPoolWithHistory();
+	default:
+		return static_cast<TetShape>(random.nextInt(Tetromino::SHAPE_COUNT));
+	}
+}
+
+// SEVEN_BAG: refill the bag with each shape once & shuffle it (Fisher-Yates)
+void PieceGenerator::refillBag()
+{
+	for (int i = 0; i < Tetromino::SHAPE_COUNT; i++)
+	{
+		bag[i] = static_cast<TetShape>(i);
+	}
+	for (int i = Tetromino::SHAPE_COUNT - 1; i > 0; i--)
+	{
+		const int j = random.nextInt(i + 1);
+		const TetShape temp = bag[i];
+		bag[i] = bag[j];
+		bag[j] = temp;
+	}
+	bagIndex = 0;
+}
+
+// BAG_WITH_HISTORY: pick a shape from the pool, avoiding the history
+TetShape PieceGenerator::nextFromPoolWithHistory()
+{
+	int index = 0;
+	TetShape shape = TetShape::S;
+	for (int roll = 0; roll < MAX_ROLLS; roll++)
+	{
+		index = random.nextInt(POOL_SIZE);
+		shape = pool[index];
+
+		bool inHistory = false;
+		for (TetShape recent : history)
+		{
+			if (recent == shape)
+				inHistory = true;
+		}
+		if (!inHistory)
+			break;
+	}
+
+	// the picked shape is no longer overdue, every other shape is a little more
+	for (int i = 0; i < Tetromino::SHAPE_COUNT; i++)
+	{
+		droughts[i]++;
+	}
+	droughts[static_cast<int>(shape)] = 0;
+
+	// refill the drawn slot with the most overdue shape
+	int mostOverdue = 0;
+	for (int i = 1; i < Tetromino::SHAPE_COUNT; i++)
+	{
+		if (droughts[i] > droughts[mostOverdue])
+			mostOverdue = i;
+	}
+	pool[index] = static_cast<TetShape>(mostOverdue);
+
+	for (int i = 0; i < HISTORY_SIZE - 1; i++)
+	{
+		history[i] = history[i + 1];
+	}
+	history[HISTORY_SIZE - 1] = shape;
+	return shape;
+}
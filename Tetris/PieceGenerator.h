@@ -0,0 +1,87 @@
+// The PieceGenerator class picks the sequence of shapes a game is played with.
+//
+// Each game owns its own generator (with its own seeded Random), so a game's pieces
+// only depend on its seed: two games with the same seed and policy get the same
+// pieces, and games running on different threads never share a generator.
+// How the shapes are picked depends on the policy:
+//   - UNIFORM:          every shape is equally likely every time (like rand() % 7).
+//   - SEVEN_BAG:        the 7 shapes are dealt in a random order, then reshuffled,
+//                       so there are never more than 12 shapes between two I's.
+//   - BAG_WITH_HISTORY: (TGM3 style) shapes are drawn from a pool of 35 (5 of each),
+//                       a shape seen in the last 4 is re-rolled (up to 6 times), and
+//                       the drawn pool slot is refilled with the most "overdue" shape.
+// The generator holds no pointers or containers, so it is trivially copyable
+// (copying a generator forks its stream).
+
+#ifndef PIECEGENERATOR_H
+#define PIECEGENERATOR_H
+
+#include <cstdint>
+#include "Random.h"
+#include "Tetromino.h"
+
+// how a PieceGenerator picks shapes (see above)
+enum class RandomizerPolicy
+{
+	UNIFORM,
+	SEVEN_BAG,
+	BAG_WITH_HISTORY
+};
+
+class PieceGenerator
+{
+public:
+	// CONSTANTS
+	static const int POOL_SIZE{ 35 };		// BAG_WITH_HISTORY: the pool size (5 of each shape)
+	static const int HISTORY_SIZE{ 4 };		// BAG_WITH_HISTORY: the number of recent shapes avoided
+	static const int MAX_ROLLS{ 6 };		// BAG_WITH_HISTORY: the number of tries to avoid the history
+
+private:
+	// MEMBER VARIABLES
+	RandomizerPolicy policy;	// how shapes are picked
+	std::uint64_t seedValue;	// the seed the generator was (re)started from
+	Random random;				// the generator's own random stream
+
+	TetShape bag[Tetromino::SHAPE_COUNT];	// SEVEN_BAG: the current (shuffled) bag
+	int bagIndex;							// SEVEN_BAG: the next shape to deal from the bag
+
+	TetShape pool[POOL_SIZE];				// BAG_WITH_HISTORY: the pool shapes are drawn from
+	TetShape history[HISTORY_SIZE];			// BAG_WITH_HISTORY: the most recent shapes (oldest first)
+	int droughts[Tetromino::SHAPE_COUNT];	// BAG_WITH_HISTORY: shapes picked since each shape was last seen
+
+public:
+	// constructor, seed() the generator
+	// - param 1: a 64 bit seed
+	// - param 2: the RandomizerPolicy to pick shapes with
+	PieceGenerator(std::uint64_t seed = 0, RandomizerPolicy policy = RandomizerPolicy::UNIFORM);
+
+	// restart the generator: the same seed (and policy) always produce the same shapes
+	// - param 1: a 64 bit seed
+	// - return: nothing
+	void seed(std::uint64_t seed);
+
+	// change the policy, and restart the generator from its seed
+	// - param 1: the RandomizerPolicy to pick shapes with
+	// - return: nothing
+	void setPolicy(RandomizerPolicy policy);
+
+	// get the seed the generator was (re)started from
+	std::uint64_t getSeed() const;
+
+	// get the policy shapes are picked with
+	RandomizerPolicy getPolicy() const;
+
+	// pick the next shape
+	// - params: none
+	// - return: a TetShape
+	TetShape next();
+
+private:
+	// SEVEN_BAG: refill the bag with each shape once & shuffle it (Fisher-Yates)
+	void refillBag();
+
+	// BAG_WITH_HISTORY: pick a shape from the pool, avoiding the history
+	TetShape nextFromPoolWithHistory();
+};
+
+#endif /* PIECEGENERATOR_H */
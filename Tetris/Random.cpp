@@ -0,0 +1,83 @@
+#include "Random.h"
+
+namespace
+{
+	// rotate a 64 bit value left by k bits
+	inline std::uint64_t rotateLeft(std::uint64_t value, int k)
+	{
+		return (value << k) | (value >> (64 - k));
+	}
+}
+
+// constructor, seed the generator
+// - param 1: a 64 bit seed (any value, including 0, is fine)
+Random::Random(std::uint64_t seed)
+{
+	this->seed(seed);
+}
+
+// restart the generator from a seed
+// - param 1: a 64 bit seed
+// - return: nothing
+void Random::seed(std::uint64_t seed)
+{
+	// splitmix64 never outputs 4 zeros in a row, so the state is never all 0
+	for (std::uint64_t& s : state)
+	{
+		s = splitMix64(seed);
+	}
+}
+
+// get the next 64 random bits of the stream
+// - params: none
+// - return: a uniformly distributed 64 bit value
+std::uint64_t Random::next()
+{
+	const std::uint64_t result = rotateLeft(state[1] * 5, 7) * 9;
+	const std::uint64_t t = state[1] << 17;
+
+	state[2] ^= state[0];
+	state[3] ^= state[1];
+	state[1] ^= state[2];
+	state[0] ^= state[3];
+	state[2] ^= t;
+	state[3] = rotateLeft(state[3], 45);
+
+	return result;
+}
+
+// get a random int in [0, bound)
+//   (maps the high 32 bits of next() into range with a multiply & shift,
+//   which is much cheaper than % and has no visible bias for small bounds)
+// - param 1: an int bound, > 0
+// - return: an int in [0, bound)
+int Random::nextInt(int bound)
+{
+	const std::uint64_t high = next() >> 32;
+	return static_cast<int>((high * static_cast<std::uint64_t>(bound)) >> 32);
+}
+
+// advance a splitmix64 state and return its next output.
+//   Used to expand one seed into many well mixed values (eg: the state of a
+//   generator, or the seeds of independent per-game/per-rollout streams).
+// - param 1: the splitmix64 state (updated)
+// - return: the next 64 bit output
+std::uint64_t Random::splitMix64(std::uint64_t& state)
+{
+	std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+// derive the seed of an independent stream from a base seed and a stream index
+//   (eg: one stream per game of a batch, or per rollout)
+// - param 1: the base seed
+// - param 2: the stream index
+// - return: the stream's seed
+std::uint64_t Random::deriveSeed(std::uint64_t seed, std::uint64_t stream)
+{
+	std::uint64_t state = seed ^ (stream * 0xD1B54A32D192ED03ull);
+	splitMix64(state);
+	return splitMix64(state);
+}
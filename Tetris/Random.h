@@ -0,0 +1,56 @@
+// The Random class is a small, fast, seedable pseudo random number generator
+// (xoshiro256**, seeded through splitmix64).
+//
+// Unlike rand(), every Random instance has its own state: two generators built from
+// the same seed produce the same stream, generators on different threads never share
+// (or race on) hidden global state, and a generator can be copied to fork a stream.
+// The state is 4 plain integers, so a Random is trivially copyable.
+
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+
+class Random
+{
+private:
+	std::uint64_t state[4];	// the xoshiro256** state (never all 0)
+
+public:
+	// constructor, seed the generator
+	// - param 1: a 64 bit seed (any value, including 0, is fine)
+	explicit Random(std::uint64_t seed = 0);
+
+	// restart the generator from a seed
+	// - param 1: a 64 bit seed
+	// - return: nothing
+	void seed(std::uint64_t seed);
+
+	// get the next 64 random bits of the stream
+	// - params: none
+	// - return: a uniformly distributed 64 bit value
+	std::uint64_t next();
+
+	// get a random int in [0, bound)
+	//   (maps the high 32 bits of next() into range with a multiply & shift,
+	//   which is much cheaper than % and has no visible bias for small bounds)
+	// - param 1: an int bound, > 0
+	// - return: an int in [0, bound)
+	int nextInt(int bound);
+
+	// advance a splitmix64 state and return its next output.
+	//   Used to expand one seed into many well mixed values (eg: the state of a
+	//   generator, or the seeds of independent per-game/per-rollout streams).
+	// - param 1: the splitmix64 state (updated)
+	// - return: the next 64 bit output
+	static std::uint64_t splitMix64(std::uint64_t& state);
+
+	// derive the seed of an independent stream from a base seed and a stream index
+	//   (eg: one stream per game of a batch, or per rollout)
+	// - param 1: the base seed
+	// - param 2: the stream index
+	// - return: the stream's seed
+	static std::uint64_t deriveSeed(std::uint64_t seed, std::uint64_t stream);
+};
+
+#endif /* RANDOM_H */
@@ -0,0 +1,343 @@
+#include "Replay.h"
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include "Varint.h"
+
+const std::uint8_t Replay::FORMAT_VERSION;
+
+namespace
+{
+	const std::uint8_t MAGIC[4] = { 'T', 'R', 'P', 'L' };	// the first bytes of a replay
+}
+
+// the result of an engine's game so far
+// - param 1: the engine
+// - return: a ReplayResult
+ReplayResult ReplayResult::of(const TetrisEngine& engine)
+{
+	return ReplayResult{ engine.getFrame(), engine.getScore(), engine.getLinesCleared(), engine.getPlacementCount(),
+		engine.isGameOver(), engine.getBoard().getHash() };
+}
+
+bool ReplayResult::operator==(const ReplayResult& other) const
+{
+	return frames == other.frames && score == other.score && linesCleared == other.linesCleared &&
+		placementCount == other.placementCount && gameOver == other.gameOver && boardHash == other.boardHash;
+}
+
+bool ReplayResult::operator!=(const ReplayResult& other) const
+{
+	return !(*this == other);
+}
+
+// constructor, an empty recording
+// - param 1: the seed the game's piece generator started from
+// - param 2: the RandomizerPolicy the game picks shapes with
+Replay::Replay(std::uint64_t seed, RandomizerPolicy policy) : seed{ seed }, policy{ policy }
+{
+}
+
+// start recording a new game (forget the inputs & the result)
+// - param 1: the seed the game's piece generator started from
+// - param 2: the RandomizerPolicy the game picks shapes with
+// - return: nothing
+void Replay::start(std::uint64_t seed, RandomizerPolicy policy)
+{
+	this->seed = seed;
+	this->policy = policy;
+	inputs.clear();
+	checkpoints.clear();
+	result = ReplayResult{};
+}
+
+// record an input (NONE is ignored)
+// - param 1: the frame the action is applied at (the engine's getFrame() when it
+//            is applied between frames), not before the previous input's frame
+// - param 2: the action
+// - return: nothing
+void Replay::addInput(std::int64_t frame, GameAction action)
+{
+	assert((inputs.empty() || frame >= inputs.back().frame) && "Replay::addInput() - inputs out of frame order");
+	if (action != GameAction::NONE)
+		inputs.push_back(Input{ frame, action });
+}
+
+// record how the game ended (or where the recording stopped), & take a checkpoint at
+//   every placement (the recording is played back once)
+// - param 1: the engine that played the game
+// - return: nothing
+void Replay::finish(const TetrisEngine& engine)
+{
+	result = ReplayResult::of(engine);
+	checkpoints.clear();
+	TetrisEngine playback;
+	play(playback, [this](const TetrisEngine& placed) {
+		checkpoints.push_back(Checkpoint{ placed.getFrame(), foldHash(placed) });
+	});
+}
+
+// play the replay back headless
+// - params: none
+// - return: the ReplayResult of the replayed game
+ReplayResult Replay::play() const
+{
+	TetrisEngine engine(seed, policy);
+	play(engine);
+	return ReplayResult::of(engine);
+}
+
+// play the replay back on an engine (reset to the replay's seed)
+// - param 1: the engine (left at the end of the game)
+// - return: nothing
+void Replay::play(TetrisEngine& engine) const
+{
+	const std::int64_t lastFrame = queueInputs(engine);
+	while (!engine.isGameOver() && engine.getFrame() < lastFrame)
+	{
+		const std::int64_t frames = std::min<std::int64_t>(lastFrame - engine.getFrame(), std::numeric_limits<int>::max());
+		engine.step(static_cast<int>(frames));
+	}
+}
+
+// play the replay back on an engine one frame at a time, calling a function after
+//   every frame that placed a shape (eg: to follow a game piece by piece)
+// - param 1: the engine (left at the end of the game)
+// - param 2: the function, called with the engine
+// - return: nothing
+void Replay::play(TetrisEngine& engine, const std::function<void(const TetrisEngine&)>& onPlacement) const
+{
+	const std::int64_t lastFrame = queueInputs(engine);
+	int placements = 0;
+	while (!engine.isGameOver() && engine.getFrame() < lastFrame)
+	{
+		engine.step(1);
+		if (engine.getPlacementCount() != placements)
+		{
+			placements = engine.getPlacementCount();
+			onPlacement(engine);
+		}
+	}
+}
+
+// play the replay back & compare it with the recording: every placement with its
+//   checkpoint (if the replay has them), then the result
+// - param 1: the engine to play on (left at the end of the game)
+// - param 2: where the game played back first differs (set only if it does)
+// - return: bool, true if the game played back exactly like it was recorded
+bool Replay::verify(TetrisEngine& engine, ReplayDivergence& divergence) const
+{
+	bool diverged = false;
+	auto diverge = [&](std::int64_t frame, int placement) {
+		if (!diverged)
+			divergence = ReplayDivergence{ frame, placement };
+		diverged = true;
+	};
+
+	play(engine, [&](const TetrisEngine& placed) {
+		const int placement = placed.getPlacementCount() - 1;	// the placements before this one
+		if (diverged || checkpoints.empty())
+			return;
+		if (placement >= static_cast<int>(checkpoints.size()))
+		{
+			diverge(placed.getFrame(), placement);	// a placement the recording doesn't have
+			return;
+		}
+		// a placement on another frame shows on the earlier of the two
+		const Checkpoint& checkpoint = checkpoints[placement];
+		if (checkpoint.frame != placed.getFrame() || checkpoint.boardHash != foldHash(placed))
+			diverge(std::min(checkpoint.frame, placed.getFrame()), placement);
+	});
+
+	// a recorded placement that didn't happen, then the rest of the result
+	const int placements = engine.getPlacementCount();
+	if (placements < static_cast<int>(checkpoints.size()))
+		diverge(std::min(checkpoints[placements].frame, engine.getFrame()), placements);
+	if (ReplayResult::of(engine) != result)
+		diverge(std::min(engine.getFrame(), result.frames), placements);
+	return !diverged;
+}
+
+// write the replay in the binary format
+// - param 1: the buffer (the bytes are appended)
+// - return: nothing
+void Replay::encode(std::vector<std::uint8_t>& bytes) const
+{
+	bytes.insert(bytes.end(), std::begin(MAGIC), std::end(MAGIC));
+	bytes.push_back(FORMAT_VERSION);
+	bytes.push_back(static_cast<std::uint8_t>(policy));
+	appendFixed64(bytes, seed);
+
+	appendVarint(bytes, inputs.size());
+	std::int64_t previousFrame = 0;
+	for (const Input& input : inputs)
+	{
+		const std::uint64_t delta = static_cast<std::uint64_t>(input.frame - previousFrame);
+		appendVarint(bytes, (delta << ACTION_BITS) | static_cast<std::uint64_t>(input.action));
+		previousFrame = input.frame;
+	}
+
+	appendVarint(bytes, checkpoints.size());
+	previousFrame = 0;
+	for (const Checkpoint& checkpoint : checkpoints)
+	{
+		appendVarint(bytes, static_cast<std::uint64_t>(checkpoint.frame - previousFrame));
+		bytes.push_back(static_cast<std::uint8_t>(checkpoint.boardHash));
+		bytes.push_back(static_cast<std::uint8_t>(checkpoint.boardHash >> 8));
+		previousFrame = checkpoint.frame;
+	}
+
+	appendVarint(bytes, static_cast<std::uint64_t>(result.frames));
+	appendVarint(bytes, static_cast<std::uint64_t>(result.score));
+	appendVarint(bytes, static_cast<std::uint64_t>(result.linesCleared));
+	appendVarint(bytes, static_cast<std::uint64_t>(result.placementCount));
+	bytes.push_back(result.gameOver ? 1 : 0);
+	appendFixed64(bytes, result.boardHash);
+}
+
+// read a replay in the binary format
+// - param 1: the first byte
+// - param 2: the number of bytes
+// - return: bool, false if the bytes aren't a replay this version can read (the
+//           replay is then left empty)
+bool Replay::decode(const std::uint8_t* data, std::size_t size)
+{
+	// the inputs are read in place (a replay decoded over & over keeps its buffer)
+	start(0, RandomizerPolicy::UNIFORM);
+	auto refuse = [this] { inputs.clear(); checkpoints.clear(); return false; };
+	const std::uint8_t* at = data;
+	const std::uint8_t* end = data + size;
+	if (size < sizeof(MAGIC) + 2 || !std::equal(std::begin(MAGIC), std::end(MAGIC), at))
+		return false;
+	at += sizeof(MAGIC);
+	const std::uint8_t version = *at++;
+	const std::uint8_t policyByte = *at++;
+	if (version < 1 || version > FORMAT_VERSION || policyByte > static_cast<std::uint8_t>(RandomizerPolicy::BAG_WITH_HISTORY))
+		return false;
+
+	std::uint64_t readSeed;
+	std::uint64_t inputCount;
+	if (!readFixed64(at, end, readSeed) || !readVarint(at, end, inputCount) || inputCount > static_cast<std::uint64_t>(end - at))
+		return false;
+	inputs.reserve(static_cast<std::size_t>(inputCount));
+	std::int64_t frame = 0;
+	for (std::uint64_t i = 0; i < inputCount; i++)
+	{
+		std::uint64_t value;
+		if (!readVarint(at, end, value))
+			return refuse();
+		const std::uint64_t action = value & ((1u << ACTION_BITS) - 1);
+		if (action == static_cast<std::uint64_t>(GameAction::NONE) || action > static_cast<std::uint64_t>(GameAction::HARD_DROP))
+			return refuse();
+		frame += static_cast<std::int64_t>(value >> ACTION_BITS);
+		inputs.push_back(Input{ frame, static_cast<GameAction>(action) });
+	}
+
+	// version 1 has no checkpoints
+	std::uint64_t checkpointCount = 0;
+	if (version >= 2 && (!readVarint(at, end, checkpointCount) || checkpointCount > static_cast<std::uint64_t>(end - at) / 3))
+		return refuse();
+	checkpoints.reserve(static_cast<std::size_t>(checkpointCount));
+	frame = 0;
+	for (std::uint64_t i = 0; i < checkpointCount; i++)
+	{
+		std::uint64_t delta;
+		if (!readVarint(at, end, delta) || end - at < 2)
+			return refuse();
+		frame += static_cast<std::int64_t>(delta);
+		checkpoints.push_back(Checkpoint{ frame, static_cast<std::uint16_t>(at[0] | (at[1] << 8)) });
+		at += 2;
+	}
+
+	std::uint64_t frames, score, linesCleared, placementCount, boardHash;
+	if (!readVarint(at, end, frames) || !readVarint(at, end, score) || !readVarint(at, end, linesCleared) ||
+		!readVarint(at, end, placementCount) || at == end)
+		return refuse();
+	const std::uint8_t gameOver = *at++;
+	if (gameOver > 1 || !readFixed64(at, end, boardHash) || at != end)
+		return refuse();
+
+	seed = readSeed;
+	policy = static_cast<RandomizerPolicy>(policyByte);
+	result = ReplayResult{ static_cast<std::int64_t>(frames), static_cast<int>(score), static_cast<int>(linesCleared),
+		static_cast<int>(placementCount), gameOver == 1, boardHash };
+	return true;
+}
+
+// save the replay to a file
+// - param 1: the file's path
+// - return: bool, false if the file couldn't be written
+bool Replay::save(const std::string& path) const
+{
+	std::vector<std::uint8_t> bytes;
+	encode(bytes);
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+	return static_cast<bool>(file);
+}
+
+// load a replay from a file
+// - param 1: the file's path
+// - return: bool, false if the file couldn't be read or isn't a replay
+bool Replay::load(const std::string& path)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+		return false;
+	const std::vector<std::uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	return decode(bytes.data(), bytes.size());
+}
+
+// reset an engine to the replay's seed & queue the inputs
+// - param 1: the engine
+// - return: the frame the replay runs to: the recorded end (or past the last input,
+//           if the recording wasn't finished)
+std::int64_t Replay::queueInputs(TetrisEngine& engine) const
+{
+	engine = TetrisEngine(seed, policy);
+	for (const Input& input : inputs)
+	{
+		engine.queueAction(input.frame, input.action);
+	}
+	return std::max(result.frames, inputs.empty() ? 0 : inputs.back().frame + 1);
+}
+
+// the board hash of a checkpoint: a board's 64 bit hash folded to 16 bits
+// - param 1: the engine
+// - return: the 16 bits
+std::uint16_t Replay::foldHash(const TetrisEngine& engine)
+{
+	const std::uint64_t hash = engine.getBoard().getHash();
+	return static_cast<std::uint16_t>(hash ^ (hash >> 16) ^ (hash >> 32) ^ (hash >> 48));
+}
+
+// Getters ======================================================
+
+std::uint64_t Replay::getSeed() const
+{
+	return seed;
+}
+
+RandomizerPolicy Replay::getPolicy() const
+{
+	return policy;
+}
+
+const std::vector<Replay::Input>& Replay::getInputs() const
+{
+	return inputs;
+}
+
+// empty for a version 1 replay
+const std::vector<Replay::Checkpoint>& Replay::getCheckpoints() const
+{
+	return checkpoints;
+}
+
+// as recorded
+const ReplayResult& Replay::getResult() const
+{
+	return result;
+}
@@ -0,0 +1,186 @@
+// The Replay class records a game as its seed plus the player's inputs, and plays it
+// back: the engine is deterministic (the shapes come from the seeded PieceGenerator, the
+// rest from the inputs & the frame they were applied at), so the inputs are the game.
+//
+// A replay is saved in a compact binary format:
+//   - a header: "TRPL", the format version (1 byte), the RandomizerPolicy (1 byte) and
+//     the seed (8 bytes, little endian),
+//   - the number of inputs (varint), then one varint per input: the frames since the
+//     previous input, shifted left 3 bits, with the GameAction in the low 3 bits,
+//   - (from version 2) the number of checkpoints (varint), then per checkpoint the frames
+//     since the previous one (varint) and the checkpoint's board hash (2 bytes),
+//   - the result the game ended with (ReplayResult): the frames, score, rows removed &
+//     placements (varints), whether the game was over (1 byte) and the board's hash
+//     (8 bytes).
+// A player presses a key every few frames, so most inputs take 1 or 2 bytes and a 10
+// minute game takes a few kilobytes.  Version 1 replays (no checkpoints) are still read.
+//
+// A checkpoint is taken at every placement: the frame it happened on & 16 bits of the
+// board's hash.  They cost about 3 bytes a placement, and let verify() find the first
+// placement where a replay played back by a changed engine stops matching the game that
+// was recorded (not just whether the game ended the same).  finish() takes them, by
+// playing the recording back once.
+//
+// play() re-runs a replay headless (a TetrisEngine with the inputs queued at their
+// frames, stepped as fast as it goes, the quiet frames skipped), in a few milliseconds
+// for a 10 minute game, & returns the result, which should be the recorded one.
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "PieceGenerator.h"
+#include "TetrisEngine.h"
+
+// how a game ended (recorded at the end of a game, & found again by playing it back)
+struct ReplayResult
+{
+	std::int64_t frames;		// the frames the game ran
+	int score;
+	int linesCleared;
+	int placementCount;
+	bool gameOver;				// false if the recording stopped before the game ended
+	std::uint64_t boardHash;	// Gameboard::getHash() of the final board
+
+	// the result of an engine's game so far
+	// - param 1: the engine
+	// - return: a ReplayResult
+	static ReplayResult of(const TetrisEngine& engine);
+
+	bool operator==(const ReplayResult& other) const;
+	bool operator!=(const ReplayResult& other) const;
+};
+
+// where a replay played back first stopped matching its recording
+struct ReplayDivergence
+{
+	std::int64_t frame;		// the first frame the difference shows on
+	int placement;			// the placements made before it (in the game played back)
+};
+
+class Replay
+{
+public:
+	// CONSTANTS
+	static const std::uint8_t FORMAT_VERSION{ 2 };	// the version of the binary format written
+	static const int ACTION_BITS{ 3 };				// the bits of an input's GameAction
+
+	// a player's input: an action applied at the start of a frame
+	struct Input
+	{
+		std::int64_t frame;
+		GameAction action;
+	};
+
+	// the game after a placement
+	struct Checkpoint
+	{
+		std::int64_t frame;			// the engine's getFrame() after the frame that placed the shape
+		std::uint16_t boardHash;	// 16 bits of the board's hash (see foldHash())
+	};
+
+private:
+	// MEMBER VARIABLES
+	std::uint64_t seed;
+	RandomizerPolicy policy;
+	std::vector<Input> inputs;		// in frame order
+	std::vector<Checkpoint> checkpoints;	// one per placement (once finish()ed)
+	ReplayResult result{};			// how the game ended (once finish()ed)
+
+public:
+	// constructor, an empty recording
+	// - param 1: the seed the game's piece generator started from
+	// - param 2: the RandomizerPolicy the game picks shapes with
+	Replay(std::uint64_t seed = 0, RandomizerPolicy policy = RandomizerPolicy::UNIFORM);
+
+	// start recording a new game (forget the inputs & the result)
+	// - param 1: the seed the game's piece generator started from
+	// - param 2: the RandomizerPolicy the game picks shapes with
+	// - return: nothing
+	void start(std::uint64_t seed, RandomizerPolicy policy);
+
+	// record an input (NONE is ignored)
+	// - param 1: the frame the action is applied at (the engine's getFrame() when it
+	//            is applied between frames), not before the previous input's frame
+	// - param 2: the action
+	// - return: nothing
+	void addInput(std::int64_t frame, GameAction action);
+
+	// record how the game ended (or where the recording stopped), & take a checkpoint at
+	//   every placement (the recording is played back once)
+	// - param 1: the engine that played the game
+	// - return: nothing
+	void finish(const TetrisEngine& engine);
+
+	// play the replay back headless
+	// - params: none
+	// - return: the ReplayResult of the replayed game
+	ReplayResult play() const;
+
+	// play the replay back on an engine (reset to the replay's seed)
+	// - param 1: the engine (left at the end of the game)
+	// - return: nothing
+	void play(TetrisEngine& engine) const;
+
+	// play the replay back on an engine one frame at a time, calling a function after
+	//   every frame that placed a shape (eg: to follow a game piece by piece)
+	// - param 1: the engine (left at the end of the game)
+	// - param 2: the function, called with the engine
+	// - return: nothing
+	void play(TetrisEngine& engine, const std::function<void(const TetrisEngine&)>& onPlacement) const;
+
+	// play the replay back & compare it with the recording: every placement with its
+	//   checkpoint (if the replay has them), then the result
+	// - param 1: the engine to play on (left at the end of the game)
+	// - param 2: where the game played back first differs (set only if it does)
+	// - return: bool, true if the game played back exactly like it was recorded
+	bool verify(TetrisEngine& engine, ReplayDivergence& divergence) const;
+
+	// write the replay in the binary format
+	// - param 1: the buffer (the bytes are appended)
+	// - return: nothing
+	void encode(std::vector<std::uint8_t>& bytes) const;
+
+	// read a replay in the binary format
+	// - param 1: the first byte
+	// - param 2: the number of bytes
+	// - return: bool, false if the bytes aren't a replay this version can read (the
+	//           replay is then left empty)
+	bool decode(const std::uint8_t* data, std::size_t size);
+
+	// save the replay to a file
+	// - param 1: the file's path
+	// - return: bool, false if the file couldn't be written
+	bool save(const std::string& path) const;
+
+	// load a replay from a file
+	// - param 1: the file's path
+	// - return: bool, false if the file couldn't be read or isn't a replay
+	bool load(const std::string& path);
+
+private:
+	// reset an engine to the replay's seed & queue the inputs
+	// - param 1: the engine
+	// - return: the frame the replay runs to: the recorded end (or past the last input,
+	//           if the recording wasn't finished)
+	std::int64_t queueInputs(TetrisEngine& engine) const;
+
+	// the board hash of a checkpoint: a board's 64 bit hash folded to 16 bits
+	// - param 1: the engine
+	// - return: the 16 bits
+	static std::uint16_t foldHash(const TetrisEngine& engine);
+
+public:
+	// Getters ======================================================
+
+	std::uint64_t getSeed() const;
+	RandomizerPolicy getPolicy() const;
+	const std::vector<Input>& getInputs() const;
+	const std::vector<Checkpoint>& getCheckpoints() const;	// empty for a version 1 replay
+	const ReplayResult& getResult() const;	// as recorded
+};
+
+#endif /* REPLAY_H */
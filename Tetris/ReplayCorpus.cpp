@@ -0,0 +1,288 @@
+#include "ReplayCorpus.h"
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include "Varint.h"
+
+const std::uint8_t ReplayCorpus::FORMAT_VERSION;
+
+namespace
+{
+	const std::uint8_t MAGIC[4] = { 'T', 'R', 'P', 'C' };	// the first bytes of a corpus
+
+	// the header's fields
+	struct Header
+	{
+		std::uint64_t replayCount;
+		std::uint64_t indexOffset;
+	};
+
+	// write a header
+	void appendHeader(std::vector<std::uint8_t>& bytes, const Header& header)
+	{
+		bytes.insert(bytes.end(), std::begin(MAGIC), std::end(MAGIC));
+		bytes.push_back(ReplayCorpus::FORMAT_VERSION);
+		bytes.insert(bytes.end(), 3, 0);
+		appendFixed64(bytes, header.replayCount);
+		appendFixed64(bytes, header.indexOffset);
+		appendFixed64(bytes, 0);
+		assert(bytes.size() % ReplayCorpus::HEADER_BYTES == 0 && "appendHeader() - wrong size");
+	}
+
+	// read a header (HEADER_BYTES)
+	// - return: bool, false if it isn't the header of a corpus this version can read
+	bool readHeader(const std::uint8_t* at, Header& header)
+	{
+		const std::uint8_t* end = at + ReplayCorpus::HEADER_BYTES;
+		if (!std::equal(std::begin(MAGIC), std::end(MAGIC), at) || at[4] != ReplayCorpus::FORMAT_VERSION)
+			return false;
+		at += 8;
+		return readFixed64(at, end, header.replayCount) && readFixed64(at, end, header.indexOffset);
+	}
+
+	// write an index entry
+	void appendEntry(std::vector<std::uint8_t>& bytes, const ReplayCorpus::Entry& entry)
+	{
+		appendFixed64(bytes, entry.offset);
+		appendFixed32(bytes, entry.size);
+		appendFixed32(bytes, static_cast<std::uint32_t>(entry.result.score));
+		appendFixed32(bytes, static_cast<std::uint32_t>(entry.result.linesCleared));
+		appendFixed32(bytes, static_cast<std::uint32_t>(entry.result.placementCount));
+		appendFixed64(bytes, static_cast<std::uint64_t>(entry.result.frames));
+		bytes.push_back(entry.result.gameOver ? 1 : 0);
+		bytes.insert(bytes.end(), 7, 0);
+		appendFixed64(bytes, entry.result.boardHash);
+	}
+
+	// read an index entry (ENTRY_BYTES)
+	ReplayCorpus::Entry readEntry(const std::uint8_t* at)
+	{
+		const std::uint8_t* end = at + ReplayCorpus::ENTRY_BYTES;
+		ReplayCorpus::Entry entry{};
+		std::uint32_t score, linesCleared, placementCount;
+		std::uint64_t frames;
+		readFixed64(at, end, entry.offset);
+		readFixed32(at, end, entry.size);
+		readFixed32(at, end, score);
+		readFixed32(at, end, linesCleared);
+		readFixed32(at, end, placementCount);
+		readFixed64(at, end, frames);
+		entry.result.gameOver = (*at != 0);
+		at += 8;
+		readFixed64(at, end, entry.result.boardHash);
+		entry.result.score = static_cast<int>(score);
+		entry.result.linesCleared = static_cast<int>(linesCleared);
+		entry.result.placementCount = static_cast<int>(placementCount);
+		entry.result.frames = static_cast<std::int64_t>(frames);
+		return entry;
+	}
+}
+
+// open a corpus file (closing the one opened before)
+// - param 1: the file's path
+// - return: bool, false if the file couldn't be mapped or isn't a corpus this
+//           version can read
+bool ReplayCorpus::open(const std::string& path)
+{
+	close();
+	Header header;
+	if (!file.open(path) || file.getSize() < HEADER_BYTES || !readHeader(file.getData(), header) ||
+		header.indexOffset < HEADER_BYTES || header.indexOffset > file.getSize() ||
+		header.replayCount > (file.getSize() - header.indexOffset) / ENTRY_BYTES)
+	{
+		close();
+		return false;
+	}
+	replayCount = header.replayCount;
+	index = file.getData() + header.indexOffset;
+	return true;
+}
+
+// close the corpus file (nothing if none is open)
+// - params: none
+// - return: nothing
+void ReplayCorpus::close()
+{
+	file.close();
+	replayCount = 0;
+	index = nullptr;
+}
+
+// a replay's index entry
+// - param 1: the replay's index, in [0, getReplayCount())
+// - return: an Entry
+ReplayCorpus::Entry ReplayCorpus::getEntry(std::uint64_t replay) const
+{
+	assert(replay < replayCount && "ReplayCorpus::getEntry() - no such replay");
+	return readEntry(index + replay * ENTRY_BYTES);
+}
+
+// a replay's bytes, in place in the mapped file
+// - param 1: the replay's index, in [0, getReplayCount())
+// - param 2: the number of bytes
+// - return: the first byte (nullptr if the entry points outside the replays)
+const std::uint8_t* ReplayCorpus::getReplayData(std::uint64_t replay, std::size_t& size) const
+{
+	const Entry entry = getEntry(replay);
+	const std::uint64_t indexOffset = static_cast<std::uint64_t>(index - file.getData());
+	size = 0;
+	if (entry.offset < HEADER_BYTES || entry.offset > indexOffset || entry.size > indexOffset - entry.offset)
+		return nullptr;
+	size = entry.size;
+	return file.getData() + entry.offset;
+}
+
+// decode a replay
+// - param 1: the replay's index, in [0, getReplayCount())
+// - param 2: the Replay to decode it into
+// - return: bool, false if the replay can't be read
+bool ReplayCorpus::getReplay(std::uint64_t replay, Replay& result) const
+{
+	std::size_t size;
+	const std::uint8_t* data = getReplayData(replay, size);
+	if (data == nullptr)
+	{
+		result.start(0, RandomizerPolicy::UNIFORM);
+		return false;
+	}
+	return result.decode(data, size);
+}
+
+// Getters ======================================================
+
+bool ReplayCorpus::isOpen() const
+{
+	return file.isOpen();
+}
+
+std::uint64_t ReplayCorpus::getReplayCount() const
+{
+	return replayCount;
+}
+
+// in bytes
+std::uint64_t ReplayCorpus::getFileSize() const
+{
+	return file.getSize();
+}
+
+// destructor, close the corpus (writing the index)
+ReplayCorpusWriter::~ReplayCorpusWriter()
+{
+	close();
+}
+
+// open a corpus to append replays to, or create it if the file doesn't exist
+//   (closing the one opened before)
+// - param 1: the file's path
+// - return: bool, false if the file couldn't be opened or isn't a corpus
+bool ReplayCorpusWriter::open(const std::string& path)
+{
+	close();
+	entries.clear();
+	changed = false;
+
+	if (!std::ifstream(path))
+	{
+		std::vector<std::uint8_t> header;
+		appendHeader(header, Header{ 0, ReplayCorpus::HEADER_BYTES });
+		std::ofstream created(path, std::ios::binary | std::ios::trunc);
+		created.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+		if (!created)
+			return false;
+	}
+
+	file.open(path, std::ios::binary | std::ios::in | std::ios::out);
+	std::uint8_t headerBytes[ReplayCorpus::HEADER_BYTES];
+	Header header;
+	if (!file.read(reinterpret_cast<char*>(headerBytes), sizeof(headerBytes)) || !readHeader(headerBytes, header))
+	{
+		file.close();
+		return false;
+	}
+	file.seekg(0, std::ios::end);
+	end = static_cast<std::uint64_t>(file.tellg());
+	if (header.indexOffset > end || header.replayCount > (end - header.indexOffset) / ReplayCorpus::ENTRY_BYTES)
+	{
+		file.close();
+		return false;
+	}
+
+	// the index is kept in memory (& written again, with the new entries, when closed)
+	std::vector<std::uint8_t> index(static_cast<std::size_t>(header.replayCount * ReplayCorpus::ENTRY_BYTES));
+	file.seekg(static_cast<std::streamoff>(header.indexOffset));
+	if (!file.read(reinterpret_cast<char*>(index.data()), static_cast<std::streamsize>(index.size())))
+	{
+		file.close();
+		return false;
+	}
+	entries.reserve(static_cast<std::size_t>(header.replayCount));
+	for (std::size_t at = 0; at < index.size(); at += ReplayCorpus::ENTRY_BYTES)
+	{
+		entries.push_back(readEntry(index.data() + at));
+	}
+	return true;
+}
+
+// append a replay
+// - param 1: the replay
+// - return: bool, false if it couldn't be written
+bool ReplayCorpusWriter::add(const Replay& replay)
+{
+	if (!file.is_open())
+		return false;
+	buffer.clear();
+	replay.encode(buffer);
+	file.seekp(static_cast<std::streamoff>(end));
+	if (!file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size())))
+		return false;
+	entries.push_back(ReplayCorpus::Entry{ end, static_cast<std::uint32_t>(buffer.size()), replay.getResult() });
+	end += buffer.size();
+	changed = true;
+	return true;
+}
+
+// write the index & the header, then close the file (nothing if none is open)
+// - params: none
+// - return: bool, false if they couldn't be written
+bool ReplayCorpusWriter::close()
+{
+	if (!file.is_open())
+		return true;
+	bool written = true;
+	if (changed)
+	{
+		// the index after the replays, then the header that points to it
+		buffer.clear();
+		for (const ReplayCorpus::Entry& entry : entries)
+		{
+			appendEntry(buffer, entry);
+		}
+		file.seekp(static_cast<std::streamoff>(end));
+		file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+		file.flush();
+
+		buffer.clear();
+		appendHeader(buffer, Header{ entries.size(), end });
+		file.seekp(0);
+		file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+		file.flush();
+		written = static_cast<bool>(file);
+	}
+	file.close();
+	changed = false;
+	return written;
+}
+
+// Getters ======================================================
+
+bool ReplayCorpusWriter::isOpen() const
+{
+	return file.is_open();
+}
+
+// in the corpus, including the ones added
+std::uint64_t ReplayCorpusWriter::getReplayCount() const
+{
+	return entries.size();
+}
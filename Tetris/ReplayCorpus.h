@@ -0,0 +1,127 @@
+// The ReplayCorpus class reads many replays packed in one file (a corpus), and the
+// ReplayCorpusWriter class appends replays to one.
+//
+// A corpus file is:
+//   - a header (32 bytes): "TRPC", the format version (1 byte, then 3 zeros), the number
+//     of replays & the offset of the index (8 bytes each, little endian), 8 zeros,
+//   - the replays, in the Replay binary format, one after another,
+//   - the index: a fixed size entry (48 bytes) per replay, in the order they were added:
+//     where the replay is (offset & size) and its recorded ReplayResult, so summaries of
+//     the whole corpus (eg: the score distribution) need only the index.
+//
+// The file is only ever appended to: a writer adds replays after the end of the file,
+// then a new index (the old entries & the new ones), and rewrites the header last, so
+// a corpus interrupted while being written still reads as it was.  The old index stays
+// in the file as unused bytes, so replays are better added in batches (a writer keeps
+// its index in memory until it is closed).
+//
+// The reader maps the file into memory (see MappedFile): the index & a replay's bytes
+// are read in place, by any number of threads at once, with no file opened per replay.
+
+#ifndef REPLAYCORPUS_H
+#define REPLAYCORPUS_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "Replay.h"
+
+class ReplayCorpus
+{
+public:
+	// CONSTANTS
+	static const std::uint8_t FORMAT_VERSION{ 1 };	// the version of the corpus format written
+	static const int HEADER_BYTES{ 32 };
+	static const int ENTRY_BYTES{ 48 };				// the bytes of an index entry
+
+	// where a replay is in the file, and how it ended
+	struct Entry
+	{
+		std::uint64_t offset;	// the replay's first byte
+		std::uint32_t size;		// the replay's bytes
+		ReplayResult result;	// as recorded
+	};
+
+private:
+	// MEMBER VARIABLES
+	MappedFile file;
+	std::uint64_t replayCount{ 0 };
+	const std::uint8_t* index{ nullptr };	// the first index entry (in the mapped file)
+
+public:
+	// open a corpus file (closing the one opened before)
+	// - param 1: the file's path
+	// - return: bool, false if the file couldn't be mapped or isn't a corpus this
+	//           version can read
+	bool open(const std::string& path);
+
+	// close the corpus file (nothing if none is open)
+	// - params: none
+	// - return: nothing
+	void close();
+
+	// a replay's index entry
+	// - param 1: the replay's index, in [0, getReplayCount())
+	// - return: an Entry
+	Entry getEntry(std::uint64_t replay) const;
+
+	// a replay's bytes, in place in the mapped file
+	// - param 1: the replay's index, in [0, getReplayCount())
+	// - param 2: the number of bytes
+	// - return: the first byte (nullptr if the entry points outside the replays)
+	const std::uint8_t* getReplayData(std::uint64_t replay, std::size_t& size) const;
+
+	// decode a replay
+	// - param 1: the replay's index, in [0, getReplayCount())
+	// - param 2: the Replay to decode it into
+	// - return: bool, false if the replay can't be read
+	bool getReplay(std::uint64_t replay, Replay& result) const;
+
+	// Getters ======================================================
+
+	bool isOpen() const;
+	std::uint64_t getReplayCount() const;
+	std::uint64_t getFileSize() const;		// in bytes
+};
+
+class ReplayCorpusWriter
+{
+private:
+	// MEMBER VARIABLES
+	std::fstream file;
+	std::vector<ReplayCorpus::Entry> entries;	// the index: every replay in the file
+	std::uint64_t end{ 0 };						// where the next replay is written
+	bool changed{ false };						// true if replays were added since opening
+	std::vector<std::uint8_t> buffer;			// a replay's bytes (reused)
+
+public:
+	ReplayCorpusWriter() = default;
+
+	// destructor, close the corpus (writing the index)
+	~ReplayCorpusWriter();
+
+	// open a corpus to append replays to, or create it if the file doesn't exist
+	//   (closing the one opened before)
+	// - param 1: the file's path
+	// - return: bool, false if the file couldn't be opened or isn't a corpus
+	bool open(const std::string& path);
+
+	// append a replay
+	// - param 1: the replay
+	// - return: bool, false if it couldn't be written
+	bool add(const Replay& replay);
+
+	// write the index & the header, then close the file (nothing if none is open)
+	// - params: none
+	// - return: bool, false if they couldn't be written
+	bool close();
+
+	// Getters ======================================================
+
+	bool isOpen() const;
+	std::uint64_t getReplayCount() const;	// in the corpus, including the ones added
+};
+
+#endif /* REPLAYCORPUS_H */
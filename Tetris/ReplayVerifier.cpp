@@ -0,0 +1,124 @@
+#include "ReplayVerifier.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace
+{
+	const std::int64_t GRAIN{ 8 };				// the replays a worker plays back at a time
+	const std::size_t PRINTED_DIVERGENCES{ 10 };	// the divergent replays printToConsole() lists
+
+	// print a ReplayResult on one line
+	void printResult(const char* name, const ReplayResult& r)
+	{
+		std::cout << "    " << name << ": " << r.frames << " frames, score " << r.score << ", " << r.linesCleared << " rows, "
+			<< r.placementCount << " placements" << (r.gameOver ? ", over" : "") << ", board " << std::hex << r.boardHash
+			<< std::dec << "\n";
+	}
+}
+
+// true if every replay was read & played back like it was recorded
+// - params: none
+// - return: bool
+bool VerificationReport::isIdentical() const
+{
+	return unreadable == 0 && divergent.empty();
+}
+
+// the divergent replay that differs on the earliest frame
+// - params: none
+// - return: a pointer into divergent (nullptr if there is none)
+const DivergentReplay* VerificationReport::getFirstDivergence() const
+{
+	const DivergentReplay* first = nullptr;
+	for (const DivergentReplay& d : divergent)
+	{
+		if (first == nullptr || d.divergence.frame < first->divergence.frame)
+			first = &d;
+	}
+	return first;
+}
+
+// print the report (& the first few divergent replays)
+// - params: none
+// - return: nothing
+void VerificationReport::printToConsole() const
+{
+	std::cout << replays << " replays (" << checkpoints << " checkpoints) verified on " << threads << " threads in "
+		<< seconds << " s: " << ((seconds > 0) ? replays / seconds : 0) << " replays/s\n";
+	std::cout << "  " << (replays - divergent.size()) << " identical, " << divergent.size() << " divergent, "
+		<< unreadable << " unreadable\n";
+	for (std::size_t i = 0; i < divergent.size() && i < PRINTED_DIVERGENCES; i++)
+	{
+		const DivergentReplay& d = divergent[i];
+		std::cout << "  replay " << d.replay << " diverges at frame " << d.divergence.frame << " (after "
+			<< d.divergence.placement << " placements)\n";
+		printResult("recorded", d.recorded);
+		printResult("replayed", d.replayed);
+	}
+	if (const DivergentReplay* first = getFirstDivergence())
+		std::cout << "  first divergence: replay " << first->replay << " at frame " << first->divergence.frame << "\n";
+}
+
+// constructor, start the threads
+// - param 1: the number of threads (0 to use every hardware thread)
+ReplayVerifier::ReplayVerifier(int threadCount) : pool{ threadCount }
+{
+	for (int i = 0; i < pool.getThreadCount(); i++)
+	{
+		workers.push_back(std::unique_ptr<Worker>(new Worker{ TetrisEngine(), Replay(), {}, 0, 0 }));
+	}
+}
+
+// play back a range of a corpus' replays & compare them with their recordings
+// - param 1: the corpus (open)
+// - param 2: the first replay
+// - param 3: the end of the range (past the last replay; clamped to the corpus' size)
+// - return: a VerificationReport
+VerificationReport ReplayVerifier::verify(const ReplayCorpus& corpus, std::uint64_t first, std::uint64_t end)
+{
+	end = std::min(end, corpus.getReplayCount());
+	first = std::min(first, end);
+
+	const auto start = std::chrono::steady_clock::now();
+	for (std::unique_ptr<Worker>& worker : workers)
+	{
+		worker->divergent.clear();
+		worker->unreadable = 0;
+		worker->checkpoints = 0;
+	}
+	pool.parallelFor(static_cast<std::int64_t>(end - first), [&](std::int64_t i, int worker) {
+		Worker& w = *workers[worker];
+		const std::uint64_t replay = first + i;
+		if (!corpus.getReplay(replay, w.replay))
+		{
+			w.unreadable++;
+			return;
+		}
+		w.checkpoints += w.replay.getCheckpoints().size();
+		ReplayDivergence divergence;
+		if (!w.replay.verify(w.engine, divergence))
+			w.divergent.push_back(DivergentReplay{ replay, divergence, w.replay.getResult(), ReplayResult::of(w.engine) });
+	}, GRAIN);
+
+	VerificationReport report{};
+	report.replays = end - first;
+	report.threads = pool.getThreadCount();
+	for (const std::unique_ptr<Worker>& worker : workers)
+	{
+		report.unreadable += worker->unreadable;
+		report.checkpoints += worker->checkpoints;
+		report.divergent.insert(report.divergent.end(), worker->divergent.begin(), worker->divergent.end());
+	}
+	report.replays -= report.unreadable;
+	std::sort(report.divergent.begin(), report.divergent.end(),
+		[](const DivergentReplay& a, const DivergentReplay& b) { return a.replay < b.replay; });
+	report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return report;
+}
+
+// the number of worker threads
+int ReplayVerifier::getThreadCount() const
+{
+	return pool.getThreadCount();
+}
@@ -0,0 +1,97 @@
+// The ReplayVerifier class checks that the replays of a ReplayCorpus still play back
+// exactly like they were recorded (eg: after a change to the engine's rules, rotations
+// or row removal), across every core.
+//
+// Every replay is played back & compared with its recording (Replay::verify()): each
+// placement with its checkpoint (its frame & board hash), then the final frames, score,
+// rows, placements & board hash.  A replay that differs is reported with the first frame
+// the difference shows on, so the change that broke it can be found by replaying that
+// one game up to that frame.  (A version 1 replay has no checkpoints: only its result
+// is compared, and the reported frame is its end.)
+//
+// The replays are spread over a WorkStealingPool in small runs of the index; every
+// worker owns its engine & Replay (allocated once, reused for all its replays) and
+// collects its own divergent replays, which are merged at the end.
+
+#ifndef REPLAYVERIFIER_H
+#define REPLAYVERIFIER_H
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+#include "Replay.h"
+#include "ReplayCorpus.h"
+#include "TetrisEngine.h"
+#include "WorkStealingPool.h"
+
+// a replay of a corpus that didn't play back like it was recorded
+struct DivergentReplay
+{
+	std::uint64_t replay;			// the replay's index in the corpus
+	ReplayDivergence divergence;	// where it first differs
+	ReplayResult recorded;
+	ReplayResult replayed;
+};
+
+// everything a verification reports
+struct VerificationReport
+{
+	std::uint64_t replays;					// the replays played back
+	std::uint64_t unreadable;				// the replays that couldn't be decoded
+	std::uint64_t checkpoints;				// the checkpoints compared
+	std::vector<DivergentReplay> divergent;	// the replays that differ, in corpus order
+	int threads;							// the number of worker threads used
+	double seconds;							// the wall-clock time the verification took
+
+	// true if every replay was read & played back like it was recorded
+	// - params: none
+	// - return: bool
+	bool isIdentical() const;
+
+	// the divergent replay that differs on the earliest frame
+	// - params: none
+	// - return: a pointer into divergent (nullptr if there is none)
+	const DivergentReplay* getFirstDivergence() const;
+
+	// print the report (& the first few divergent replays)
+	// - params: none
+	// - return: nothing
+	void printToConsole() const;
+};
+
+class ReplayVerifier
+{
+private:
+	// a worker's own engine, replay & findings (separately allocated, so workers never share a cache line)
+	struct Worker
+	{
+		TetrisEngine engine;
+		Replay replay;
+		std::vector<DivergentReplay> divergent;
+		std::uint64_t unreadable;
+		std::uint64_t checkpoints;
+	};
+
+	// MEMBER VARIABLES
+	WorkStealingPool pool;							// the worker threads
+	std::vector<std::unique_ptr<Worker>> workers;	// a Worker per thread
+
+public:
+	// constructor, start the threads
+	// - param 1: the number of threads (0 to use every hardware thread)
+	explicit ReplayVerifier(int threadCount = 0);
+
+	// play back a range of a corpus' replays & compare them with their recordings
+	// - param 1: the corpus (open)
+	// - param 2: the first replay
+	// - param 3: the end of the range (past the last replay; clamped to the corpus' size)
+	// - return: a VerificationReport
+	VerificationReport verify(const ReplayCorpus& corpus, std::uint64_t first = 0,
+		std::uint64_t end = std::numeric_limits<std::uint64_t>::max());
+
+	// the number of worker threads
+	int getThreadCount() const;
+};
+
+#endif /* REPLAYVERIFIER_H */
@@ -0,0 +1,178 @@
+#include "RolloutEvaluator.h"
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+	// true if a shape can spawn on a board (like TetrisEngine::spawnNextShape())
+	bool canSpawn(const Gameboard& board, TetShape shape)
+	{
+		GridTetromino spawned;
+		spawned.setShape(shape);
+		spawned.setGridLoc(board.getSpawnLoc());
+		for (const Point& p : spawned.getMappedBlockLocs())
+		{
+			if (p.getX() < 0 || p.getX() >= Gameboard::MAX_X || p.getY() >= Gameboard::MAX_Y || board.isOccupied(p.getX(), p.getY()))
+				return false;
+		}
+		return true;
+	}
+}
+
+// constructor, start the threads
+// - param 1: the number of threads (0 to use every hardware thread)
+RolloutEvaluator::RolloutEvaluator(int threadCount) : pool{ threadCount }
+{
+	for (int s = 0; s < Tetromino::SHAPE_COUNT; s++)
+	{
+		for (int rotation = 0; rotation < Tetromino::ROTATION_COUNT; rotation++)
+		{
+			const BlockOffset* offsets = Tetromino::getRotationOffsets(static_cast<TetShape>(s), rotation);
+			ShapeRotation& r = rotations[s][rotation];
+			r.minX = r.maxX = offsets[0].x;
+			for (int block = 0; block < Tetromino::BLOCK_COUNT; block++)
+			{
+				r.offsets[block] = offsets[block];
+				r.minX = std::min(r.minX, offsets[block].x);
+				r.maxX = std::max(r.maxX, offsets[block].x);
+			}
+		}
+	}
+}
+
+// roll out every candidate placement of a shape on a board
+// - param 1: the board
+// - param 2: the candidate placements (eg: MoveGenerator::getPlacements())
+// - param 3: the shape placed after the candidates (the first shape of every
+//            rollout, eg: the engine's next shape), or nullptr to pick it at random
+// - param 4: the RolloutSettings
+// - return: a RolloutReport
+RolloutReport RolloutEvaluator::evaluate(const Gameboard& board, const std::vector<MoveGenerator::Placement>& candidates,
+	const TetShape* nextShape, const RolloutSettings& settings)
+{
+	RolloutReport report{};
+	report.threads = pool.getThreadCount();
+	const std::size_t candidateCount = candidates.size();
+	const int rollouts = std::max(1, settings.rollouts);
+	const auto start = std::chrono::steady_clock::now();
+
+	// the candidates' boards (the rows they complete removed, after the spawn test)
+	candidateBoards.assign(candidateCount, board);
+	candidateLines.assign(candidateCount, 0);
+	candidateAlive.assign(candidateCount, true);
+	for (std::size_t c = 0; c < candidateCount; c++)
+	{
+		const MoveGenerator::Placement& placement = candidates[c];
+		candidateBoards[c].setContent(MoveGenerator::toGridTetromino(placement).getMappedBlockLocs(),
+			static_cast<int>(Tetromino::getShapeColor(placement.shape)));
+		candidateAlive[c] = !nextShape || canSpawn(candidateBoards[c], *nextShape);
+		candidateLines[c] = candidateBoards[c].removeCompletedRows();
+	}
+
+	outcomes.resize(candidateCount * rollouts);
+	pool.parallelFor(static_cast<std::int64_t>(outcomes.size()), [&](std::int64_t i, int) {
+		const std::size_t c = static_cast<std::size_t>(i / rollouts);
+		if (!candidateAlive[c])
+		{
+			outcomes[i] = Outcome{ 0, 0 };
+			return;
+		}
+		Gameboard rolloutBoard = candidateBoards[c];
+		outcomes[i] = rollout(rolloutBoard, nextShape, settings, static_cast<std::uint64_t>(i % rollouts));
+	}, 16);
+
+	// sum in a fixed order, so the results don't depend on the threads
+	report.results.resize(candidateCount);
+	for (std::size_t c = 0; c < candidateCount; c++)
+	{
+		std::int64_t lines = 0;
+		int survived = 0;
+		for (int r = 0; r < rollouts; r++)
+		{
+			const Outcome& outcome = outcomes[c * rollouts + r];
+			lines += outcome.lines;
+			survived += (outcome.steps == settings.depth) ? 1 : 0;
+			report.steps += outcome.steps;
+		}
+		report.results[c] = RolloutResult{ candidateLines[c], static_cast<double>(lines) / rollouts,
+			static_cast<double>(survived) / rollouts };
+	}
+
+	report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	if (report.seconds > 0)
+	{
+		report.stepsPerSecond = report.steps / report.seconds;
+		report.stepsPerSecondPerThread = report.stepsPerSecond / report.threads;
+	}
+	return report;
+}
+
+// the number of worker threads
+int RolloutEvaluator::getThreadCount() const
+{
+	return pool.getThreadCount();
+}
+
+// play one rollout on a board (changed by the rollout)
+// - param 1: the board
+// - param 2: the first shape, or nullptr to pick it at random
+// - param 3: the RolloutSettings
+// - param 4: the rollout's index (its random streams)
+// - return: the Outcome
+RolloutEvaluator::Outcome RolloutEvaluator::rollout(Gameboard& board, const TetShape* firstShape,
+	const RolloutSettings& settings, std::uint64_t index) const
+{
+	const std::uint64_t rolloutSeed = Random::deriveSeed(settings.seed, index);
+	PieceGenerator pieces(Random::deriveSeed(rolloutSeed, 0), settings.randomizerPolicy);
+	Random random(Random::deriveSeed(rolloutSeed, 1));
+	const int drops = std::max(1, settings.dropsPerShape);
+
+	Outcome outcome{ 0, 0 };
+	TetShape shape = firstShape ? *firstShape : pieces.next();
+	if (!firstShape && !canSpawn(board, shape))
+		return outcome;
+	for (int step = 0; step < settings.depth; step++)
+	{
+		// the lowest landing of a few random straight drops
+		// (a block of a shape at gridY lands on its column: gridY + dy < MAX_Y - height)
+		const ShapeRotation* best = nullptr;
+		int bestX = 0;
+		int bestY = -Gameboard::MAX_Y;
+		for (int drop = 0; drop < drops; drop++)
+		{
+			const ShapeRotation& r = rotations[static_cast<int>(shape)][random.nextInt(Tetromino::ROTATION_COUNT)];
+			const int x = -r.minX + random.nextInt(Gameboard::MAX_X - (r.maxX - r.minX));
+			int y = Gameboard::MAX_Y;
+			for (const BlockOffset& offset : r.offsets)
+			{
+				y = std::min(y, Gameboard::MAX_Y - board.getColumnHeight(x + offset.x) - 1 - offset.y);
+			}
+			if (!best || y > bestY)
+			{
+				best = &r;
+				bestX = x;
+				bestY = y;
+			}
+		}
+
+		BlockList cells;
+		for (const BlockOffset& offset : best->offsets)
+		{
+			if (bestY + offset.y < 0)
+				return outcome;		// it sticks out above the board
+			cells.push_back(Point(bestX + offset.x, bestY + offset.y));
+		}
+		board.setContent(cells, static_cast<int>(Tetromino::getShapeColor(shape)));
+		outcome.steps++;
+
+		// the next shape spawns before the rows are removed (like TetrisEngine)
+		if (step + 1 < settings.depth)
+		{
+			shape = pieces.next();
+			if (!canSpawn(board, shape))
+				return outcome;
+		}
+		outcome.lines += board.removeCompletedRows();
+	}
+	return outcome;
+}
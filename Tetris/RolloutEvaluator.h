@@ -0,0 +1,113 @@
+// The RolloutEvaluator class scores candidate placements by Monte Carlo rollouts:
+// after each placement, it plays many short random futures (rollouts) & reports how
+// many rows they removed on average and how often they survived.
+//
+// A rollout places depth random shapes (picked by a PieceGenerator, like a game) with a
+// cheap default policy: a few random (rotation, column) hard drops are tried & the one
+// that lands lowest is taken.  The drops fall straight down from above the stack (no
+// slides or tucks), so a drop is found from the column heights in a few operations.
+// A rollout dies when a shape can't spawn (on the board before the completed rows are
+// removed, like TetrisEngine) or a drop sticks out above the board.
+//
+// Rollout r of every candidate gets its own deterministic random streams (derived from
+// the seed & r with Random::deriveSeed()), the same for every candidate: candidates are
+// compared on the same futures (which cancels much of the noise), and the results never
+// depend on the number of threads.  The rollouts are spread over a WorkStealingPool.
+// Each rollout plays on a copy of its candidate's board (a Gameboard is a plain value)
+// and writes its outcome to a preallocated slot, so rollouts don't allocate.
+
+#ifndef ROLLOUTEVALUATOR_H
+#define ROLLOUTEVALUATOR_H
+
+#include <cstdint>
+#include <vector>
+#include "Gameboard.h"
+#include "MoveGenerator.h"
+#include "PieceGenerator.h"
+#include "Random.h"
+#include "Tetromino.h"
+#include "WorkStealingPool.h"
+
+// how the rollouts are played
+struct RolloutSettings
+{
+	int rollouts{ 256 };				// the rollouts per candidate
+	int depth{ 10 };					// the shapes placed by each rollout
+	int dropsPerShape{ 4 };				// the random drops the default policy tries per shape
+	std::uint64_t seed{ 0 };			// the rollouts' random streams are derived from it
+	RandomizerPolicy randomizerPolicy{ RandomizerPolicy::UNIFORM };	// how the rollouts' shapes are picked
+};
+
+// the rollouts of one candidate placement
+struct RolloutResult
+{
+	int linesCleared;		// the rows the candidate placement itself removed
+	double meanLines;		// the rows removed per rollout, on average
+	double survivalRate;	// the fraction of rollouts that placed all their shapes
+};
+
+// everything an evaluation reports
+struct RolloutReport
+{
+	std::vector<RolloutResult> results;	// one per candidate, in the candidates' order
+	std::uint64_t steps;				// the shapes placed by every rollout
+	double seconds;						// the wall-clock time the evaluation took
+	double stepsPerSecond;
+	double stepsPerSecondPerThread;		// the throughput per core (the metric to compare)
+	int threads;
+};
+
+class RolloutEvaluator
+{
+private:
+	// a shape rotation's blocks, with their x range
+	struct ShapeRotation
+	{
+		BlockOffset offsets[Tetromino::BLOCK_COUNT];
+		int minX, maxX;
+	};
+
+	// the outcome of one rollout
+	struct Outcome
+	{
+		std::int32_t lines;
+		std::int32_t steps;		// the shapes placed (depth if it survived)
+	};
+
+	// MEMBER VARIABLES
+	WorkStealingPool pool;							// the worker threads
+	ShapeRotation rotations[Tetromino::SHAPE_COUNT][Tetromino::ROTATION_COUNT];
+	std::vector<Gameboard> candidateBoards;			// each candidate's board (after its placement)
+	std::vector<int> candidateLines;				// the rows each candidate placement removed
+	std::vector<bool> candidateAlive;				// false if the next shape can't spawn after the placement
+	std::vector<Outcome> outcomes;					// candidate c's rollout r is outcomes[c * rollouts + r]
+
+public:
+	// constructor, start the threads
+	// - param 1: the number of threads (0 to use every hardware thread)
+	explicit RolloutEvaluator(int threadCount = 0);
+
+	// roll out every candidate placement of a shape on a board
+	// - param 1: the board
+	// - param 2: the candidate placements (eg: MoveGenerator::getPlacements())
+	// - param 3: the shape placed after the candidates (the first shape of every
+	//            rollout, eg: the engine's next shape), or nullptr to pick it at random
+	// - param 4: the RolloutSettings
+	// - return: a RolloutReport
+	RolloutReport evaluate(const Gameboard& board, const std::vector<MoveGenerator::Placement>& candidates,
+		const TetShape* nextShape, const RolloutSettings& settings);
+
+	// the number of worker threads
+	int getThreadCount() const;
+
+private:
+	// play one rollout on a board (changed by the rollout)
+	// - param 1: the board
+	// - param 2: the first shape, or nullptr to pick it at random
+	// - param 3: the RolloutSettings
+	// - param 4: the rollout's index (its random streams)
+	// - return: the Outcome
+	Outcome rollout(Gameboard& board, const TetShape* firstShape, const RolloutSettings& settings, std::uint64_t index) const;
+};
+
+#endif /* ROLLOUTEVALUATOR_H */
@@ -16,7 +16,122 @@
 #include "GridTetromino.h"
 #endif
 
+#ifdef TETRISENGINE
+#include "TetrisEngine.h"
+#endif
+
+#ifdef PIECEGENERATOR
+#include "PieceGenerator.h"
+#include "TetrisEngine.h"
+#endif
+
+#ifdef BATCHSIMULATOR
+#include "BatchSimulator.h"
+#include "WorkStealingPool.h"
+#include <atomic>
+#include <vector>
+#endif
+
+#ifdef BATCHENVIRONMENT
+#include "BatchEnvironment.h"
+#include "TetrisEngine.h"
+#include <vector>
+#endif
+
+#ifdef MOVEGENERATOR
+#include "MoveGenerator.h"
+#include <vector>
+#endif
+
+#ifdef PERFT
+#include "Perft.h"
+#include <vector>
+#endif
+
+#ifdef AIPLAYER
+#include "AIPlayer.h"
+#include "BatchSimulator.h"
+#include <chrono>
+#endif
+
+#ifdef TRANSPOSITIONTABLE
+#include "AIPlayer.h"
+#include "Gameboard.h"
+#include "TranspositionTable.h"
+#include "WorkStealingPool.h"
+#include <atomic>
+#include <chrono>
+#endif
+
+#ifdef UNDOSTACK
+#include "Gameboard.h"
+#include "GamePolicy.h"
+#include "MoveGenerator.h"
+#include "Random.h"
+#include "TetrisEngine.h"
+#include "UndoStack.h"
+#include <cstring>
+#include <type_traits>
+#include <vector>
+#endif
+
+#ifdef ROLLOUTEVALUATOR
+#include "MoveGenerator.h"
+#include "RolloutEvaluator.h"
+#include <vector>
+#endif
+
+#ifdef TETRISENV
+#include "TetrisEngine.h"
+#include "TetrisEnv.h"
+#include <vector>
+#endif
+
+#ifdef FINESSEANALYZER
+#include "FinesseAnalyzer.h"
+#include "MoveGenerator.h"
+#include "TetrisEngine.h"
+#include <algorithm>
+#endif
+
+#ifdef REPLAY
+#include "AIPlayer.h"
+#include "GamePolicy.h"
+#include "Random.h"
+#include "Replay.h"
+#include "TetrisEngine.h"
+#include "Varint.h"
+#include <cstdio>
+#include <vector>
+#endif
+
+#ifdef REPLAYCORPUS
+#include "CorpusAnalyzer.h"
+#include "GamePolicy.h"
+#include "Random.h"
+#include "Replay.h"
+#include "ReplayCorpus.h"
+#include "TetrisEngine.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+#endif
+
+#ifdef REPLAYVERIFIER
+#include "GamePolicy.h"
+#include "Random.h"
+#include "Replay.h"
+#include "ReplayCorpus.h"
+#include "ReplayVerifier.h"
+#include "TetrisEngine.h"
+#include "Varint.h"
+#include <cstdio>
+#include <vector>
+#endif
+
 #include <cassert>
+#include <cstdlib>
 #include <iostream>
 #include <string>
 
@@ -31,6 +146,21 @@ void TestSuite::runTestSuite()
 	testTetrominoClass();
 	testGameboardClass();
 	testGridTetrominoClass();
+	testTetrisEngineClass();
+	testPieceGeneratorClass();
+	testBatchSimulatorClass();
+	testBatchEnvironmentClass();
+	testMoveGeneratorClass();
+	testPerftClass();
+	testAIPlayerClass();
+	testTranspositionTableClass();
+	testUndoStackClass();
+	testRolloutEvaluatorClass();
+	testTetrisEnvAPI();
+	testFinesseAnalyzerClass();
+	testReplayClass();
+	testReplayCorpusClass();
+	testReplayVerifierClass();
 	std::cout << "=== TestSuite complete ========================" << "\n\n";
 }
 
@@ -186,17 +316,41 @@ void TestSuite::testTetrominoClass()
 	assert(t.blockLocs.size() == blockcount && "Tetromino shape size should be 4");
 
 
-	// test the rotate functionality of a single block
-	t.blockLocs.clear();
-	t.blockLocs.push_back(Point(1, 2));
-	t.rotateClockwise();
-	assert(t.blockLocs[0].getX() == 2 && t.blockLocs[0].getY() == -1 && "Tetromino::rotateClockwise() failed");
-	t.rotateClockwise();
-	assert(t.blockLocs[0].getX() == -1 && t.blockLocs[0].getY() == -2 && "Tetromino::rotateClockwise() failed");
+	// test the rotate functionality: every block of every (non-O) shape should
+	// rotate clockwise around [0,0] ([1,2] -> [2,-1] -> [-1,-2] -> [-2,1] -> [1,2])
+	for (int shapeIndex = 0; shapeIndex < Tetromino::SHAPE_COUNT; shapeIndex++) {
+		TetShape shape = static_cast<TetShape>(shapeIndex);
+		t.setShape(shape);
+		assert(t.getRotation() == 0 && "Tetromino::setShape() should reset the rotation");
+		for (int turn = 1; turn <= 4; turn++) {
+			Tetromino before = t;
+			t.rotateClockwise();
+			for (int i = 0; i < blockcount; i++) {
+				if (shape == TetShape::O) {
+					assert(t.blockLocs[i].getX() == before.blockLocs[i].getX() &&
+						t.blockLocs[i].getY() == before.blockLocs[i].getY() && "Tetromino::rotateClockwise() O should not rotate");
+				}
+				else {
+					assert(t.blockLocs[i].getX() == before.blockLocs[i].getY() &&
+						t.blockLocs[i].getY() == -before.blockLocs[i].getX() && "Tetromino::rotateClockwise() failed");
+				}
+			}
+			assert(t.getRotation() == (shape == TetShape::O ? 0 : turn % 4) && "Tetromino::getRotation() unexpected rotation");
+		}
+	}
+
+	// test the rotation table matches the blockLocs of a rotated shape
+	t.setShape(TetShape::L);
 	t.rotateClockwise();
-	assert(t.blockLocs[0].getX() == -2 && t.blockLocs[0].getY() == 1 && "Tetromino::rotateClockwise() failed");
 	t.rotateClockwise();
-	assert(t.blockLocs[0].getX() == 1 && t.blockLocs[0].getY() == 2 && "Tetromino::rotateClockwise() failed");
+	const BlockOffset* offsets = Tetromino::getRotationOffsets(TetShape::L, 2);
+	for (int i = 0; i < blockcount; i++) {
+		assert(t.blockLocs[i].getX() == offsets[i].x && t.blockLocs[i].getY() == offsets[i].y &&
+			"Tetromino::getRotationOffsets() does not match the rotated shape");
+	}
+	t.setRotation(0);
+	assert(t.getRotation() == 0 && t.blockLocs[0].getX() == 0 && t.blockLocs[0].getY() == 1 &&
+		"Tetromino::setRotation() failed");
 
 	// ensure const methods are actually const
 	// These lines will cause compile time errors you have methods in your Tetromino class that
@@ -207,6 +361,7 @@ void TestSuite::testTetrominoClass()
 	cTetromino.printToConsole();
 	cTetromino.getColor();
 	cTetromino.getShape();
+	cTetromino.getRotation();
 
 	// Test const 
 	announceTestCompletion();
@@ -227,6 +382,35 @@ bool isGameboardEmpty(Gameboard& g)
 	}
 	return true;
 }
+
+// recompute the occupancy statistics of a board by scanning it and
+// compare them with the ones the board maintains incrementally.
+bool areGameboardStatsCorrect(const Gameboard& g)
+{
+	int totalHoles = 0;
+	int stackHeight = 0;
+	for (int x = 0; x < Gameboard::MAX_X; x++) {
+		int height = 0;
+		int holes = 0;
+		for (int y = 0; y < Gameboard::MAX_Y; y++) {
+			bool occupied = g.getContent(x, y) != Gameboard::EMPTY_BLOCK;
+			if (occupied && height == 0) { height = Gameboard::MAX_Y - y; }
+			if (!occupied && height != 0) { holes++; }
+		}
+		if (g.getColumnHeight(x) != height || g.getColumnHoleCount(x) != holes) { return false; }
+		totalHoles += holes;
+		if (height > stackHeight) { stackHeight = height; }
+	}
+	for (int y = 0; y < Gameboard::MAX_Y; y++) {
+		int count = 0;
+		for (int x = 0; x < Gameboard::MAX_X; x++) {
+			if (g.getContent(x, y) != Gameboard::EMPTY_BLOCK) { count++; }
+		}
+		if (g.getRowFillCount(y) != count) { return false; }
+	}
+	return g.getHoleCount() == totalHoles && g.getStackHeight() == stackHeight &&
+		g.getHighestOccupiedRow() == Gameboard::MAX_Y - stackHeight;
+}
 #endif
 
 
@@ -364,6 +548,24 @@ void TestSuite::testGameboardClass()
 	assert(g.getContent(1, 3) == 2 && "Gameboard.removeCompletedRows() unexpected results");	// row 2 copied into row 3
 	assert(g.getContent(1, 4) == Gameboard::EMPTY_BLOCK && "Gameboard.removeCompletedRows() unexpected results");	// row 4 is still empty
 
+	// test compactCompletedRows() - non adjacent rows, with the result mask
+	g.empty();
+	for (int y = 10; y < Gameboard::MAX_Y; y++) {
+		g.fillRow(y, y % 7);
+	}
+	g.setContent(0, 12, Gameboard::EMPTY_BLOCK);	// rows 10, 11, 13 - 18 are completed, 12 isn't
+	g.setContent(0, 15, Gameboard::EMPTY_BLOCK);	// now 15 isn't either
+	g.setContent(4, 3, 1);							// a lone block above the stack
+	Gameboard::RowClearResult cleared = g.compactCompletedRows();
+	assert(cleared.count == 7 && "Gameboard.compactCompletedRows() should remove 7 rows");
+	assert(cleared.rowMask == ((1u << 10) | (1u << 11) | (1u << 13) | (1u << 14) | (1u << 16) | (1u << 17) | (1u << 18)) &&
+		"Gameboard.compactCompletedRows() unexpected row mask");
+	assert(g.getContent(1, Gameboard::MAX_Y - 1) == 15 % 7 && g.getContent(0, Gameboard::MAX_Y - 1) == Gameboard::EMPTY_BLOCK &&
+		"Gameboard.compactCompletedRows() row 15 should be the bottom row");
+	assert(g.getContent(1, Gameboard::MAX_Y - 2) == 12 % 7 && "Gameboard.compactCompletedRows() row 12 should be above row 15");
+	assert(g.isOccupied(4, 10) && g.getRowMask(3) == 0 && "Gameboard.compactCompletedRows() the lone block should drop 7 rows");
+	assert(g.compactCompletedRows().count == 0 && "Gameboard.compactCompletedRows() nothing left to remove");
+
 
 	// test areLocsEmpty()
 	g.empty();
@@ -390,6 +592,83 @@ void TestSuite::testGameboardClass()
 	std::vector<Point> mixedPoints2 = { Point(-3,-20), Point(200, 23), Point(6, 6), Point(3,3) };
 	assert(g.areAllLocsEmpty(mixedPoints2) == false && "Gameboard.areAllLocsEmpty() expected false but was true");
 
+	// test isOccupied() & getRowMask() - the row masks should follow the content
+	g.empty();
+	g.setContent(3, 5, 4);
+	assert(g.isOccupied(3, 5) == true && "Gameboard.isOccupied() expected true but was false");
+	assert(g.isOccupied(4, 5) == false && "Gameboard.isOccupied() expected false but was true");
+	assert(g.isOccupied(-1, 50) == false && "Gameboard.isOccupied() invalid points should not be occupied");
+	assert(g.getRowMask(5) == (1 << 3) && "Gameboard.getRowMask() unexpected mask");
+	g.setContent(3, 5, Gameboard::EMPTY_BLOCK);
+	assert(g.getRowMask(5) == 0 && "Gameboard.getRowMask() clearing content should clear the mask");
+	g.fillRow(6, 2);
+	assert(g.getRowMask(6) == Gameboard::FULL_ROW_MASK && "Gameboard.getRowMask() a filled row should be FULL_ROW_MASK");
+	g.copyRowIntoRow(6, 7);
+	assert(g.getRowMask(7) == Gameboard::FULL_ROW_MASK && g.getContent(9, 7) == 2 &&
+		"Gameboard.copyRowIntoRow() should copy the row mask and content");
+
+	// test the occupancy statistics (column heights, holes, row fill counts)
+	g.empty();
+	assert(g.getStackHeight() == 0 && g.getHoleCount() == 0 && g.getHighestOccupiedRow() == Gameboard::MAX_Y &&
+		"Gameboard statistics of an empty board should be 0");
+	g.setContent(2, 10, 1);			// column 2 is 9 high with 8 holes under it
+	assert(g.getColumnHeight(2) == 9 && g.getColumnHoleCount(2) == 8 && g.getHoleCount() == 8 &&
+		"Gameboard statistics unexpected column height/holes");
+	g.setContent(2, 18, 1);
+	assert(g.getColumnHoleCount(2) == 7 && g.getRowFillCount(18) == 1 && "Gameboard statistics unexpected holes/fill count");
+	g.setContent(2, 10, Gameboard::EMPTY_BLOCK);	// the column top goes, the column is 1 high again
+	assert(g.getColumnHeight(2) == 1 && g.getHoleCount() == 0 && g.getStackHeight() == 1 &&
+		"Gameboard statistics removing the top block should lower the column");
+	// shuffle content around with every kind of change and check the statistics each time
+	srand(1234);
+	for (int i = 0; i < 2000; i++) {
+		int op = rand() % 10;
+		if (op < 7) { g.setContent(rand() % Gameboard::MAX_X, rand() % Gameboard::MAX_Y, (rand() % 3) ? rand() % 7 : Gameboard::EMPTY_BLOCK); }
+		else if (op == 7) { g.fillRow(rand() % Gameboard::MAX_Y, (rand() % 2) ? 3 : Gameboard::EMPTY_BLOCK); }
+		else if (op == 8) { g.copyRowIntoRow(rand() % Gameboard::MAX_Y, rand() % Gameboard::MAX_Y); }
+		else { g.removeCompletedRows(); }
+		assert(areGameboardStatsCorrect(g) && "Gameboard statistics are out of date");
+	}
+
+	// test getDropDistance() against dropping a set of locations one row at a time
+	g.empty();
+	BlockList dropLocs = { Point(4, -1), Point(4, 0), Point(5, 0), Point(5, 1) };	// an S/Z-like shape
+	assert(g.getDropDistance(dropLocs) == Gameboard::MAX_Y - 2 && "Gameboard.getDropDistance() should drop to the floor");
+	g.setContent(4, 10, 1);
+	assert(g.getDropDistance(dropLocs) == 9 && "Gameboard.getDropDistance() should land on the block in column 4");
+	for (int i = 0; i < 500; i++) {
+		g.empty();
+		for (int n = rand() % 40; n > 0; n--) {
+			g.setContent(rand() % Gameboard::MAX_X, 4 + rand() % (Gameboard::MAX_Y - 4), 1);
+		}
+		int x = rand() % (Gameboard::MAX_X - 2);
+		int y = -2 + rand() % 4;
+		BlockList locs = { Point(x, y), Point(x + 1, y), Point(x + 2, y), Point(x, y + 1) };	// an L/J-like shape
+		int expected = 0;
+		while (true) {
+			BlockList moved;
+			for (const Point& p : locs) { moved.push_back(Point(p.getX(), p.getY() + expected + 1)); }
+			bool legal = g.areAllLocsEmpty(moved);
+			for (const Point& p : moved) { legal = legal && p.getY() < Gameboard::MAX_Y; }
+			if (!legal) { break; }
+			expected++;
+		}
+		assert(g.getDropDistance(locs) == expected && "Gameboard.getDropDistance() unexpected distance");
+	}
+
+	// test getGeneration() - every content change should bump it
+	g.empty();
+	unsigned int generation = g.getGeneration();
+	assert(generation != 0 && "Gameboard.getGeneration() a constructed board should not be at generation 0");
+	g.setContent(1, 1, 1);
+	assert(g.getGeneration() != generation && "Gameboard.getGeneration() setContent() did not bump the generation");
+	generation = g.getGeneration();
+	g.setContent(-1, -1, 1);
+	assert(g.getGeneration() == generation && "Gameboard.getGeneration() an ignored setContent() bumped the generation");
+	g.fillRow(Gameboard::MAX_Y - 1, 1);
+	g.removeCompletedRows();
+	assert(g.getGeneration() != generation && "Gameboard.getGeneration() removing rows did not bump the generation");
+
 	// lastly do a visual printout of an empty board
 	g.empty();
 	g.printToConsole();
@@ -472,6 +751,10 @@ void TestSuite::testGameboardClass()
 	std::vector<Point> locs = gt.getBlockLocsMappedToGrid();
 	assert(locs[0].getX() == 6 && locs[0].getY() == 7);
 
+	// test getMappedBlockLocs() (the non-allocating version) maps the same way
+	BlockList mappedLocs = gt.getMappedBlockLocs();
+	assert(mappedLocs.size() == 1 && mappedLocs[0].getX() == 6 && mappedLocs[0].getY() == 7);
+
 	// A const gridTetromino should be able to call the following methods
 	// (since these methods don't change the state of the class)
 	// If these stop you from compiling, it is because you haven't labelled these
@@ -479,6 +762,7 @@ void TestSuite::testGameboardClass()
 	const GridTetromino gt2;
 	gt2.getGridLoc();
 	gt2.getBlockLocsMappedToGrid();
+	gt2.getMappedBlockLocs();
 
 	// a gridTetromino should still be able to access methods from the Tetromino class.
 	gt2.getColor();
@@ -491,5 +775,1435 @@ void TestSuite::testGameboardClass()
 
 
 
+void TestSuite::testTetrisEngineClass()
+{
+#ifdef TETRISENGINE
+	announceTest("TetrisEngine");
+
+	TetrisEngine engine;
+
+	// a new game starts empty, with the current shape at the spawn location
+	assert(engine.getScore() == 0 && engine.getLinesCleared() == 0 && engine.getPlacementCount() == 0 &&
+		"TetrisEngine ctor - game not reset");
+	assert(engine.isGameOver() == false && "TetrisEngine ctor - a new game should not be over");
+	assert(engine.getBoard().getStackHeight() == 0 && "TetrisEngine ctor - the board should be empty");
+	assert(engine.getCurrentShape().getGridLoc().getX() == Gameboard::MAX_X / 2 &&
+		engine.getCurrentShape().getGridLoc().getY() == 0 && "TetrisEngine ctor - shape not at the spawn location");
+
+	// moving left and right
+	int x = engine.getCurrentShape().getGridLoc().getX();
+	assert(engine.applyAction(GameAction::MOVE_LEFT) && engine.getCurrentShape().getGridLoc().getX() == x - 1 &&
+		"TetrisEngine::applyAction() MOVE_LEFT failed");
+	assert(engine.applyAction(GameAction::MOVE_RIGHT) && engine.getCurrentShape().getGridLoc().getX() == x &&
+		"TetrisEngine::applyAction() MOVE_RIGHT failed");
+	for (int i = 0; i < Gameboard::MAX_X; i++) {
+		engine.applyAction(GameAction::MOVE_LEFT);
+	}
+	for (const Point& p : engine.getCurrentShape().getMappedBlockLocs()) {
+		assert(p.getX() >= 0 && "TetrisEngine::applyAction() moved the shape through the left border");
+	}
+
+	// a tick moves the shape down one line once enough frames passed
+	int y = engine.getCurrentShape().getGridLoc().getY();
+	assert(engine.step(TetrisEngine::MAX_FRAMES_PER_TICK - 1) == TetrisEngine::MAX_FRAMES_PER_TICK - 1 &&
+		engine.getFrame() == TetrisEngine::MAX_FRAMES_PER_TICK - 1 && "TetrisEngine::step() wrong frame count");
+	assert(engine.getCurrentShape().getGridLoc().getY() == y && "TetrisEngine::step() ticked too early");
+	engine.step(1);
+	assert(engine.getCurrentShape().getGridLoc().getY() == y + 1 && "TetrisEngine::step() did not tick");
+
+	// a hard drop lands where the ghost is, and the placement is processed next game loop
+	GridTetromino ghost = engine.getGhostShape();
+	engine.applyAction(GameAction::HARD_DROP);
+	for (const Point& p : ghost.getMappedBlockLocs()) {
+		assert(engine.getBoard().isOccupied(p.getX(), p.getY()) && "TetrisEngine::applyAction() HARD_DROP did not lock at the ghost");
+	}
+	engine.stepFrame();
+	assert(engine.getPlacementCount() == 1 && engine.getScore() == 1 && "TetrisEngine::stepFrame() placement not processed");
+
+	// keep dropping shapes in the middle: the game has to end
+	int placements = 1;
+	while (!engine.isGameOver() && placements < 1000) {
+		engine.applyAction(GameAction::HARD_DROP);
+		engine.stepFrame();
+		placements++;
+	}
+	assert(engine.isGameOver() && "TetrisEngine - stacking in the middle should end the game");
+	assert(engine.applyAction(GameAction::MOVE_LEFT) == false && "TetrisEngine - actions should be ignored once the game is over");
+
+	// score for cleared rows
+	assert(TetrisEngine::getScoreForRows(0) == 1 && TetrisEngine::getScoreForRows(4) == 1200 &&
+		"TetrisEngine::getScoreForRows() unexpected score");
+
+	engine.reset();
+	assert(engine.isGameOver() == false && engine.getScore() == 0 && engine.getBoard().getStackHeight() == 0 &&
+		engine.getFrame() == 0 && "TetrisEngine::reset() failed");
+
+	// queued actions happen at their exact frame, never in the past
+	x = engine.getCurrentShape().getGridLoc().getX();
+	assert(engine.queueAction(10, GameAction::MOVE_RIGHT) && engine.queueAction(5, GameAction::MOVE_LEFT) &&
+		engine.queueAction(5, GameAction::MOVE_LEFT) && "TetrisEngine::queueAction() failed");
+	engine.step(5);
+	assert(engine.getCurrentShape().getGridLoc().getX() == x && "TetrisEngine::step() applied an action too early");
+	engine.step(1);
+	assert(engine.getCurrentShape().getGridLoc().getX() == x - 2 && "TetrisEngine::step() did not apply the queued actions");
+	assert(engine.queueAction(3, GameAction::HARD_DROP) == false && "TetrisEngine::queueAction() queued in the past");
+	engine.step(5);
+	assert(engine.getCurrentShape().getGridLoc().getX() == x - 1 && "TetrisEngine::step() did not apply the queued action");
+
+	// step(n) (with its quiet frame skipping) plays exactly like n stepFrame() calls, and the
+	// same seed & inputs always give the same game
+	TetrisEngine stepped(5, RandomizerPolicy::SEVEN_BAG);
+	TetrisEngine framed(5, RandomizerPolicy::SEVEN_BAG);
+	const GameAction actions[] = { GameAction::MOVE_LEFT, GameAction::MOVE_RIGHT, GameAction::ROTATE,
+		GameAction::SOFT_DROP, GameAction::HARD_DROP, GameAction::NONE };
+	srand(321);
+	std::int64_t inputFrame = 0;
+	for (int i = 0; i < 2000; i++) {
+		inputFrame += rand() % 40;
+		GameAction action = actions[rand() % 6];
+		stepped.queueAction(inputFrame, action);
+		framed.queueAction(inputFrame, action);
+	}
+	while (!stepped.isGameOver()) {
+		int frames = 1 + rand() % 100;
+		int ran = stepped.step(frames);
+		for (int i = 0; i < ran; i++) {
+			assert(framed.stepFrame() && "TetrisEngine::step() ran more frames than stepFrame()");
+		}
+		assert(stepped.getFrame() == framed.getFrame() && stepped.getScore() == framed.getScore() &&
+			stepped.getPlacementCount() == framed.getPlacementCount() &&
+			stepped.getCurrentShape().getGridLoc().getY() == framed.getCurrentShape().getGridLoc().getY() &&
+			"TetrisEngine::step() differs from stepFrame()");
+		for (int row = 0; row < Gameboard::MAX_Y; row++) {
+			assert(stepped.getBoard().getRowMask(row) == framed.getBoard().getRowMask(row) &&
+				"TetrisEngine::step() board differs from stepFrame()");
+		}
+	}
+	assert(framed.isGameOver() && stepped.step(10) == 0 && "TetrisEngine::step() ran frames after the game ended");
+
+	announceTestCompletion();
+#else
+	announceNotTested("TetrisEngine");
+#endif
+}
+
+void TestSuite::testPieceGeneratorClass()
+{
+#ifdef PIECEGENERATOR
+	announceTest("PieceGenerator");
+
+	const RandomizerPolicy policies[] = {
+		RandomizerPolicy::UNIFORM, RandomizerPolicy::SEVEN_BAG, RandomizerPolicy::BAG_WITH_HISTORY };
+	const int PIECES{ 7 * 1000 };
+
+	for (RandomizerPolicy policy : policies) {
+		// the same seed deals the same shapes, every shape is valid & every shape shows up
+		PieceGenerator a(42, policy);
+		PieceGenerator b(42, policy);
+		PieceGenerator c(43, policy);
+		int counts[Tetromino::SHAPE_COUNT]{};
+		bool sameAsOtherSeed = true;
+		for (int i = 0; i < PIECES; i++) {
+			TetShape shape = a.next();
+			assert(shape == b.next() && "PieceGenerator - the same seed should deal the same shapes");
+			if (shape != c.next())
+				sameAsOtherSeed = false;
+			assert(static_cast<int>(shape) >= 0 && static_cast<int>(shape) < Tetromino::SHAPE_COUNT &&
+				"PieceGenerator::next() - invalid shape");
+			counts[static_cast<int>(shape)]++;
+		}
+		assert(!sameAsOtherSeed && "PieceGenerator - different seeds should deal different shapes");
+		for (int count : counts) {
+			assert(count > PIECES / Tetromino::SHAPE_COUNT / 2 && "PieceGenerator::next() - a shape is (nearly) never dealt");
+		}
+
+		// re-seeding restarts the sequence, and a copy forks the stream
+		PieceGenerator d(42, policy);
+		d.seed(42);
+		a.seed(42);
+		PieceGenerator copy = a;
+		for (int i = 0; i < 100; i++) {
+			TetShape shape = a.next();
+			assert(shape == d.next() && shape == copy.next() && "PieceGenerator::seed() - sequence did not restart");
+		}
+	}
+
+	// SEVEN_BAG deals every shape exactly once per bag of 7
+	PieceGenerator bag(7, RandomizerPolicy::SEVEN_BAG);
+	for (int b = 0; b < 1000; b++) {
+		bool seen[Tetromino::SHAPE_COUNT]{};
+		for (int i = 0; i < Tetromino::SHAPE_COUNT; i++) {
+			int shape = static_cast<int>(bag.next());
+			assert(!seen[shape] && "PieceGenerator SEVEN_BAG - a shape was dealt twice in one bag");
+			seen[shape] = true;
+		}
+	}
+
+	// BAG_WITH_HISTORY rarely repeats a shape back to back
+	PieceGenerator history(7, RandomizerPolicy::BAG_WITH_HISTORY);
+	int repeats = 0;
+	TetShape last = history.next();
+	for (int i = 0; i < PIECES; i++) {
+		TetShape shape = history.next();
+		if (shape == last)
+			repeats++;
+		last = shape;
+	}
+	assert(repeats < PIECES / 50 && "PieceGenerator BAG_WITH_HISTORY - too many back to back repeats");
+
+	// engines with the same seed play the same shapes, reset(seed) replays them
+	TetrisEngine e1(99, RandomizerPolicy::SEVEN_BAG);
+	TetrisEngine e2(99, RandomizerPolicy::SEVEN_BAG);
+	TetShape shapes[50];
+	for (int i = 0; i < 50; i++) {
+		shapes[i] = e1.getNextShape().getShape();
+		assert(shapes[i] == e2.getNextShape().getShape() && "TetrisEngine - the same seed should deal the same shapes");
+		e1.applyAction(GameAction::HARD_DROP);
+		e1.stepFrame();
+		e2.applyAction(GameAction::HARD_DROP);
+		e2.stepFrame();
+		if (e1.isGameOver()) {
+			e1.reset();
+			e2.reset();
+		}
+	}
+	e1.reset(99);
+	assert(e1.getSeed() == 99 && e1.getRandomizerPolicy() == RandomizerPolicy::SEVEN_BAG && "TetrisEngine::reset(seed) failed");
+	for (int i = 0; i < 50 && !e1.isGameOver(); i++) {
+		assert(e1.getNextShape().getShape() == shapes[i] && "TetrisEngine::reset(seed) - shapes not replayed");
+		e1.applyAction(GameAction::HARD_DROP);
+		e1.stepFrame();
+	}
+
+	announceTestCompletion();
+#else
+	announceNotTested("PieceGenerator");
+#endif
+}
+
+void TestSuite::testBatchSimulatorClass()
+{
+#ifdef BATCHSIMULATOR
+	announceTest("BatchSimulator");
+
+	// every iteration runs exactly once, on a valid worker, and the pool can be reused
+	WorkStealingPool pool(4);
+	assert(pool.getThreadCount() == 4 && "WorkStealingPool ctor - wrong thread count");
+	for (int grain : { 1, 3, 1000 }) {
+		std::vector<std::atomic<int>> runs(1000);
+		for (std::atomic<int>& r : runs) {
+			r = 0;
+		}
+		pool.parallelFor(1000, [&](std::int64_t index, int worker) {
+			assert(worker >= 0 && worker < 4 && "WorkStealingPool::parallelFor() - invalid worker index");
+			runs[index]++;
+		}, grain);
+		for (std::atomic<int>& r : runs) {
+			assert(r == 1 && "WorkStealingPool::parallelFor() - an iteration did not run exactly once");
+		}
+	}
+
+	// a batch is reproducible, whatever the number of threads
+	auto makePolicy = [] { return std::unique_ptr<GamePolicy>(new RandomPolicy()); };
+	BatchSimulator single(makePolicy, 1);
+	BatchSimulator multi(makePolicy, 4);
+	BatchReport a = single.run(1000, 40);
+	BatchReport b = multi.run(1000, 40);
+	assert(a.games == 40 && a.results.size() == 40 && b.threads == 4 && "BatchSimulator::run() - wrong game count");
+	for (int i = 0; i < 40; i++) {
+		assert(a.results[i].seed == static_cast<std::uint64_t>(1000 + i) && "BatchSimulator::run() - results not in seed order");
+		assert(a.results[i].score == b.results[i].score && a.results[i].placements == b.results[i].placements &&
+			a.results[i].frames == b.results[i].frames && "BatchSimulator::run() - a game depends on the thread count");
+		assert(a.results[i].placements > 0 && "BatchSimulator::run() - a game placed nothing");
+	}
+	assert(a.score.mean == b.score.mean && a.frames.max == b.frames.max && "BatchSimulator::run() - summaries differ");
+	assert(a.placements.min <= a.placements.median && a.placements.median <= a.placements.max &&
+		"BatchSimulator::run() - bad distribution");
+
+	// a piece limit stops every game early
+	BatchSimulator limited(makePolicy, 2, RandomizerPolicy::SEVEN_BAG, 3);
+	BatchReport c = limited.run(0, 10);
+	assert(c.placements.max <= 3 && "BatchSimulator::run() - maxPlacements ignored");
+
+	// the distribution summary
+	std::vector<std::int64_t> values{ 5, 1, 4, 2, 3, 6, 7, 8, 9, 10 };
+	Distribution d = Distribution::of(values);
+	assert(d.min == 1 && d.max == 10 && d.median == 5 && d.p10 == 1 && d.p90 == 9 && d.mean == 5.5 &&
+		"Distribution::of() - wrong summary");
+
+	announceTestCompletion();
+#else
+	announceNotTested("BatchSimulator");
+#endif
+}
+
+void TestSuite::testBatchEnvironmentClass()
+{
+#ifdef BATCHENVIRONMENT
+	announceTest("BatchEnvironment");
+
+	// every game of the batch plays exactly like a TetrisEngine given the same seed & actions
+	const int GAMES{ 64 };
+	BatchEnvironment batch(GAMES, RandomizerPolicy::SEVEN_BAG, 500);
+	std::vector<TetrisEngine> engines;
+	for (int i = 0; i < GAMES; i++) {
+		engines.push_back(TetrisEngine(500 + i, RandomizerPolicy::SEVEN_BAG));
+	}
+	assert(batch.getGameCount() == GAMES && "BatchEnvironment ctor - wrong game count");
+
+	const GameAction choices[] = { GameAction::NONE, GameAction::NONE, GameAction::MOVE_LEFT, GameAction::MOVE_RIGHT,
+		GameAction::ROTATE, GameAction::SOFT_DROP, GameAction::HARD_DROP };
+	std::vector<GameAction> actions(GAMES);
+	srand(777);
+	int resets = 0;
+	for (int frame = 0; frame < 3000; frame++) {
+		for (int i = 0; i < GAMES; i++) {
+			actions[i] = choices[rand() % 7];
+			engines[i].applyAction(actions[i]);
+			engines[i].stepFrame();
+		}
+		batch.step(actions);
+
+		for (int i = 0; i < GAMES; i++) {
+			const TetrisEngine& e = engines[i];
+			assert(batch.getScores()[i] == e.getScore() && batch.getLinesCleared()[i] == e.getLinesCleared() &&
+				batch.getPlacementCounts()[i] == e.getPlacementCount() && batch.getFrames()[i] == e.getFrame() &&
+				(batch.getGameOver()[i] != 0) == e.isGameOver() && "BatchEnvironment::step() - game differs from TetrisEngine");
+			assert(batch.getCurrentShapes()[i] == static_cast<int>(e.getCurrentShape().getShape()) &&
+				batch.getRotations()[i] == e.getCurrentShape().getRotation() &&
+				batch.getShapeX()[i] == e.getCurrentShape().getGridLoc().getX() &&
+				batch.getShapeY()[i] == e.getCurrentShape().getGridLoc().getY() &&
+				batch.getNextShapes()[i] == static_cast<int>(e.getNextShape().getShape()) &&
+				"BatchEnvironment::step() - shape differs from TetrisEngine");
+
+			const std::uint8_t* observation = batch.getObservations() + i * BatchEnvironment::OBSERVATION_SIZE;
+			for (int y = 0; y < Gameboard::MAX_Y; y++) {
+				assert(batch.getRowMasks()[i * Gameboard::MAX_Y + y] == e.getBoard().getRowMask(y) &&
+					"BatchEnvironment::step() - board differs from TetrisEngine");
+				for (int x = 0; x < Gameboard::MAX_X; x++) {
+					assert((observation[y * Gameboard::MAX_X + x] == BatchEnvironment::OBSERVATION_LOCKED) ==
+						e.getBoard().isOccupied(x, y) && "BatchEnvironment::getObservations() - wrong locked cell");
+				}
+			}
+			if (!e.isGameOver()) {
+				for (const Point& p : e.getCurrentShape().getMappedBlockLocs()) {
+					assert((p.getY() < 0 || observation[p.getY() * Gameboard::MAX_X + p.getX()] == BatchEnvironment::OBSERVATION_FALLING) &&
+						"BatchEnvironment::getObservations() - falling shape not observed");
+				}
+			}
+
+			// start over the games that ended
+			if (e.isGameOver()) {
+				engines[i].reset(frame);
+				batch.reset(i, frame);
+				resets++;
+			}
+		}
+	}
+	assert(resets > 0 && "BatchEnvironment - no game ended, the test did not cover game over");
+
+	announceTestCompletion();
+#else
+	announceNotTested("BatchEnvironment");
+#endif
+}
+
+#ifdef MOVEGENERATOR
+// true if a shape is within the left, right & bottom borders, on empty cells
+bool isShapeLegal(const Gameboard& board, const GridTetromino& shape)
+{
+	for (const Point& p : shape.getMappedBlockLocs()) {
+		if (p.getX() < 0 || p.getX() >= Gameboard::MAX_X || p.getY() >= Gameboard::MAX_Y || board.isOccupied(p.getX(), p.getY()))
+			return false;
+	}
+	return true;
+}
+
+// play a path of actions (every action must be legal), return where the shape locks
+GridTetromino playPath(const Gameboard& board, GridTetromino shape, const std::vector<GameAction>& path)
+{
+	for (GameAction action : path) {
+		GridTetromino moved = shape;
+		switch (action) {
+		case GameAction::MOVE_LEFT: moved.move(-1, 0); break;
+		case GameAction::MOVE_RIGHT: moved.move(1, 0); break;
+		case GameAction::ROTATE: moved.rotateClockwise(); break;
+		case GameAction::SOFT_DROP: moved.move(0, 1); break;
+		case GameAction::HARD_DROP: moved.move(0, board.getDropDistance(moved.getMappedBlockLocs())); break;
+		default: assert(false && "MoveGenerator::getPath() - unexpected action");
+		}
+		assert(isShapeLegal(board, moved) && "MoveGenerator::getPath() - illegal action in the path");
+		shape = moved;
+	}
+	assert(path.back() == GameAction::HARD_DROP && "MoveGenerator::getPath() - path does not end with a hard drop");
+	return shape;
+}
+
+// check every placement: its path reaches it, it rests, and no two cover the same cells
+void checkPlacements(const MoveGenerator& generator, const Gameboard& board, const GridTetromino& start)
+{
+	std::vector<GameAction> path;
+	std::vector<BlockList> seen;
+	for (const MoveGenerator::Placement& placement : generator.getPlacements()) {
+		GridTetromino placed = MoveGenerator::toGridTetromino(placement);
+		assert(isShapeLegal(board, placed) && "MoveGenerator - illegal placement");
+		GridTetromino lower = placed;
+		lower.move(0, 1);
+		assert(!isShapeLegal(board, lower) && "MoveGenerator - placement is not resting");
+
+		generator.getPath(placement, path);
+		assert(static_cast<int>(path.size()) == placement.pathLength && "MoveGenerator::getPath() - wrong length");
+		GridTetromino played = playPath(board, start, path);
+		assert(played.getGridLoc().getX() == placement.x && played.getGridLoc().getY() == placement.y &&
+			played.getRotation() == placement.rotation && "MoveGenerator::getPath() - path does not reach the placement");
+
+		// compare the covered cells with every other placement's
+		BlockList cells = placed.getMappedBlockLocs();
+		for (const BlockList& other : seen) {
+			int same = 0;
+			for (const Point& a : cells) {
+				for (const Point& b : other) {
+					same += (a.getX() == b.getX() && a.getY() == b.getY());
+				}
+			}
+			assert(same < Tetromino::BLOCK_COUNT && "MoveGenerator - duplicate placement");
+		}
+		seen.push_back(cells);
+	}
+}
+#endif
+
+void TestSuite::testMoveGeneratorClass()
+{
+#ifdef MOVEGENERATOR
+	announceTest("MoveGenerator");
+
+	MoveGenerator generator;
+	Gameboard board;
+	board.empty();
+
+	// on an empty board, from the spawn location: every column & distinct rotation
+	const int expected[Tetromino::SHAPE_COUNT] = { 17, 17, 34, 34, 9, 17, 34 };	// S Z L J O I T
+	for (int s = 0; s < Tetromino::SHAPE_COUNT; s++) {
+		GridTetromino start;
+		start.setShape(static_cast<TetShape>(s));
+		start.setGridLoc(board.getSpawnLoc());
+		assert(generator.generate(board, start) == expected[s] && "MoveGenerator::generate() - wrong empty board count");
+		checkPlacements(generator, board, start);
+	}
+
+	// under an overhang: row 17 is a roof over an empty row 18 (columns 0-5), only a
+	// horizontal I that slides under the roof can reach the bottom left corner
+	for (int x = 0; x < 6; x++) {
+		board.setContent(x, 17, 1);
+	}
+	GridTetromino start;
+	start.setShape(TetShape::I);
+	start.setGridLoc(board.getSpawnLoc());
+	generator.generate(board, start);
+	checkPlacements(generator, board, start);
+	bool tucked = false;
+	for (const MoveGenerator::Placement& placement : generator.getPlacements()) {
+		for (const Point& p : MoveGenerator::toGridTetromino(placement).getMappedBlockLocs()) {
+			if (p.getX() == 0 && p.getY() == 18)
+				tucked = true;
+		}
+	}
+	assert(tucked && "MoveGenerator::generate() - the slide under the overhang was not found");
+
+	// random boards: every placement is valid & reachable
+	srand(99);
+	for (int i = 0; i < 200; i++) {
+		board.empty();
+		for (int y = 8; y < Gameboard::MAX_Y; y++) {
+			for (int x = 0; x < Gameboard::MAX_X; x++) {
+				if (rand() % 100 < 40)
+					board.setContent(x, y, 1);
+			}
+		}
+		GridTetromino randomStart;
+		randomStart.setShape(static_cast<TetShape>(rand() % Tetromino::SHAPE_COUNT));
+		randomStart.setGridLoc(board.getSpawnLoc());
+		generator.generate(board, randomStart);
+		checkPlacements(generator, board, randomStart);
+	}
+
+	// a start that isn't legal has no placements
+	board.setContent(board.getSpawnLoc(), 1);
+	assert(generator.generate(board, start) == 0 && "MoveGenerator::generate() - placements from an illegal start");
+
+	announceTestCompletion();
+#else
+	announceNotTested("MoveGenerator");
+#endif
+}
+
+void TestSuite::testPerftClass()
+{
+#ifdef PERFT
+	announceTest("Perft");
+
+	// reference counts: if a change to the move generator or the board updates changes
+	// one of these, the change is wrong (or the reference has to be re-derived & justified)
+	const std::vector<TetShape> shapes{ TetShape::I, TetShape::O, TetShape::T, TetShape::S, TetShape::Z, TetShape::L, TetShape::J };
+	Gameboard empty;
+	empty.empty();
+
+	Perft single(1);
+	Perft multi(4);
+	const std::uint64_t expectedLeaves[] = { 17, 153, 5264, 94477 };
+	const std::uint64_t expectedNodes[] = { 17, 170, 5434, 99911 };
+	for (int depth = 1; depth <= 4; depth++) {
+		PerftResult a = single.run(empty, shapes, depth, depth <= 3);
+		PerftResult b = multi.run(empty, shapes, depth, depth <= 3);
+		assert(a.leaves == expectedLeaves[depth - 1] && a.nodes == expectedNodes[depth - 1] &&
+			"Perft::run() - empty board count differs from the reference");
+		assert(b.leaves == a.leaves && b.nodes == a.nodes && b.distinctBoards == a.distinctBoards &&
+			"Perft::run() - counts depend on the thread count");
+		assert((depth > 3 || a.distinctBoards == a.leaves) && "Perft::run() - wrong distinct board count");
+		assert(a.leavesPerRootPlacement.size() == 17 && "Perft::run() - wrong number of root placements");
+	}
+
+	// two O's side by side (2+ columns apart) make the same board in either order:
+	// 9 stacked + 28 apart + 16 overlapping by a column (which differ by order)
+	PerftResult twoOs = multi.run(empty, { TetShape::O, TetShape::O }, 2, true);
+	assert(twoOs.leaves == 81 && twoOs.distinctBoards == 53 && "Perft::run() - wrong O, O counts");
+
+	// a well in the last column: the I that fills it removes 4 rows
+	Gameboard well;
+	well.empty();
+	for (int y = 15; y < Gameboard::MAX_Y; y++) {
+		for (int x = 0; x < Gameboard::MAX_X - 1; x++) {
+			well.setContent(x, y, 1);
+		}
+	}
+	PerftResult wellResult = multi.run(well, { TetShape::I, TetShape::O, TetShape::T }, 3, true);
+	assert(wellResult.leaves == 5260 && wellResult.nodes == 5430 && wellResult.distinctBoards == 5260 &&
+		"Perft::run() - well board count differs from the reference");
+
+	announceTestCompletion();
+#else
+	announceNotTested("Perft");
+#endif
+}
+
+void TestSuite::testAIPlayerClass()
+{
+#ifdef AIPLAYER
+	announceTest("AIPlayer");
+
+	// one feature at a time
+	EvaluationWeights heightOnly{ 1, 0, 0, 0, 0 };
+	EvaluationWeights holesOnly{ 0, 1, 0, 0, 0 };
+	EvaluationWeights bumpinessOnly{ 0, 0, 1, 0, 0 };
+	EvaluationWeights wellsOnly{ 0, 0, 0, 1, 0 };
+	EvaluationWeights linesOnly{ 0, 0, 0, 0, 1 };
+
+	Gameboard board;
+	board.empty();
+	assert(AIPlayer::evaluate(board, 0, heightOnly) == 0 && AIPlayer::evaluate(board, 0, holesOnly) == 0 &&
+		AIPlayer::evaluate(board, 0, bumpinessOnly) == 0 && "AIPlayer::evaluate() - an empty board has no features");
+	assert(AIPlayer::evaluate(board, 3, linesOnly) == 3 && "AIPlayer::evaluate() - wrong completed lines");
+
+	// column 0: 3 high (with a hole), column 2: 1 high, column 1 is a well 1 deep
+	board.setContent(0, Gameboard::MAX_Y - 3, 1);
+	board.setContent(0, Gameboard::MAX_Y - 1, 1);
+	board.setContent(2, Gameboard::MAX_Y - 1, 1);
+	assert(AIPlayer::evaluate(board, 0, heightOnly) == 4 && "AIPlayer::evaluate() - wrong aggregate height");
+	assert(AIPlayer::evaluate(board, 0, holesOnly) == 1 && "AIPlayer::evaluate() - wrong hole count");
+	assert(AIPlayer::evaluate(board, 0, bumpinessOnly) == 3 + 1 + 1 && "AIPlayer::evaluate() - wrong bumpiness");
+	assert(AIPlayer::evaluate(board, 0, wellsOnly) == 1 && "AIPlayer::evaluate() - wrong wells");
+
+	// a placement that completes a row: locked, the row removed
+	Gameboard rowBoard;
+	rowBoard.empty();
+	for (int x = 0; x < Gameboard::MAX_X - 1; x++) {
+		rowBoard.setContent(x, Gameboard::MAX_Y - 1, 1);
+	}
+	const MoveGenerator::Placement vertical{ TetShape::I, 0, Gameboard::MAX_X - 1, Gameboard::MAX_Y - 3, 0, 0 };
+	int linesCleared = 0;
+	const TetShape nextShape = TetShape::O;
+	assert(AIPlayer::applyPlacement(rowBoard, vertical, &nextShape, linesCleared) && linesCleared == 1 &&
+		"AIPlayer::applyPlacement() - the row wasn't removed");
+	assert(rowBoard.getColumnHeight(Gameboard::MAX_X - 1) == 3 && rowBoard.getColumnHeight(0) == 0 &&
+		"AIPlayer::applyPlacement() - wrong board after the placement");
+
+	// headless games: the bot survives & clears rows; without a time limit it is
+	// deterministic (the same games whatever the number of search threads)
+	auto makeBot = [](int threads) {
+		return [threads] { return std::unique_ptr<GamePolicy>(new AIPlayer(threads, AIPlayer::DEFAULT_BEAM_WIDTH, std::chrono::microseconds(0))); };
+	};
+	BatchSimulator single(makeBot(1), 1, RandomizerPolicy::UNIFORM, 300);
+	BatchSimulator searching(makeBot(3), 1, RandomizerPolicy::UNIFORM, 300);
+	BatchReport a = single.run(7, 2);
+	BatchReport b = searching.run(7, 2);
+	for (int game = 0; game < 2; game++) {
+		assert(a.results[game].placements == 300 && "AIPlayer - the bot lost a short game");
+		assert(a.results[game].linesCleared >= 100 && "AIPlayer - the bot clears too few rows");
+		assert(a.results[game].score == b.results[game].score && a.results[game].frames == b.results[game].frames &&
+			"AIPlayer - the search depends on the number of threads");
+	}
+
+	// a time limited bot still plays (it always chooses something)
+	BatchSimulator limited([] { return std::unique_ptr<GamePolicy>(new AIPlayer(1)); }, 1, RandomizerPolicy::UNIFORM, 100);
+	assert(limited.run(7, 1).results[0].placements == 100 && "AIPlayer - the time limited bot lost a short game");
+
+	announceTestCompletion();
+#else
+	announceNotTested("AIPlayer");
+#endif
+}
+
+void TestSuite::testTranspositionTableClass()
+{
+#ifdef TRANSPOSITIONTABLE
+	announceTest("TranspositionTable");
+
+	// the board hash follows the occupancy (not the colors) through every change
+	Gameboard board;
+	assert(board.getHash() == 0 && "Gameboard::getHash() - an empty board hashes to 0");
+	board.setContent(3, 17, 1);
+	board.setContent(4, 18, 2);
+	Gameboard other;
+	other.setContent(4, 18, 5);
+	other.setContent(3, 17, 6);
+	assert(board.getHash() == other.getHash() && board.getHash() != 0 && "Gameboard::getHash() - the hash depends on colors or order");
+	board.setContent(3, 17, 3);
+	assert(board.getHash() == other.getHash() && "Gameboard::getHash() - a color change changed the hash");
+	board.setContent(3, 17, Gameboard::EMPTY_BLOCK);
+	assert(board.getHash() != other.getHash() && board.getHash() == board.computeHash() && "Gameboard::getHash() - wrong hash after emptying a location");
+
+	// getHashWith() looks ahead without changing the board
+	const BlockList square{ Point(0, 17), Point(1, 17), Point(0, 18), Point(1, 18) };
+	const std::uint64_t lookAhead = board.getHashWith(square);
+	assert(lookAhead != board.getHash() && "Gameboard::getHashWith() - changed nothing");
+	board.setContent(square, 4);
+	assert(board.getHash() == lookAhead && "Gameboard::getHashWith() - differs from the board it describes");
+
+	// row removal (both ways) re-derives the hash: it matches a board built directly
+	for (int x = 0; x < Gameboard::MAX_X; x++) {
+		board.setContent(x, 18, 1);
+		board.setContent(x, 15, 1);
+	}
+	board.setContent(7, 14, 1);
+	Gameboard removedOneByOne = board;
+	board.removeCompletedRows();
+	removedOneByOne.removeRows({ 15, 18 });
+	Gameboard expected;
+	expected.setContent(0, 18, 1);
+	expected.setContent(1, 18, 1);
+	expected.setContent(7, 16, 1);
+	assert(board.getHash() == board.computeHash() && board.getHash() == expected.getHash() &&
+		"Gameboard::compactCompletedRows() - wrong hash");
+	assert(removedOneByOne.getHash() == expected.getHash() && "Gameboard::removeRows() - wrong hash");
+	board.empty();
+	assert(board.getHash() == 0 && "Gameboard::empty() - wrong hash");
+
+	// keys: positions differ by their shapes, & from the board alone
+	const std::uint64_t hash = expected.getHash();
+	const std::uint64_t key = TranspositionTable::makeKey(hash, TetShape::T, TetShape::I);
+	assert(key != TranspositionTable::makeKey(hash, TetShape::I, TetShape::T) &&
+		key != TranspositionTable::makeKey(hash) && key != 0 && TranspositionTable::makeKey(0) != 0 &&
+		"TranspositionTable::makeKey() - keys collide");
+
+	// store & probe
+	TranspositionTable table(8);
+	double value = 0;
+	assert(table.getSize() == 256 && !table.probe(key, value) && "TranspositionTable - a new table isn't empty");
+	table.store(key, 2.5);
+	assert(table.probe(key, value) && value == 2.5 && "TranspositionTable::probe() - a stored value was lost");
+	assert(!table.probe(key ^ 1, value) && "TranspositionTable::probe() - a different key hit");
+	table.store(key, -1.0);
+	assert(table.probe(key, value) && value == -1.0 && "TranspositionTable::store() - the value wasn't replaced");
+	table.clear();
+	assert(!table.probe(key, value) && "TranspositionTable::clear() - a value survived");
+
+	// threads storing & probing the same (few) entries at once: a hit is always the right value
+	TranspositionTable shared(4);
+	WorkStealingPool pool(4);
+	std::atomic<int> wrongValues{ 0 };
+	pool.parallelFor(200000, [&](std::int64_t i, int) {
+		const std::uint64_t k = TranspositionTable::makeKey(static_cast<std::uint64_t>(i % 97) << 40 | static_cast<std::uint64_t>(i % 97));
+		const double v = static_cast<double>(i % 97);
+		double found;
+		if (shared.probe(k, found) && found != v)
+			wrongValues++;
+		shared.store(k, v);
+	}, 64);
+	assert(wrongValues == 0 && "TranspositionTable - a torn entry was reported as a hit");
+
+	// the bot with a table plays the same moves, scoring fewer boards
+	AIPlayer withTable(1, AIPlayer::DEFAULT_BEAM_WIDTH, std::chrono::microseconds(0), EvaluationWeights(), 12);
+	AIPlayer withoutTable(1, AIPlayer::DEFAULT_BEAM_WIDTH, std::chrono::microseconds(0), EvaluationWeights(), 0);
+	TetrisEngine a(11);
+	TetrisEngine b(11);
+	while (a.getPlacementCount() < 150 && !a.isGameOver()) {
+		a.applyAction(withTable.chooseAction(a));
+		b.applyAction(withoutTable.chooseAction(b));
+		a.stepFrame();
+		b.stepFrame();
+		assert(a.getBoard().getHash() == b.getBoard().getHash() && "AIPlayer - the table changed a move");
+	}
+	assert(a.getScore() == b.getScore() && withTable.getEvaluationCount() < withoutTable.getEvaluationCount() &&
+		"AIPlayer - the table saved no evaluation");
+
+	announceTestCompletion();
+#else
+	announceNotTested("TranspositionTable");
+#endif
+}
+
+#ifdef UNDOSTACK
+// true if two boards hold the same content (& agree on everything derived from it)
+static bool isSameBoard(const Gameboard& a, const Gameboard& b)
+{
+	for (int y = 0; y < Gameboard::MAX_Y; y++) {
+		for (int x = 0; x < Gameboard::MAX_X; x++) {
+			if (a.getContent(x, y) != b.getContent(x, y))
+				return false;
+		}
+		if (a.getRowMask(y) != b.getRowMask(y) || a.getRowFillCount(y) != b.getRowFillCount(y))
+			return false;
+	}
+	for (int x = 0; x < Gameboard::MAX_X; x++) {
+		if (a.getColumnMask(x) != b.getColumnMask(x) || a.getColumnHeight(x) != b.getColumnHeight(x) ||
+			a.getColumnHoleCount(x) != b.getColumnHoleCount(x))
+			return false;
+	}
+	return a.getHoleCount() == b.getHoleCount() && a.getStackHeight() == b.getStackHeight() && a.getHash() == b.getHash();
+}
+#endif
+
+void TestSuite::testUndoStackClass()
+{
+#ifdef UNDOSTACK
+	announceTest("UndoStack");
+
+	// a GameState is a plain value
+	static_assert(std::is_trivially_copyable<GameState>::value, "GameState isn't trivially copyable");
+
+	// snapshot, play on, restore (into another engine, through memcpy): the same inputs replay the same game
+	TetrisEngine engine(21);
+	RandomPolicy policy;
+	policy.reset(5);
+	for (int i = 0; i < 2000; i++) {
+		engine.applyAction(policy.chooseAction(engine));
+		engine.stepFrame();
+	}
+	const GameState snapshot = engine.getState();
+	std::vector<GameAction> actions;
+	for (int i = 0; i < 3000 && !engine.isGameOver(); i++) {
+		actions.push_back(policy.chooseAction(engine));
+		engine.applyAction(actions.back());
+		engine.stepFrame();
+	}
+	const GameState played = engine.getState();
+
+	GameState copied;
+	std::memcpy(&copied, &snapshot, sizeof(GameState));
+	TetrisEngine replay(99);
+	replay.setState(copied);
+	assert(replay.getFrame() == snapshot.frame && replay.getScore() == snapshot.score &&
+		replay.getBoard().getHash() == snapshot.board.getHash() && "TetrisEngine::setState() - the snapshot wasn't restored");
+	for (GameAction action : actions) {
+		replay.applyAction(action);
+		replay.stepFrame();
+	}
+	assert(replay.getFrame() == played.frame && replay.getScore() == played.score &&
+		replay.getPlacementCount() == played.placementCount && replay.isGameOver() == played.gameOver &&
+		isSameBoard(replay.getBoard(), played.board) && "TetrisEngine::setState() - the replay differs");
+	const unsigned int generation = replay.getBoard().getGeneration();
+	replay.setState(snapshot);
+	assert(replay.getBoard().getGeneration() != generation && replay.getBoard().getGeneration() != snapshot.board.getGeneration() &&
+		"TetrisEngine::setState() - the restored board's generation didn't move on");
+
+	// restoreCompletedRows() undoes compactCompletedRows()
+	Gameboard board;
+	for (int x = 0; x < Gameboard::MAX_X; x++) {
+		board.setContent(x, 18, x % 7);
+		board.setContent(x, 16, 3);
+	}
+	board.setContent(2, 17, 1);
+	board.setContent(5, 15, 2);
+	board.setContent(9, 12, 4);
+	const Gameboard beforeClear = board;
+	std::int8_t rows[2][Gameboard::MAX_X];
+	for (int x = 0; x < Gameboard::MAX_X; x++) {
+		rows[0][x] = static_cast<std::int8_t>(board.getContent(x, 16));
+		rows[1][x] = static_cast<std::int8_t>(board.getContent(x, 18));
+	}
+	const Gameboard::RowClearResult cleared = board.compactCompletedRows();
+	assert(cleared.count == 2 && "Gameboard::compactCompletedRows() - wrong count");
+	board.restoreCompletedRows(cleared, rows);
+	assert(isSameBoard(board, beforeClear) && "Gameboard::restoreCompletedRows() - the board wasn't restored");
+
+	// a line of placements (clearing rows) on one board, undone to the start at every depth
+	Random random(8);
+	MoveGenerator generator;
+	UndoStack undoStack;
+	Gameboard searched;
+	std::vector<Gameboard> line{ searched };
+	int rowsRemoved = 0;
+	for (int placement = 0; placement < 400; placement++) {
+		GridTetromino shape;
+		shape.setShape(static_cast<TetShape>(random.nextInt(Tetromino::SHAPE_COUNT)));
+		shape.setGridLoc(searched.getSpawnLoc());
+		const int count = generator.generate(searched, shape);
+		if (count == 0 || searched.getStackHeight() > 12) {
+			// unwind the whole line, checking every board on the way back
+			while (undoStack.size() > 0) {
+				undoStack.undo(searched);
+				line.pop_back();
+				assert(isSameBoard(searched, line.back()) && "UndoStack::undo() - the board differs from before the placement");
+			}
+			continue;
+		}
+		// prefer low placements (so rows get completed)
+		const MoveGenerator::Placement* best = &generator.getPlacements()[random.nextInt(count)];
+		for (const MoveGenerator::Placement& candidate : generator.getPlacements()) {
+			if (candidate.y > best->y && random.nextInt(2))
+				best = &candidate;
+		}
+		rowsRemoved += undoStack.place(searched, MoveGenerator::toGridTetromino(*best).getMappedBlockLocs(),
+			static_cast<int>(Tetromino::getShapeColor(best->shape)));
+		line.push_back(searched);
+		assert(undoStack.size() == line.size() - 1 && "UndoStack::size() - wrong size");
+	}
+	while (undoStack.size() > 0) {
+		undoStack.undo(searched);
+		line.pop_back();
+		assert(isSameBoard(searched, line.back()) && "UndoStack::undo() - the board differs from before the placement");
+	}
+	assert(rowsRemoved > 10 && "UndoStack - the test placements removed too few rows");
+
+	announceTestCompletion();
+#else
+	announceNotTested("UndoStack");
+#endif
+}
+
+void TestSuite::testRolloutEvaluatorClass()
+{
+#ifdef ROLLOUTEVALUATOR
+	announceTest("RolloutEvaluator");
+
+	// the T's placements on a board with a 3 wide gap in the bottom row
+	Gameboard board;
+	for (int x = 3; x < Gameboard::MAX_X; x++) {
+		board.setContent(x, Gameboard::MAX_Y - 1, 1);
+	}
+	GridTetromino t;
+	t.setShape(TetShape::T);
+	t.setGridLoc(board.getSpawnLoc());
+	MoveGenerator generator;
+	generator.generate(board, t);
+	const std::vector<MoveGenerator::Placement>& candidates = generator.getPlacements();
+
+	RolloutSettings settings;
+	settings.rollouts = 200;
+	settings.depth = 8;
+	settings.seed = 42;
+	const TetShape next = TetShape::O;
+	RolloutEvaluator single(1);
+	RolloutEvaluator multi(3);
+	const RolloutReport a = single.evaluate(board, candidates, &next, settings);
+	const RolloutReport b = multi.evaluate(board, candidates, &next, settings);
+	const RolloutReport again = single.evaluate(board, candidates, &next, settings);
+	assert(a.results.size() == candidates.size() && "RolloutEvaluator::evaluate() - wrong number of results");
+	assert(a.steps > 0 && a.steps <= candidates.size() * settings.rollouts * settings.depth && "RolloutEvaluator - wrong step count");
+
+	bool clearsARow = false;
+	for (std::size_t c = 0; c < candidates.size(); c++) {
+		assert(a.results[c].meanLines == b.results[c].meanLines && a.results[c].survivalRate == b.results[c].survivalRate &&
+			"RolloutEvaluator - the results depend on the number of threads");
+		assert(a.results[c].meanLines == again.results[c].meanLines && a.results[c].survivalRate == again.results[c].survivalRate &&
+			"RolloutEvaluator - the results aren't deterministic");
+		assert(a.results[c].survivalRate >= 0 && a.results[c].survivalRate <= 1 && a.results[c].meanLines >= 0 &&
+			"RolloutEvaluator - results out of range");
+		// the T flat in the gap (pointing up) completes the bottom row
+		clearsARow = clearsARow || a.results[c].linesCleared == 1;
+	}
+	assert(clearsARow && "RolloutEvaluator - no candidate completed the bottom row");
+
+	// another seed gives other futures
+	RolloutSettings otherSeed = settings;
+	otherSeed.seed = 43;
+	const RolloutReport other = single.evaluate(board, candidates, &next, otherSeed);
+	bool differs = false;
+	for (std::size_t c = 0; c < candidates.size(); c++) {
+		differs = differs || other.results[c].meanLines != a.results[c].meanLines;
+	}
+	assert(differs && "RolloutEvaluator - another seed gave the same futures");
+
+	// a short rollout on an empty board always survives
+	Gameboard empty;
+	generator.generate(empty, t);
+	settings.depth = 3;
+	const RolloutReport shallow = single.evaluate(empty, generator.getPlacements(), nullptr, settings);
+	for (const RolloutResult& result : shallow.results) {
+		assert(result.survivalRate == 1 && result.linesCleared == 0 && "RolloutEvaluator - a short rollout died on an empty board");
+	}
+
+	// a stack up to the spawn location: the next shape can't spawn, every rollout dies
+	Gameboard tall;
+	for (int y = 2; y < Gameboard::MAX_Y; y++) {
+		for (int x = 0; x < Gameboard::MAX_X; x++) {
+			if (x != y % Gameboard::MAX_X)
+				tall.setContent(x, y, 1);
+		}
+	}
+	for (int x = 3; x < Gameboard::MAX_X; x++) {
+		tall.setContent(x, 1, 1);
+	}
+	const MoveGenerator::Placement onTop{ TetShape::O, 0, 0, 0, 0, 0 };
+	const RolloutReport dead = single.evaluate(tall, { onTop }, &next, settings);
+	assert(dead.results[0].survivalRate == 0 && "RolloutEvaluator - a rollout survived a full board");
+
+	announceTestCompletion();
+#else
+	announceNotTested("RolloutEvaluator");
+#endif
+}
+
+#ifdef TETRISENV
+// play a placement action in a TetrisEngine with the keys (rotate, slide, hard drop, one frame)
+// - return: bool, true if the shape got to the action's rotation & column before the drop
+bool playPlacement(TetrisEngine& engine, int action)
+{
+	const int rotation = action / TETRIS_ENV_COLUMNS;
+	const int x = action % TETRIS_ENV_COLUMNS;
+	const int turns = (rotation - engine.getCurrentShape().getRotation() + 4) % 4;
+	for (int turn = 0; turn < turns; turn++) {
+		engine.applyAction(GameAction::ROTATE);
+	}
+	const GameAction move = (x < engine.getCurrentShape().getGridLoc().getX()) ? GameAction::MOVE_LEFT : GameAction::MOVE_RIGHT;
+	while (engine.getCurrentShape().getGridLoc().getX() != x && engine.applyAction(move)) {
+	}
+	const bool reached = engine.getCurrentShape().getRotation() == rotation && engine.getCurrentShape().getGridLoc().getX() == x;
+	engine.applyAction(GameAction::HARD_DROP);
+	engine.stepFrame();
+	return reached;
+}
+#endif
+
+void TestSuite::testTetrisEnvAPI()
+{
+#ifdef TETRISENV
+	announceTest("TetrisEnv");
+
+	assert(tetrisEnvGetVersion() == TETRIS_ENV_VERSION && "tetrisEnvGetVersion() - wrong version");
+	assert(!tetrisEnvCreate(0, 0, 1) && !tetrisEnvCreate(4, 3, 1) && !tetrisEnvCreate(4, 0, -1) &&
+		"tetrisEnvCreate() - accepted a parameter out of range");
+
+	// every game plays exactly like a TetrisEngine pressing the keys of the same placements
+	const int GAMES{ 300 };		// more than one chunk of games per thread
+	TetrisEnv* env = tetrisEnvCreate(GAMES, static_cast<int>(RandomizerPolicy::SEVEN_BAG), 3);
+	assert(env && tetrisEnvGetCount(env) == GAMES && "tetrisEnvCreate() - wrong game count");
+
+	std::vector<std::uint8_t> board(GAMES * TETRIS_ENV_ROWS * TETRIS_ENV_COLUMNS), shapes(GAMES * 2), heights(GAMES * TETRIS_ENV_COLUMNS);
+	std::vector<std::uint8_t> masks(GAMES * TETRIS_ENV_ACTIONS), dones(GAMES);
+	std::vector<float> rewards(GAMES);
+	std::vector<std::int32_t> actions(GAMES);
+	std::vector<std::uint64_t> seeds(GAMES);
+	assert(tetrisEnvStep(env, actions.data()) == -1 && "tetrisEnvStep() - stepped without buffers");
+	TetrisEnvBuffers buffers{ board.data(), shapes.data(), heights.data(), masks.data(), rewards.data(), dones.data() };
+	assert(tetrisEnvSetBuffers(env, &buffers) == 0 && "tetrisEnvSetBuffers() - refused the buffers");
+
+	std::vector<TetrisEngine> engines;
+	for (int i = 0; i < GAMES; i++) {
+		seeds[i] = 900 + i;
+		engines.push_back(TetrisEngine(seeds[i], RandomizerPolicy::SEVEN_BAG));
+	}
+	tetrisEnvReset(env, seeds.data(), nullptr);
+
+	srand(2121);
+	int resets = 0;
+	int linesCleared = 0;
+	for (int step = 0; step < 120; step++) {
+		for (int i = 0; i < GAMES; i++) {
+			const TetrisEngine& e = engines[i];
+			assert(dones[i] == (e.isGameOver() ? 1 : 0) && "TetrisEnv - game over differs from TetrisEngine");
+			assert(shapes[i * 2] == static_cast<int>(e.getCurrentShape().getShape()) &&
+				shapes[i * 2 + 1] == static_cast<int>(e.getNextShape().getShape()) && "TetrisEnv - shapes differ from TetrisEngine");
+			for (int x = 0; x < TETRIS_ENV_COLUMNS; x++) {
+				assert(heights[i * TETRIS_ENV_COLUMNS + x] == e.getBoard().getColumnHeight(x) && "TetrisEnv - wrong column height");
+				for (int y = 0; y < TETRIS_ENV_ROWS; y++) {
+					assert(board[(i * TETRIS_ENV_ROWS + y) * TETRIS_ENV_COLUMNS + x] == (e.getBoard().isOccupied(x, y) ? 1 : 0) &&
+						"TetrisEnv - board differs from TetrisEngine");
+				}
+			}
+
+			// the mask marks exactly the actions whose placement the keys reach (checked on a few games)
+			std::vector<int> legal;
+			for (int action = 0; action < TETRIS_ENV_ACTIONS; action++) {
+				if (masks[i * TETRIS_ENV_ACTIONS + action])
+					legal.push_back(action);
+				if (i % 50 == 0) {
+					TetrisEngine probe = e;
+					assert(playPlacement(probe, action) == (masks[i * TETRIS_ENV_ACTIONS + action] == 1) &&
+						"TetrisEnv - wrong action mask");
+				}
+			}
+			assert(legal.empty() == e.isGameOver() && "TetrisEnv - no legal action in a game that isn't over");
+
+			// mostly legal actions, sometimes any (out of range too)
+			actions[i] = (!legal.empty() && rand() % 8) ? legal[rand() % legal.size()] : rand() % (TETRIS_ENV_ACTIONS + 4) - 2;
+		}
+
+		std::vector<int> scores(GAMES);
+		for (int i = 0; i < GAMES; i++) {
+			scores[i] = engines[i].getScore();
+			if (!engines[i].isGameOver()) {
+				if (actions[i] >= 0 && actions[i] < TETRIS_ENV_ACTIONS)
+					playPlacement(engines[i], actions[i]);
+				else {
+					engines[i].applyAction(GameAction::HARD_DROP);
+					engines[i].stepFrame();
+				}
+			}
+		}
+		tetrisEnvStep(env, actions.data());
+
+		std::vector<std::uint8_t> resetMask(GAMES);
+		for (int i = 0; i < GAMES; i++) {
+			const TetrisEngine& e = engines[i];
+			assert(rewards[i] == e.getScore() - scores[i] && "TetrisEnv - wrong reward");
+			assert(tetrisEnvGetScores(env)[i] == e.getScore() && tetrisEnvGetLinesCleared(env)[i] == e.getLinesCleared() &&
+				"TetrisEnv - score differs from TetrisEngine");
+			linesCleared += e.getLinesCleared() * (step == 119);
+
+			// start over the games that ended
+			if (e.isGameOver()) {
+				seeds[i] = step * GAMES + i;
+				engines[i].reset(seeds[i]);
+				resetMask[i] = 1;
+				resets++;
+			}
+		}
+		tetrisEnvReset(env, seeds.data(), resetMask.data());
+		for (int i = 0; i < GAMES; i++) {
+			assert((!resetMask[i] || (dones[i] == 0 && rewards[i] == 0)) && "tetrisEnvReset() - game not reset");
+		}
+	}
+	assert(resets > 0 && linesCleared > 0 && "TetrisEnv - the test did not cover game over & row clears");
+	tetrisEnvDestroy(env);
+
+	announceTestCompletion();
+#else
+	announceNotTested("TetrisEnv");
+#endif
+}
+
+#ifdef FINESSEANALYZER
+// the cells a shape lands on when hard dropped on an empty board (x, & the rows above its lowest block)
+std::uint64_t getEmptyBoardLanding(const GridTetromino& shape)
+{
+	int lowest = -Gameboard::MAX_Y;
+	for (const Point& p : shape.getMappedBlockLocs()) {
+		lowest = std::max(lowest, p.getY());
+	}
+	std::uint64_t cells = 0;
+	for (const Point& p : shape.getMappedBlockLocs()) {
+		cells |= std::uint64_t{ 1 } << (p.getX() + Gameboard::MAX_X * (lowest - p.getY()));
+	}
+	return cells;
+}
+#endif
+
+void TestSuite::testFinesseAnalyzerClass()
+{
+#ifdef FINESSEANALYZER
+	announceTest("FinesseAnalyzer");
+
+	// a shape dropped where it spawns takes 1 key; an I laid flat & moved to a wall takes more
+	const int spawnX = Gameboard().getSpawnLoc().getX();
+	for (int s = 0; s < Tetromino::SHAPE_COUNT; s++) {
+		const FinesseAnalyzer::KeySequence& drop = FinesseAnalyzer::getOptimalSequence(static_cast<TetShape>(s), 0, spawnX);
+		assert(drop.keyCount == 1 && drop.keys[0] == GameAction::HARD_DROP && "FinesseAnalyzer - a straight drop isn't 1 key");
+	}
+	const FinesseAnalyzer::KeySequence& flatLeft = FinesseAnalyzer::getOptimalSequence(TetShape::I, 1, 2);
+	assert(flatLeft.keyCount > 2 && flatLeft.keys[0] == GameAction::ROTATE && flatLeft.keys[flatLeft.keyCount - 1] == GameAction::HARD_DROP &&
+		"FinesseAnalyzer - wrong I sequence");
+
+	// every sequence is played by the engine & lands on its placement's cells, & no path
+	// the move generator finds (it also tries soft drops) is shorter
+	MoveGenerator generator;
+	Gameboard empty;
+	for (int s = 0; s < Tetromino::SHAPE_COUNT; s++) {
+		const TetShape shape = static_cast<TetShape>(s);
+		TetrisEngine engine(0);
+		for (int seed = 1; engine.getCurrentShape().getShape() != shape; seed++) {
+			engine.reset(seed);
+		}
+
+		int reachable = 0;
+		for (int rotation = 0; rotation < Tetromino::ROTATION_COUNT; rotation++) {
+			for (int x = 0; x < Gameboard::MAX_X; x++) {
+				GridTetromino target;
+				target.setShape(shape);
+				for (int turn = 0; turn < rotation; turn++) {
+					target.rotateClockwise();
+				}
+				target.setGridLoc(Point(x, 0));
+				const FinesseAnalyzer::KeySequence& sequence = FinesseAnalyzer::getOptimalSequence(shape, rotation, x);
+				bool inside = target.getRotation() == rotation;
+				for (const Point& p : target.getMappedBlockLocs()) {
+					inside = inside && p.getX() >= 0 && p.getX() < Gameboard::MAX_X;
+				}
+				assert((sequence.keyCount > 0) == inside && "FinesseAnalyzer - wrong reachable placements");
+				if (!inside)
+					continue;
+				reachable++;
+
+				TetrisEngine played = engine;
+				for (int key = 0; key < sequence.keyCount - 1; key++) {
+					assert(played.applyAction(sequence.keys[key]) && "FinesseAnalyzer - a key of the sequence does nothing");
+				}
+				assert(getEmptyBoardLanding(played.getCurrentShape()) == getEmptyBoardLanding(target) &&
+					"FinesseAnalyzer - the sequence doesn't reach its placement");
+			}
+		}
+		assert(reachable > 0 && "FinesseAnalyzer - no reachable placement");
+
+		generator.generate(empty, engine.getCurrentShape());
+		for (const MoveGenerator::Placement& placement : generator.getPlacements()) {
+			assert(FinesseAnalyzer::getOptimalSequence(shape, placement.rotation, placement.x).keyCount == placement.pathLength &&
+				"FinesseAnalyzer - the sequence length differs from the move generator's shortest path");
+		}
+	}
+
+	// scoring: faults are the keys beyond the optimum
+	const int optimal = FinesseAnalyzer::getOptimalSequence(TetShape::T, 1, 1).keyCount;
+	assert(optimal > 1 && "FinesseAnalyzer - a T can't be rotated to column 1");
+	FinesseAnalyzer analyzer;
+	assert(analyzer.addPlacement(TetShape::T, 1, 1, optimal) == 0 && "FinesseAnalyzer::addPlacement() - optimal keys have faults");
+	assert(analyzer.addPlacement(TetShape::T, 1, 1, optimal + 3) == 3 && "FinesseAnalyzer::addPlacement() - wrong faults");
+	assert(FinesseAnalyzer::getFaults(TetShape::T, 1, 1, optimal - 1) == 0 && "FinesseAnalyzer::getFaults() - negative faults");
+	assert(analyzer.getPlacementCount() == 2 && analyzer.getKeyCount() == static_cast<std::uint64_t>(2 * optimal + 3) &&
+		analyzer.getOptimalKeyCount() == static_cast<std::uint64_t>(2 * optimal) && analyzer.getFaultCount() == 3 &&
+		analyzer.getFaultyPlacementCount() == 1 && "FinesseAnalyzer - wrong counts");
+	FinesseAnalyzer other;
+	other.addPlacement(TetShape::O, 0, spawnX, 2);
+	analyzer.merge(other);
+	assert(analyzer.getPlacementCount() == 3 && analyzer.getFaultCount() == 4 && "FinesseAnalyzer::merge() - wrong counts");
+	analyzer.reset();
+	assert(analyzer.getPlacementCount() == 0 && analyzer.getFaultCount() == 0 && "FinesseAnalyzer::reset() - counts not cleared");
+
+	announceTestCompletion();
+#else
+	announceNotTested("FinesseAnalyzer");
+#endif
+}
+
+#if defined(REPLAY) || defined(REPLAYCORPUS) || defined(REPLAYVERIFIER)
+// record a game: the policy acts every few frames (like a player), for at most maxFrames
+Replay recordGame(std::uint64_t seed, GamePolicy& policy, std::int64_t maxFrames)
+{
+	TetrisEngine engine(seed, RandomizerPolicy::SEVEN_BAG);
+	Replay replay(seed, RandomizerPolicy::SEVEN_BAG);
+	policy.reset(seed);
+	Random random(seed);
+	while (!engine.isGameOver() && engine.getFrame() < maxFrames) {
+		const GameAction action = policy.chooseAction(engine);
+		replay.addInput(engine.getFrame(), action);
+		engine.applyAction(action);
+		engine.step(1 + random.nextInt(12));
+	}
+	replay.finish(engine);
+	return replay;
+}
+#endif
+
+void TestSuite::testReplayClass()
+{
+#ifdef REPLAY
+	announceTest("Replay");
+
+	// varints: small values take 1 byte, every value reads back, truncated ones don't
+	const std::uint64_t values[] = { 0, 1, 127, 128, 16383, 16384, 0xFFFFFFFFull, 0xFFFFFFFFFFFFFFFFull };
+	std::vector<std::uint8_t> bytes;
+	for (std::uint64_t value : values) {
+		bytes.clear();
+		appendVarint(bytes, value);
+		assert((value >= 128 || bytes.size() == 1) && (value >= 16384 || bytes.size() <= 2) && bytes.size() <= MAX_VARINT_BYTES &&
+			"appendVarint() - too many bytes");
+		const std::uint8_t* at = bytes.data();
+		std::uint64_t read;
+		assert(readVarint(at, bytes.data() + bytes.size(), read) && read == value && at == bytes.data() + bytes.size() &&
+			"readVarint() - wrong value");
+		at = bytes.data();
+		assert(!readVarint(at, bytes.data() + bytes.size() - 1, read) && "readVarint() - read a truncated varint");
+	}
+
+	// a 10 minute game (a bot acting every few frames, like a player) fits in a few kilobytes,
+	// reads back exactly & plays back to the recorded result
+	AIPlayer bot(1, 1, std::chrono::microseconds(0));
+	const Replay long_ = recordGame(23, bot, 10 * 60 * TetrisEngine::FRAMES_PER_SECOND);
+	assert(!long_.getResult().gameOver && long_.getResult().frames >= 10 * 60 * TetrisEngine::FRAMES_PER_SECOND &&
+		long_.getResult().linesCleared > 0 && "Replay - the bot's game didn't last 10 minutes");
+	bytes.clear();
+	long_.encode(bytes);
+	assert(bytes.size() < 12 * 1024 && bytes.size() < 2 * long_.getInputs().size() + 3 * long_.getCheckpoints().size() + 64 &&
+		"Replay::encode() - a 10 minute game is too big");
+
+	Replay decoded;
+	assert(decoded.decode(bytes.data(), bytes.size()) && "Replay::decode() - refused a replay");
+	assert(decoded.getSeed() == 23 && decoded.getPolicy() == RandomizerPolicy::SEVEN_BAG &&
+		decoded.getInputs().size() == long_.getInputs().size() && decoded.getResult() == long_.getResult() &&
+		"Replay::decode() - the replay differs");
+	for (std::size_t i = 0; i < decoded.getInputs().size(); i++) {
+		assert(decoded.getInputs()[i].frame == long_.getInputs()[i].frame && decoded.getInputs()[i].action == long_.getInputs()[i].action &&
+			"Replay::decode() - an input differs");
+	}
+	assert(decoded.play() == long_.getResult() && "Replay::play() - the replayed game differs from the recording");
 
+	// games that end play back to the same end
+	RandomPolicy random;
+	for (std::uint64_t seed = 0; seed < 20; seed++) {
+		const Replay replay = recordGame(seed, random, 1000000);
+		assert(replay.getResult().gameOver && replay.play() == replay.getResult() && "Replay::play() - a finished game differs");
+	}
 
+	// broken bytes are refused: any truncation, another magic, version, policy or action
+	for (std::size_t size = 0; size < bytes.size(); size += 1 + size / 8) {
+		assert(!decoded.decode(bytes.data(), size) && "Replay::decode() - read a truncated replay");
+	}
+	assert(decoded.getInputs().empty() && "Replay::decode() - a refused replay isn't empty");
+	for (std::size_t at : { std::size_t{ 0 }, std::size_t{ 4 }, std::size_t{ 5 } }) {
+		std::vector<std::uint8_t> broken = bytes;
+		broken[at] = 0x7F;
+		assert(!decoded.decode(broken.data(), broken.size()) && "Replay::decode() - read a broken header");
+	}
+	std::vector<std::uint8_t> noneAction;
+	Replay(1).encode(noneAction);
+	noneAction[14] = 1;			// 1 input...
+	noneAction.insert(noneAction.begin() + 15, 0);	// ...of action NONE
+	assert(!decoded.decode(noneAction.data(), noneAction.size()) && "Replay::decode() - read an input of no action");
+
+	// files
+	const char* path = "testsuite.replay";
+	assert(long_.save(path) && decoded.load(path) && decoded.getResult() == long_.getResult() && "Replay::save()/load() - round trip failed");
+	std::remove(path);
+	assert(!decoded.load(path) && "Replay::load() - loaded a missing file");
+
+	announceTestCompletion();
+#else
+	announceNotTested("Replay");
+#endif
+}
+
+void TestSuite::testReplayCorpusClass()
+{
+#ifdef REPLAYCORPUS
+	announceTest("ReplayCorpus");
+
+	const char* path = "testsuite.corpus";
+	std::remove(path);
+	RandomPolicy random;
+	std::vector<Replay> replays;
+	for (std::uint64_t seed = 0; seed < 30; seed++) {
+		replays.push_back(recordGame(seed, random, 1000000));
+	}
+
+	// written in two sessions (the second appends), read back in place
+	ReplayCorpusWriter writer;
+	assert(writer.open(path) && writer.getReplayCount() == 0 && "ReplayCorpusWriter::open() - couldn't create a corpus");
+	for (std::size_t i = 0; i < 20; i++) {
+		assert(writer.add(replays[i]) && "ReplayCorpusWriter::add() - failed");
+	}
+	assert(writer.close() && "ReplayCorpusWriter::close() - failed");
+	assert(writer.open(path) && writer.getReplayCount() == 20 && "ReplayCorpusWriter::open() - didn't read the index");
+	for (std::size_t i = 20; i < replays.size(); i++) {
+		assert(writer.add(replays[i]) && "ReplayCorpusWriter::add() - failed");
+	}
+	assert(writer.close() && "ReplayCorpusWriter::close() - failed");
+
+	ReplayCorpus corpus;
+	assert(corpus.open(path) && corpus.getReplayCount() == replays.size() && "ReplayCorpus::open() - wrong replay count");
+	Replay read;
+	for (std::size_t i = 0; i < replays.size(); i++) {
+		std::vector<std::uint8_t> bytes;
+		replays[i].encode(bytes);
+		std::size_t size;
+		const std::uint8_t* data = corpus.getReplayData(i, size);
+		assert(data != nullptr && size == bytes.size() && std::equal(bytes.begin(), bytes.end(), data) &&
+			"ReplayCorpus::getReplayData() - the bytes differ");
+		assert(corpus.getEntry(i).result == replays[i].getResult() && "ReplayCorpus::getEntry() - the result differs");
+		assert(corpus.getReplay(i, read) && read.getSeed() == replays[i].getSeed() && read.getResult() == replays[i].getResult() &&
+			read.getInputs().size() == replays[i].getInputs().size() && "ReplayCorpus::getReplay() - the replay differs");
+	}
+
+	// the analyses agree with the recordings
+	CorpusAnalyzer analyzer(2);
+	const CorpusSummary summary = analyzer.summarize(corpus);
+	int bestScore = 0;
+	for (const Replay& replay : replays) {
+		bestScore = std::max(bestScore, replay.getResult().score);
+	}
+	assert(summary.replays == replays.size() && summary.gamesOver == replays.size() && summary.score.max == bestScore &&
+		"CorpusAnalyzer::summarize() - wrong summary");
+
+	const CorpusStatistics statistics = analyzer.analyze(corpus);
+	std::uint64_t placements = 0, rows = 0, removed = 0, deaths = 0;
+	for (const Replay& replay : replays) {
+		placements += replay.getResult().placementCount;
+		rows += replay.getResult().linesCleared;
+	}
+	for (int r = 0; r <= CorpusStatistics::MAX_ROWS; r++) {
+		removed += r * statistics.clears[r];
+	}
+	for (int shape = 0; shape < Tetromino::SHAPE_COUNT; shape++) {
+		deaths += statistics.deaths[shape];
+	}
+	assert(statistics.replays == replays.size() && statistics.unreadable == 0 && statistics.divergent == 0 &&
+		statistics.placements == placements && removed == rows && deaths == replays.size() && statistics.survivors == 0 &&
+		statistics.gamesAt[0] == replays.size() && "CorpusAnalyzer::analyze() - wrong counts");
+
+	// a range of one replay: its curve ends at its final score
+	for (std::uint64_t i = 0; i < replays.size(); i++) {
+		const ReplayResult& result = replays[i].getResult();
+		const CorpusStatistics one = analyzer.analyze(corpus, i, i + 1);
+		assert(one.replays == 1 && (result.placementCount > CorpusStatistics::CURVE_LENGTH ||
+			(one.gamesAt[result.placementCount - 1] == 1 && one.getMeanScore(result.placementCount) == result.score)) &&
+			"CorpusAnalyzer::analyze() - wrong score curve");
+	}
+	corpus.close();
+
+	// other files are refused: missing, truncated, not a corpus
+	std::remove(path);
+	assert(!corpus.open(path) && "ReplayCorpus::open() - opened a missing file");
+	std::ofstream(path, std::ios::binary) << "TRPC";
+	assert(!corpus.open(path) && !writer.open(path) && "ReplayCorpus::open() - opened a truncated corpus");
+	replays[0].save(path);
+	assert(!corpus.open(path) && !writer.open(path) && "ReplayCorpus::open() - opened a replay");
+	std::remove(path);
+
+	announceTestCompletion();
+#else
+	announceNotTested("ReplayCorpus");
+#endif
+}
+
+#ifdef REPLAYVERIFIER
+// the offset of an input's first byte in an encoded replay (the inputs' end, for inputs.size())
+std::size_t getInputOffset(const Replay& replay, std::size_t input)
+{
+	std::vector<std::uint8_t> varints;
+	appendVarint(varints, replay.getInputs().size());
+	std::int64_t previousFrame = 0;
+	for (std::size_t i = 0; i < input; i++) {
+		const Replay::Input& in = replay.getInputs()[i];
+		appendVarint(varints, (static_cast<std::uint64_t>(in.frame - previousFrame) << Replay::ACTION_BITS) | static_cast<std::uint64_t>(in.action));
+		previousFrame = in.frame;
+	}
+	return 14 + varints.size();	// after the magic, version, policy & seed
+}
+#endif
+
+void TestSuite::testReplayVerifierClass()
+{
+#ifdef REPLAYVERIFIER
+	announceTest("ReplayVerifier");
+
+	RandomPolicy random;
+	std::vector<Replay> replays;
+	for (std::uint64_t seed = 0; seed < 40; seed++) {
+		replays.push_back(recordGame(seed, random, 1000000));
+	}
+
+	// a checkpoint per placement, which read back & verify
+	for (const Replay& replay : replays) {
+		assert(replay.getCheckpoints().size() == static_cast<std::size_t>(replay.getResult().placementCount) &&
+			"Replay::finish() - not a checkpoint per placement");
+		std::vector<std::uint8_t> bytes;
+		replay.encode(bytes);
+		Replay decoded;
+		assert(decoded.decode(bytes.data(), bytes.size()) && decoded.getCheckpoints().size() == replay.getCheckpoints().size() &&
+			"Replay::decode() - the checkpoints differ");
+		for (std::size_t i = 0; i < decoded.getCheckpoints().size(); i++) {
+			assert(decoded.getCheckpoints()[i].frame == replay.getCheckpoints()[i].frame &&
+				decoded.getCheckpoints()[i].boardHash == replay.getCheckpoints()[i].boardHash && "Replay::decode() - a checkpoint differs");
+		}
+		TetrisEngine engine;
+		ReplayDivergence divergence;
+		assert(decoded.verify(engine, divergence) && "Replay::verify() - a recorded game diverged");
+	}
+
+	// another input (like another engine) diverges on the first placement it changes
+	std::vector<std::uint64_t> tampered;
+	std::int64_t firstFrame = -1;
+	for (std::size_t r = 0; r < replays.size(); r += 7) {
+		const Replay& replay = replays[r];
+		std::size_t input = replay.getInputs().size() / 2;
+		while (replay.getInputs()[input].action == GameAction::HARD_DROP) {
+			input++;
+		}
+		std::vector<std::uint8_t> bytes;
+		replay.encode(bytes);
+		std::uint8_t& first = bytes[getInputOffset(replay, input)];
+		first = static_cast<std::uint8_t>((first & ~7) | static_cast<int>(GameAction::HARD_DROP));
+		assert(replays[r].decode(bytes.data(), bytes.size()) && "Replay::decode() - refused a tampered replay");
+
+		const std::int64_t frame = replay.getInputs()[input].frame;
+		int placements = 0;
+		while (replay.getCheckpoints()[placements].frame <= frame) {
+			placements++;
+		}
+		TetrisEngine engine;
+		ReplayDivergence divergence;
+		assert(!replay.verify(engine, divergence) && divergence.frame == frame + 1 && divergence.placement == placements &&
+			"Replay::verify() - wrong divergence");
+		tampered.push_back(r);
+		firstFrame = (firstFrame < 0) ? divergence.frame : std::min(firstFrame, divergence.frame);
+	}
+
+	// version 1 (no checkpoints): only the result is compared
+	std::vector<std::uint8_t> bytes;
+	replays[1].encode(bytes);
+	std::vector<std::uint8_t> version1(bytes.begin(), bytes.begin() + getInputOffset(replays[1], replays[1].getInputs().size()));
+	version1[4] = 1;
+	const ReplayResult& result = replays[1].getResult();
+	for (std::uint64_t value : { static_cast<std::uint64_t>(result.frames), static_cast<std::uint64_t>(result.score),
+		static_cast<std::uint64_t>(result.linesCleared), static_cast<std::uint64_t>(result.placementCount) }) {
+		appendVarint(version1, value);
+	}
+	version1.push_back(1);
+	appendFixed64(version1, result.boardHash);
+	Replay old;
+	TetrisEngine engine;
+	ReplayDivergence divergence;
+	assert(old.decode(version1.data(), version1.size()) && old.getCheckpoints().empty() && old.getResult() == result &&
+		old.verify(engine, divergence) && "Replay::decode() - didn't read a version 1 replay");
+
+	// a corpus: every tampered replay is found, in order, with the earliest frame
+	const char* path = "testsuite.corpus";
+	std::remove(path);
+	ReplayCorpusWriter writer;
+	assert(writer.open(path) && "ReplayCorpusWriter::open() - failed");
+	for (const Replay& replay : replays) {
+		writer.add(replay);
+	}
+	writer.add(old);
+	assert(writer.close() && "ReplayCorpusWriter::close() - failed");
+	ReplayCorpus corpus;
+	assert(corpus.open(path) && "ReplayCorpus::open() - failed");
+
+	ReplayVerifier verifier(2);
+	const VerificationReport report = verifier.verify(corpus);
+	assert(!report.isIdentical() && report.replays == replays.size() + 1 && report.unreadable == 0 &&
+		report.divergent.size() == tampered.size() && "ReplayVerifier::verify() - wrong counts");
+	for (std::size_t i = 0; i < tampered.size(); i++) {
+		assert(report.divergent[i].replay == tampered[i] && report.divergent[i].recorded == replays[tampered[i]].getResult() &&
+			"ReplayVerifier::verify() - wrong divergent replay");
+	}
+	assert(report.getFirstDivergence()->divergence.frame == firstFrame && "ReplayVerifier::verify() - wrong first divergence");
+	const VerificationReport clean = verifier.verify(corpus, 1, 7);
+	assert(clean.isIdentical() && clean.replays == 6 && "ReplayVerifier::verify() - a range without divergence diverged");
+	corpus.close();
+	std::remove(path);
+
+	announceTestCompletion();
+#else
+	announceNotTested("ReplayVerifier");
+#endif
+}
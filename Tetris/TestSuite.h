@@ -10,6 +10,21 @@
 //#define TETROMINO
 //#define GAMEBOARD
 //#define GRIDTETROMINO
+//#define TETRISENGINE
+//#define PIECEGENERATOR
+//#define BATCHSIMULATOR
+//#define BATCHENVIRONMENT
+//#define MOVEGENERATOR
+//#define PERFT
+//#define AIPLAYER
+//#define TRANSPOSITIONTABLE
+//#define UNDOSTACK
+//#define ROLLOUTEVALUATOR
+//#define TETRISENV
+//#define FINESSEANALYZER
+//#define REPLAY
+//#define REPLAYCORPUS
+//#define REPLAYVERIFIER
 
 #include <string>
 
@@ -21,6 +36,21 @@ private:
 	static void testTetrominoClass();	// tests for the Tetromino class
 	static void testGameboardClass();
 	static void testGridTetrominoClass(); // tests for the GridTetromino class
+	static void testTetrisEngineClass();  // tests for the TetrisEngine class
+	static void testPieceGeneratorClass(); // tests for the PieceGenerator class
+	static void testBatchSimulatorClass(); // tests for the BatchSimulator (& WorkStealingPool) classes
+	static void testBatchEnvironmentClass(); // tests for the BatchEnvironment class
+	static void testMoveGeneratorClass();   // tests for the MoveGenerator class
+	static void testPerftClass();           // tests for the Perft class (reference counts)
+	static void testAIPlayerClass();        // tests for the AIPlayer class
+	static void testTranspositionTableClass(); // tests for the TranspositionTable class (& Gameboard hashing)
+	static void testUndoStackClass();       // tests for the UndoStack class (& GameState snapshots)
+	static void testRolloutEvaluatorClass(); // tests for the RolloutEvaluator class
+	static void testTetrisEnvAPI();         // tests for the TetrisEnv C API (& BatchEnvironment placements)
+	static void testFinesseAnalyzerClass(); // tests for the FinesseAnalyzer class
+	static void testReplayClass();          // tests for the Replay class (& varints)
+	static void testReplayCorpusClass();    // tests for the ReplayCorpus (& CorpusAnalyzer) classes
+	static void testReplayVerifierClass();  // tests for the ReplayVerifier class (& replay checkpoints)
 
 	static void announceTest(const std::string& className);
 	static void announceTestCompletion();
@@ -0,0 +1,465 @@
+#include "TetrisEngine.h"
+
+#include <algorithm>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable<GameState>::value, "a GameState must stay a plain value (copied with memcpy)");
+
+// constructor
+//   seed the piece generator, then reset() the game
+// - param 1: a 64 bit seed (the same seed & policy always deal the same shapes)
+// - param 2: the RandomizerPolicy shapes are picked with
+TetrisEngine::TetrisEngine(std::uint64_t seed, RandomizerPolicy policy) : pieceGenerator{ seed, policy } {
+	reset();
+}
+
+// reset everything for a new game (use existing functions)
+//  - set the score (and the line, placement & frame counts) to 0, drop queued actions
+//  - call determineFramesPerTick() to determine the tick rate.
+//  - clear the gameboard,
+//  - pick & spawn next shape
+//  - pick next shape again (for the "on-deck" shape)
+//   The piece generator carries on from where the last game stopped.
+// - params: none
+// - return: nothing
+void TetrisEngine::reset(){
+	score = 0;
+	linesCleared = 0;
+	placementCount = 0;
+	rowsClearedLastPlacement = 0;
+	gameOver = false;
+	framesSinceLastTick = 0;
+	frame = 0;
+	shapePlacedSinceLastGameLoop = false;
+	queuedActions.clear();
+	nextQueuedAction = 0;
+	determineFramesPerTick();
+	board.empty();
+	pickNextShape();
+	spawnNextShape();
+	pickNextShape();
+}
+
+// same as above, but restart the piece generator from a seed first
+//   (so the new game's shapes are exactly those of any other game with this seed)
+// - param 1: a 64 bit seed
+// - return: nothing
+void TetrisEngine::reset(std::uint64_t seed){
+	pieceGenerator.seed(seed);
+	reset();
+}
+
+// take a snapshot of the game (everything but the queued actions)
+// - params: none
+// - return: a GameState
+GameState TetrisEngine::getState() const{
+	return GameState{ board, currentShape, nextShape, pieceGenerator, score, linesCleared, placementCount,
+		rowsClearedLastPlacement, framesPerTick, framesSinceLastTick, frame, gameOver, shapePlacedSinceLastGameLoop };
+}
+
+// go back (or forward) to a snapshot
+//   The queued actions are dropped (they belong to the timeline being left):
+//   queue the inputs again from the snapshot's frame.
+// - param 1: a GameState (from getState(), possibly of another engine)
+// - return: nothing
+void TetrisEngine::setState(const GameState& state){
+	board.restore(state.board);
+	currentShape = state.currentShape;
+	nextShape = state.nextShape;
+	pieceGenerator = state.pieceGenerator;
+	score = state.score;
+	linesCleared = state.linesCleared;
+	placementCount = state.placementCount;
+	rowsClearedLastPlacement = state.rowsClearedLastPlacement;
+	framesPerTick = state.framesPerTick;
+	framesSinceLastTick = state.framesSinceLastTick;
+	frame = state.frame;
+	gameOver = state.gameOver;
+	shapePlacedSinceLastGameLoop = state.shapePlacedSinceLastGameLoop;
+	queuedActions.clear();
+	nextQueuedAction = 0;
+}
+
+// apply a player action to the currentShape
+//   (move left/right, rotate, move down one line, or hard drop)
+//   A soft drop that can't move the shape, or a hard drop, locks it.
+//   Actions are ignored once the game is over.
+// - param 1: GameAction action
+// - return: bool, true if the action moved, rotated or locked the shape
+bool TetrisEngine::applyAction(GameAction action){
+	if (gameOver || shapePlacedSinceLastGameLoop)
+		return false;
+
+	switch (action) {
+	case GameAction::ROTATE:
+		return attemptRotate(currentShape);
+	case GameAction::MOVE_LEFT:
+		return attemptMove(currentShape, -1, 0);
+	case GameAction::MOVE_RIGHT:
+		return attemptMove(currentShape, 1, 0);
+	case GameAction::SOFT_DROP:
+		if (!attemptMove(currentShape, 0, 1)) {
+			lock(currentShape);
+		}
+		return true;
+	case GameAction::HARD_DROP:
+		drop(currentShape);
+		lock(currentShape);
+		return true;
+	default:
+		return false;
+	}
+}
+
+// queue an action to be applied at the start of an exact frame
+//   (actions queued for the same frame are applied in the order they were queued)
+// - param 1: the frame number (see getFrame()), not before the current frame
+// - param 2: GameAction action
+// - return: bool, false if the frame has already been stepped (nothing queued)
+bool TetrisEngine::queueAction(std::int64_t frame, GameAction action){
+	if (frame < this->frame)
+		return false;
+
+	// keep the queue in frame order: insert after every action queued for frames <= frame
+	const auto at = std::upper_bound(queuedActions.begin() + nextQueuedAction, queuedActions.end(), frame,
+		[](std::int64_t f, const QueuedAction& queued) { return f < queued.frame; });
+	queuedActions.insert(at, QueuedAction{ frame, action });
+	return true;
+}
+
+// run one frame:
+//   - apply the actions queued for this frame,
+//   - count the frame towards the next tick, tick() when it is due,
+//   - when a shape was placed, spawn the next one, remove completed rows
+//     and update the score.  If the next shape can't be spawned the game is over.
+//   Nothing happens (and no frame is counted) once the game is over.
+// - params: none
+// - return: bool, false if the game is over
+bool TetrisEngine::stepFrame(){
+	if (gameOver)
+		return false;
+
+	while (nextQueuedAction < queuedActions.size() && queuedActions[nextQueuedAction].frame == frame) {
+		applyAction(queuedActions[nextQueuedAction].action);
+		nextQueuedAction++;
+	}
+	if (nextQueuedAction == queuedActions.size()) {
+		queuedActions.clear();
+		nextQueuedAction = 0;
+	}
+
+	framesSinceLastTick++;
+	if (framesSinceLastTick >= framesPerTick) {
+		framesSinceLastTick = 0;
+		tick();
+	}
+
+	if (shapePlacedSinceLastGameLoop) {
+		processPlacement();
+	}
+	frame++;
+	return true;
+}
+
+// run up to n frames (the same as calling stepFrame() n times, but the frames where
+// no action is queued, no tick is due and nothing was placed are skipped in one go)
+// - param 1: int the number of frames to run
+// - return: int the number of frames run (less than n if the game ended)
+int TetrisEngine::step(int frames){
+	int stepped = 0;
+	while (stepped < frames && !gameOver) {
+		// the frames before the next tick, the next queued action or the end of the step
+		std::int64_t quiet = framesPerTick - framesSinceLastTick - 1;
+		if (nextQueuedAction < queuedActions.size()) {
+			quiet = std::min(quiet, queuedActions[nextQueuedAction].frame - frame);
+		}
+		quiet = std::min<std::int64_t>(quiet, frames - stepped);
+
+		if (quiet > 0 && !shapePlacedSinceLastGameLoop) {
+			frame += quiet;
+			framesSinceLastTick += static_cast<int>(quiet);
+			stepped += static_cast<int>(quiet);
+		}
+		else {
+			stepFrame();
+			stepped++;
+		}
+	}
+	return stepped;
+}
+
+// A tick() forces the currentShape to move (if there were no tick,
+// the currentShape would float in position forever). This should
+// call attemptMove() on the currentShape.  If not successful, lock()
+// the currentShape (it can move no further).
+// - params: none
+// - return: nothing
+void TetrisEngine::tick(){
+	if (gameOver || shapePlacedSinceLastGameLoop)
+		return;
+	if (!attemptMove(currentShape, 0, 1)) {
+		lock(currentShape);
+	}
+}
+
+// Getters ======================================================
+
+// the current score
+int TetrisEngine::getScore() const {
+	return score;
+}
+
+// the number of rows removed this game
+int TetrisEngine::getLinesCleared() const {
+	return linesCleared;
+}
+
+// the number of shapes placed (locked) this game.  A view can compare it
+// with the count it last saw to find out a placement happened.
+int TetrisEngine::getPlacementCount() const {
+	return placementCount;
+}
+
+// the number of rows removed by the last placement
+int TetrisEngine::getRowsClearedLastPlacement() const {
+	return rowsClearedLastPlacement;
+}
+
+// the number of frames run this game (the number of the next frame to run)
+std::int64_t TetrisEngine::getFrame() const {
+	return frame;
+}
+
+// the number of frames a shape currently takes to fall one line
+int TetrisEngine::getFramesPerTick() const {
+	return framesPerTick;
+}
+
+// true once the next shape could not be spawned (the game stays over until reset())
+bool TetrisEngine::isGameOver() const {
+	return gameOver;
+}
+
+// the gameboard (the locked blocks)
+const Gameboard& TetrisEngine::getBoard() const {
+	return board;
+}
+
+// the seed the piece generator was last (re)started from
+std::uint64_t TetrisEngine::getSeed() const {
+	return pieceGenerator.getSeed();
+}
+
+// the policy the piece generator picks shapes with
+RandomizerPolicy TetrisEngine::getRandomizerPolicy() const {
+	return pieceGenerator.getPolicy();
+}
+
+// the tetromino that is currently falling
+const GridTetromino& TetrisEngine::getCurrentShape() const {
+	return currentShape;
+}
+
+// the tetromino shape that is "on deck"
+const GridTetromino& TetrisEngine::getNextShape() const {
+	return nextShape;
+}
+
+// a copy of the currentShape dropped as far as it can legally go
+// (where a hard drop would place it)
+GridTetromino TetrisEngine::getGhostShape() const {
+	GridTetromino ghost = currentShape;
+	drop(ghost);
+	return ghost;
+}
+
+// the number of points a placement is worth, given the rows it removed
+//   1 row: 40, 2 rows: 100, 3 rows: 300, 4 rows: 1200, otherwise 1.
+// - param 1: int rows removed by the placement
+// - return: int, the points
+int TetrisEngine::getScoreForRows(int rows) {
+	switch (rows) {
+	case 1:
+		return 40;
+	case 2:
+		return 100;
+	case 3:
+		return 300;
+	case 4:
+		return 1200;
+	default:
+		return 1;
+	}
+}
+
+// the number of frames a shape takes to fall one line at a given score
+// - param 1: int the score
+// - return: int, the frames per tick
+int TetrisEngine::getFramesPerTickForScore(int score) {
+	if (score <= 100)
+		return MAX_FRAMES_PER_TICK;
+	else if (score > 100)
+		return 33;		// 0.55 seconds
+	else if (score > 300)
+		return 27;		// 0.45 seconds
+	else if (score > 500)
+		return 21;		// 0.35 seconds
+	else if (score > 1000)
+		return 18;		// 0.30 seconds
+	else if (score > 3000)
+		return 15;		// 0.25 seconds
+	else if (score > 10000)
+		return MIN_FRAMES_PER_TICK;
+	return MIN_FRAMES_PER_TICK;
+}
+
+// assign nextShape.setShape the next shape from the piece generator
+// - params: none
+// - return: nothing
+void TetrisEngine::pickNextShape(){
+	nextShape.setShape(pieceGenerator.next());
+}
+
+// copy the nextShape into the currentShape (through assignment)
+//   position the currentShape to its spawn location.
+// - params: none
+// - return: bool, true/false based on isPositionLegal()
+bool TetrisEngine::spawnNextShape() {
+	GridTetromino t = nextShape;
+	t.setGridLoc(board.getSpawnLoc());
+	if (isPositionLegal(t))
+	{
+		currentShape = t;
+		return true;
+	}
+	return false;
+}
+
+// Test if a rotation is legal on the tetromino and if so, rotate it.
+//  To accomplish this:
+//	 1) create a (local) temporary copy of the tetromino
+//	 2) rotate it (temp.rotateClockwise())
+//	 3) test if temp rotation was legal (isPositionLegal()), on
+//      if so - rotate the original tetromino.
+// - param 1: GridTetromino shape
+// - return: bool, true/false to indicate successful movement
+bool TetrisEngine::attemptRotate(GridTetromino& shape) const {
+	GridTetromino temp = shape;
+	temp.rotateClockwise();
+	if (isPositionLegal(temp)) {
+		shape.rotateClockwise();
+		return true;
+	}
+	return false;
+}
+
+// test if a move is legal on the tetromino, if so, move it.
+//  To do this:
+//	 1) create a (local) temporary copy of the tetromino
+//	 2) move it (temp.move())
+//	 3) test if temp move was legal (isPositionLegal(),
+//      if so - move the original.
+// - param 1: GridTetromino shape
+// - param 2: int x{}
+// - param 3: int y{}
+// - return: true/false to indicate successful movement
+bool TetrisEngine::attemptMove(GridTetromino& shape, int x, int y) const {
+	GridTetromino temp = shape;
+	temp.move(x,y);
+	if (isPositionLegal(temp)) {
+		shape.move(x, y);
+		return true;
+	}
+	return false;
+}
+
+// drops the tetromino vertically as far as it can
+//   legally go.  The distance comes straight from the board's column
+//   occupancy (board.getDropDistance()), then the shape moves once.
+// - param 1: GridTetromino shape
+// - return: int of levels dropped.
+int TetrisEngine::drop(GridTetromino& shape) const {
+	const int distance = board.getDropDistance(shape.getMappedBlockLocs());
+	shape.move(0, distance);
+	return distance;
+}
+
+// copy the contents (color) of the tetromino's mapped block locs to the grid.
+//	 1) get the tetromino's mapped locs via tetromino.getMappedBlockLocs()
+//   2) use the board's setContent() method to set the content at the mapped locations.
+//   3) record the fact that we placed a shape by setting shapePlacedSinceLastGameLoop
+//      to true
+// - param 1: GridTetromino shape
+// - return: nothing
+void TetrisEngine::lock(const GridTetromino& shape){
+	board.setContent(shape.getMappedBlockLocs(), static_cast<int>(shape.getColor()));
+	shapePlacedSinceLastGameLoop = true;
+}
+
+// spawn the next shape after a placement, remove completed rows & update the score
+//   (or end the game if the next shape can't be spawned)
+// - params: none
+// - return: nothing
+void TetrisEngine::processPlacement(){
+	shapePlacedSinceLastGameLoop = false;
+	if (spawnNextShape()) {
+		pickNextShape();
+		int rowsRemoved = board.removeCompletedRows();
+
+		rowsClearedLastPlacement = rowsRemoved;
+		linesCleared += rowsRemoved;
+		placementCount++;
+		score += getScoreForRows(rowsRemoved);
+		determineFramesPerTick();
+	}
+	else {
+		gameOver = true;
+	}
+}
+
+// State & gameplay/logic methods ================================
+
+// Determine if a Tetromino can legally be placed at its current position
+// on the gameboard.
+//   Tip: Make use of Gameboard's areLocsEmpty() and pass it the shape's mapped locs.
+// - param 1: GridTetromino shape
+// - return: bool, true if shape is within borders (isWithinBorders()) and
+//           the shape's mapped board locs are empty (false otherwise).
+bool TetrisEngine::isPositionLegal(const GridTetromino& shape) const {
+	const BlockList locs = shape.getMappedBlockLocs();	// map once, test twice
+	if (!isWithinBorders(locs)) { return false; }
+	if (!board.areAllLocsEmpty(locs)) { return false; }
+	return true;
+}
+
+// Determine if the shape is within the left, right, & bottom gameboard borders
+//   * Ignore the upper border because we want shapes to be able to drop
+//     in from the top of the gameboard.
+//   All of a shape's blocks must be inside these 3 borders to return true
+// - param 1: GridTetromino shape
+// - return: bool, true if the shape is within the left, right, and lower border
+//	         of the grid, but *NOT* the top border (false otherwise)
+bool TetrisEngine::isWithinBorders(const GridTetromino& shape) const {
+	return isWithinBorders(shape.getMappedBlockLocs());
+}
+
+// Same as above, for a shape's already mapped block locs
+// - param 1: BlockList the mapped block locs (see GridTetromino::getMappedBlockLocs())
+// - return: bool, true if every loc is within the left, right, and lower border
+//	         of the grid, but *NOT* the top border (false otherwise)
+bool TetrisEngine::isWithinBorders(const BlockList& locs) const {
+	for (const Point& p : locs) {
+		if (!(p.getX() < board.MAX_X && p.getX() >= 0)) { return false; }
+		if (!(p.getY() < board.MAX_Y)) { return false; }
+	}
+	return true;
+}
+
+// set framesPerTick
+//   - basic: use MAX_FRAMES_PER_TICK
+//   - advanced: base it on score (higher score results in lower framesPerTick)
+// params: none
+// return: nothing
+void TetrisEngine::determineFramesPerTick(){
+	framesPerTick = getFramesPerTickForScore(score);
+}
@@ -0,0 +1,329 @@
+// This class encapsulates the rules of a single tetris game: the board, the current
+// and next shapes, scoring, tick timing and locking.
+// It has no knowledge of graphics, windows, fonts or input devices (no SFML at all),
+// so a game can be run (and many games can be run at once) on a machine without a
+// display.  TetrisGame is a thin SFML view on top of it: it turns key presses into
+// GameActions, turns the time that passed into frames, and draws the engine's state.
+//
+// Time is counted in whole frames (FRAMES_PER_SECOND of them per second), never in
+// seconds: the engine is advanced with step(n), and actions can be queued to happen
+// at exact frame numbers.  A game is fully determined by its seed, its randomizer
+// policy and its (frame, action) inputs, and step() fast forwards through the frames
+// where nothing happens, so a game runs as fast as the rules can be evaluated.
+//
+// This class is responsible for:
+//   - setting up the board,
+//   - spawning tetrominoes,
+//   - applying player actions (move, rotate, drop),
+//   - moving and placing (locking) tetrominoes,
+//   - removing completed rows & scoring,
+//   - detecting the end of the game.
+//
+// Everything a game is (but its queued inputs) can be copied out as a GameState with
+// getState() and put back with setState(): a GameState is a plain, trivially copyable
+// value of a few hundred bytes, so a search (or a rollback) can keep as many as it
+// likes and restoring one is a memcpy.
+
+#ifndef TETRISENGINE_H
+#define TETRISENGINE_H
+
+#include "Gameboard.h"
+#include "GridTetromino.h"
+#include "PieceGenerator.h"
+#include <cstdint>
+#include <vector>
+
+// the things a player (or a bot) can do to the current shape
+enum class GameAction
+{
+	NONE,
+	MOVE_LEFT,
+	MOVE_RIGHT,
+	ROTATE,
+	SOFT_DROP,
+	HARD_DROP
+};
+
+// a snapshot of a game (see TetrisEngine::getState()): the board, the shapes, the piece
+// generator, the score & counts and the tick state.  Trivially copyable (no pointers,
+// nothing allocated), so snapshots can be copied with memcpy & stored in plain arrays.
+struct GameState
+{
+	Gameboard board;
+	GridTetromino currentShape;
+	GridTetromino nextShape;
+	PieceGenerator pieceGenerator;
+	int score;
+	int linesCleared;
+	int placementCount;
+	int rowsClearedLastPlacement;
+	int framesPerTick;
+	int framesSinceLastTick;
+	std::int64_t frame;
+	bool gameOver;
+	bool shapePlacedSinceLastGameLoop;
+};
+
+class TetrisEngine
+{
+public:
+	// STATIC CONSTANTS
+	static const int FRAMES_PER_SECOND{ 60 };	// the number of frames in one second of play
+	static const int MAX_FRAMES_PER_TICK{ 45 };	// the slowest "tick" rate (in frames), 0.75 seconds
+	static const int MIN_FRAMES_PER_TICK{ 12 };	// the fastest "tick" rate (in frames), 0.20 seconds
+
+private:
+	// MEMBER VARIABLES
+
+	// State members ---------------------------------------------
+	int score;					// the current game score.
+	Gameboard board;			// the gameboard (grid) to represent where all the blocks are.
+	GridTetromino nextShape;	// the tetromino shape that is "on deck".
+	GridTetromino currentShape;	// the tetromino that is currently falling.
+	bool gameOver{ false };		// set when the next shape could not be spawned.
+	PieceGenerator pieceGenerator;	// picks this game's shapes (seeded, owned by this game only)
+
+	int linesCleared{ 0 };					// the number of rows removed this game.
+	int placementCount{ 0 };				// the number of shapes placed (locked) this game.
+	int rowsClearedLastPlacement{ 0 };		// the number of rows the last placement removed.
+
+	// Time members ----------------------------------------------
+	// Note: a "tick" is the number of frames it takes a block to fall one line.
+	int framesPerTick = MAX_FRAMES_PER_TICK;	// the frames per tick (changes depending on score)
+
+	int framesSinceLastTick{ 0 };				// counted up every frame until it reaches framesPerTick,
+												// we then know to trigger a tick (and start counting again).
+	std::int64_t frame{ 0 };					// the number of frames stepped this game (the next frame to run)
+	bool shapePlacedSinceLastGameLoop{ false };	// Tracks whether we have placed (locked) a shape on
+												// the gameboard in the current frame
+
+	// Input members ---------------------------------------------
+	// an action waiting for its frame
+	struct QueuedAction
+	{
+		std::int64_t frame;
+		GameAction action;
+	};
+	std::vector<QueuedAction> queuedActions;	// actions not applied yet, in frame order
+	std::size_t nextQueuedAction{ 0 };			// the first action of queuedActions not applied yet
+public:
+	// MEMBER FUNCTIONS
+
+	// constructor
+	//   seed the piece generator, then reset() the game
+	// - param 1: a 64 bit seed (the same seed & policy always deal the same shapes)
+	// - param 2: the RandomizerPolicy shapes are picked with
+	TetrisEngine(std::uint64_t seed = 0, RandomizerPolicy policy = RandomizerPolicy::UNIFORM);
+
+	// reset everything for a new game (use existing functions)
+	//  - set the score (and the line, placement & frame counts) to 0, drop queued actions
+	//  - call determineFramesPerTick() to determine the tick rate.
+	//  - clear the gameboard,
+	//  - pick & spawn next shape
+	//  - pick next shape again (for the "on-deck" shape)
+	//   The piece generator carries on from where the last game stopped.
+	// - params: none
+	// - return: nothing
+	void reset();
+
+	// same as above, but restart the piece generator from a seed first
+	//   (so the new game's shapes are exactly those of any other game with this seed)
+	// - param 1: a 64 bit seed
+	// - return: nothing
+	void reset(std::uint64_t seed);
+
+	// take a snapshot of the game (everything but the queued actions)
+	// - params: none
+	// - return: a GameState
+	GameState getState() const;
+
+	// go back (or forward) to a snapshot
+	//   The queued actions are dropped (they belong to the timeline being left):
+	//   queue the inputs again from the snapshot's frame.
+	// - param 1: a GameState (from getState(), possibly of another engine)
+	// - return: nothing
+	void setState(const GameState& state);
+
+	// apply a player action to the currentShape
+	//   (move left/right, rotate, move down one line, or hard drop)
+	//   A soft drop that can't move the shape, or a hard drop, locks it.
+	//   Actions are ignored once the game is over.
+	// - param 1: GameAction action
+	// - return: bool, true if the action moved, rotated or locked the shape
+	bool applyAction(GameAction action);
+
+	// queue an action to be applied at the start of an exact frame
+	//   (actions queued for the same frame are applied in the order they were queued)
+	// - param 1: the frame number (see getFrame()), not before the current frame
+	// - param 2: GameAction action
+	// - return: bool, false if the frame has already been stepped (nothing queued)
+	bool queueAction(std::int64_t frame, GameAction action);
+
+	// run one frame:
+	//   - apply the actions queued for this frame,
+	//   - count the frame towards the next tick, tick() when it is due,
+	//   - when a shape was placed, spawn the next one, remove completed rows
+	//     and update the score.  If the next shape can't be spawned the game is over.
+	//   Nothing happens (and no frame is counted) once the game is over.
+	// - params: none
+	// - return: bool, false if the game is over
+	bool stepFrame();
+
+	// run up to n frames (the same as calling stepFrame() n times, but the frames where
+	// no action is queued, no tick is due and nothing was placed are skipped in one go)
+	// - param 1: int the number of frames to run
+	// - return: int the number of frames run (less than n if the game ended)
+	int step(int frames);
+
+	// A tick() forces the currentShape to move (if there were no tick,
+	// the currentShape would float in position forever). This should
+	// call attemptMove() on the currentShape.  If not successful, lock()
+	// the currentShape (it can move no further).
+	// - params: none
+	// - return: nothing
+	void tick();
+
+	// Getters ======================================================
+
+	// the current score
+	int getScore() const;
+
+	// the number of rows removed this game
+	int getLinesCleared() const;
+
+	// the number of shapes placed (locked) this game.  A view can compare it
+	// with the count it last saw to find out a placement happened.
+	int getPlacementCount() const;
+
+	// the number of rows removed by the last placement
+	int getRowsClearedLastPlacement() const;
+
+	// the number of frames run this game (the number of the next frame to run)
+	std::int64_t getFrame() const;
+
+	// the number of frames a shape currently takes to fall one line
+	int getFramesPerTick() const;
+
+	// true once the next shape could not be spawned (the game stays over until reset())
+	bool isGameOver() const;
+
+	// the gameboard (the locked blocks)
+	const Gameboard& getBoard() const;
+
+	// the seed the piece generator was last (re)started from
+	std::uint64_t getSeed() const;
+
+	// the policy the piece generator picks shapes with
+	RandomizerPolicy getRandomizerPolicy() const;
+
+	// the tetromino that is currently falling
+	const GridTetromino& getCurrentShape() const;
+
+	// the tetromino shape that is "on deck"
+	const GridTetromino& getNextShape() const;
+
+	// a copy of the currentShape dropped as far as it can legally go
+	// (where a hard drop would place it)
+	GridTetromino getGhostShape() const;
+
+	// the number of points a placement is worth, given the rows it removed
+	//   1 row: 40, 2 rows: 100, 3 rows: 300, 4 rows: 1200, otherwise 1.
+	// - param 1: int rows removed by the placement
+	// - return: int, the points
+	static int getScoreForRows(int rows);
+
+	// the number of frames a shape takes to fall one line at a given score
+	// - param 1: int the score
+	// - return: int, the frames per tick
+	static int getFramesPerTickForScore(int score);
+
+private:
+	// assign nextShape.setShape the next shape from the piece generator
+	// - params: none
+	// - return: nothing
+	void pickNextShape();
+
+	// copy the nextShape into the currentShape (through assignment)
+	//   position the currentShape to its spawn location.
+	// - params: none
+	// - return: bool, true/false based on isPositionLegal()
+	bool spawnNextShape();
+
+	// Test if a rotation is legal on the tetromino and if so, rotate it.
+	//  To accomplish this:
+	//	 1) create a (local) temporary copy of the tetromino
+	//	 2) rotate it (temp.rotateClockwise())
+	//	 3) test if temp rotation was legal (isPositionLegal()),
+	//      if so - rotate the original tetromino.
+	// - param 1: GridTetromino shape
+	// - return: bool, true/false to indicate successful movement
+	bool attemptRotate(GridTetromino& shape) const;
+
+	// test if a move is legal on the tetromino, if so, move it.
+	//  To do this:
+	//	 1) create a (local) temporary copy of the tetromino
+	//	 2) move it (temp.move())
+	//	 3) test if temp move was legal (isPositionLegal(),
+	//      if so - move the original.
+	// - param 1: GridTetromino shape
+	// - param 2: int x;
+	// - param 3: int y;
+	// - return: true/false to indicate successful movement
+	bool attemptMove(GridTetromino& shape, int x, int y) const;
+
+	// drops the tetromino vertically as far as it can
+	//   legally go.  The distance comes straight from the board's column
+	//   occupancy (board.getDropDistance()), then the shape moves once.
+	// - param 1: GridTetromino shape
+	// - return: int of levels dropped.
+	int drop(GridTetromino& shape) const;
+
+	// copy the contents (color) of the tetromino's mapped block locs to the grid.
+	//	 1) get the tetromino's mapped locs via tetromino.getMappedBlockLocs()
+	//   2) use the board's setContent() method to set the content at the mapped locations.
+	//   3) record the fact that we placed a shape by setting shapePlacedSinceLastGameLoop
+	//      to true
+	// - param 1: GridTetromino shape
+	// - return: nothing
+	void lock(const GridTetromino& shape);
+
+	// spawn the next shape after a placement, remove completed rows & update the score
+	//   (or end the game if the next shape can't be spawned)
+	// - params: none
+	// - return: nothing
+	void processPlacement();
+
+	// State & gameplay/logic methods ================================
+
+	// Determine if a Tetromino can legally be placed at its current position
+	// on the gameboard.
+	//   Tip: Make use of Gameboard's areLocsEmpty() and pass it the shape's mapped locs.
+	// - param 1: GridTetromino shape
+	// - return: bool, true if shape is within borders (isWithinBorders()) and
+	//           the shape's mapped board locs are empty (false otherwise).
+	bool isPositionLegal(const GridTetromino& shape) const;
+
+	// Determine if the shape is within the left, right, & bottom gameboard borders
+	//   * Ignore the upper border because we want shapes to be able to drop
+	//     in from the top of the gameboard.
+	//   All of a shape's blocks must be inside these 3 borders to return true
+	// - param 1: GridTetromino shape
+	// - return: bool, true if the shape is within the left, right, and lower border
+	//	         of the grid, but *NOT* the top border (false otherwise)
+	bool isWithinBorders(const GridTetromino& shape) const;
+
+	// Same as above, for a shape's already mapped block locs
+	// - param 1: BlockList the mapped block locs (see GridTetromino::getMappedBlockLocs())
+	// - return: bool, true if every loc is within the left, right, and lower border
+	//	         of the grid, but *NOT* the top border (false otherwise)
+	bool isWithinBorders(const BlockList& locs) const;
+
+	// set framesPerTick
+	//   - basic: use MAX_FRAMES_PER_TICK
+	//   - advanced: base it on score (higher score results in lower framesPerTick)
+	// params: none
+	// return: nothing
+	void determineFramesPerTick();
+};
+
+#endif /* TETRISENGINE_H */
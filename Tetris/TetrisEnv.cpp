@@ -0,0 +1,236 @@
+#include "TetrisEnv.h"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <vector>
+#include "BatchEnvironment.h"
+#include "Bits.h"
+#include "WorkStealingPool.h"
+
+static_assert(TETRIS_ENV_ROWS == Gameboard::MAX_Y && TETRIS_ENV_COLUMNS == Gameboard::MAX_X &&
+	TETRIS_ENV_ACTIONS == BatchEnvironment::PLACEMENT_COUNT, "TetrisEnv.h is out of date");
+
+namespace
+{
+	// the 8 cells (0 or 1) of every 8 bit mask: a row mask is written 8 cells at a time
+	struct CellsOfMask
+	{
+		std::uint8_t cells[256][8];
+
+		CellsOfMask()
+		{
+			for (int mask = 0; mask < 256; mask++)
+			{
+				for (int x = 0; x < 8; x++)
+				{
+					cells[mask][x] = static_cast<std::uint8_t>((mask >> x) & 1);
+				}
+			}
+		}
+	};
+
+	const CellsOfMask& getCellsOfMask()
+	{
+		static const CellsOfMask cellsOfMask;
+		return cellsOfMask;
+	}
+}
+
+// an environment: the games, the threads that step them & the caller's buffers
+struct TetrisEnv
+{
+	// CONSTANTS
+	static const int GAMES_PER_CHUNK{ 256 };	// the games a thread steps at a time
+
+	BatchEnvironment batch;
+	std::unique_ptr<WorkStealingPool> pool;		// the threads (none when stepping on the calling thread)
+	TetrisEnvBuffers buffers{};
+	bool hasBuffers{ false };
+	std::vector<std::int32_t> previousScores;	// every game's score before the step (for the rewards)
+
+	TetrisEnv(int gameCount, RandomizerPolicy randomizerPolicy, int threadCount) :
+		batch(gameCount, randomizerPolicy), previousScores(gameCount)
+	{
+		if (threadCount != 1)
+			pool.reset(new WorkStealingPool(threadCount));
+	}
+
+	// run a task on every game, split over the threads
+	// - param 1: the task, called with a range of games (the first & the one after the last)
+	// - return: nothing
+	template <typename GameTask>
+	void forEachGame(const GameTask& task)
+	{
+		const int gameCount = batch.getGameCount();
+		if (pool)
+		{
+			pool->parallelFor((gameCount + GAMES_PER_CHUNK - 1) / GAMES_PER_CHUNK, [&](std::int64_t chunk, int) {
+				const int first = static_cast<int>(chunk) * GAMES_PER_CHUNK;
+				const int end = std::min(gameCount, first + GAMES_PER_CHUNK);
+				task(first, end);
+			});
+		}
+		else
+			task(0, gameCount);
+	}
+
+	// write a game's observation into the caller's buffers
+	// - param 1: the game's index
+	// - param 2: the game's reward
+	// - return: nothing
+	void writeObservation(int game, float reward)
+	{
+		const std::uint16_t* rows = batch.getRowMasks() + static_cast<std::size_t>(game) * Gameboard::MAX_Y;
+		std::uint8_t* cells = buffers.board + static_cast<std::size_t>(game) * Gameboard::MAX_Y * Gameboard::MAX_X;
+		const CellsOfMask& cellsOfMask = getCellsOfMask();
+		for (int y = 0; y < Gameboard::MAX_Y; y++)
+		{
+			const unsigned int mask = rows[y];
+			std::uint8_t* row = &cells[y * Gameboard::MAX_X];
+			std::memcpy(row, cellsOfMask.cells[mask & 0xFF], 8);
+			for (int x = 8; x < Gameboard::MAX_X; x++)
+			{
+				row[x] = static_cast<std::uint8_t>((mask >> x) & 1);
+			}
+		}
+
+		// a column's height is set by its highest block: the first row (top down) it's seen in
+		std::uint8_t* heights = buffers.heights + static_cast<std::size_t>(game) * Gameboard::MAX_X;
+		for (int x = 0; x < Gameboard::MAX_X; x++)
+		{
+			heights[x] = 0;
+		}
+		std::uint32_t seen = 0;
+		for (int y = 0; y < Gameboard::MAX_Y && seen != Gameboard::FULL_ROW_MASK; y++)
+		{
+			std::uint32_t highest = rows[y] & ~seen;
+			seen |= rows[y];
+			while (highest)
+			{
+				heights[countTrailingZeros(highest)] = static_cast<std::uint8_t>(Gameboard::MAX_Y - y);
+				highest &= highest - 1;
+			}
+		}
+
+		buffers.shapes[game * 2] = batch.getCurrentShapes()[game];
+		buffers.shapes[game * 2 + 1] = batch.getNextShapes()[game];
+		if (buffers.actionMasks)
+			batch.getPlacementMask(game, buffers.actionMasks + static_cast<std::size_t>(game) * BatchEnvironment::PLACEMENT_COUNT);
+		buffers.rewards[game] = reward;
+		buffers.dones[game] = batch.getGameOver()[game];
+		previousScores[game] = batch.getScores()[game];
+	}
+};
+
+// the TETRIS_ENV_VERSION the library was built with
+int32_t tetrisEnvGetVersion(void)
+{
+	return TETRIS_ENV_VERSION;
+}
+
+// make an environment
+// - param 1: the number of games (>= 1)
+// - param 2: the RandomizerPolicy (0: uniform, 1: seven bag, 2: bag with history)
+// - param 3: the number of threads (0 to use every hardware thread, 1 for the calling thread)
+// - return: the environment, nullptr if a parameter is out of range
+TetrisEnv* tetrisEnvCreate(int32_t envCount, int32_t randomizerPolicy, int32_t threadCount)
+{
+	if (envCount < 1 || randomizerPolicy < static_cast<int>(RandomizerPolicy::UNIFORM) ||
+		randomizerPolicy > static_cast<int>(RandomizerPolicy::BAG_WITH_HISTORY) || threadCount < 0)
+		return nullptr;
+
+	// no exception may cross the C interface
+	try
+	{
+		return new TetrisEnv(envCount, static_cast<RandomizerPolicy>(randomizerPolicy), threadCount);
+	}
+	catch (const std::exception&)
+	{
+		return nullptr;
+	}
+}
+
+// free an environment (nullptr is ignored)
+void tetrisEnvDestroy(TetrisEnv* env)
+{
+	delete env;
+}
+
+// the number of games
+int32_t tetrisEnvGetCount(const TetrisEnv* env)
+{
+	return env->batch.getGameCount();
+}
+
+// set the buffers every reset & step writes to, and write the current observations into them
+// - param 1: the environment
+// - param 2: the buffers
+// - return: 0, or -1 if a required buffer is nullptr
+int32_t tetrisEnvSetBuffers(TetrisEnv* env, const TetrisEnvBuffers* buffers)
+{
+	if (!buffers || !buffers->board || !buffers->shapes || !buffers->heights || !buffers->rewards || !buffers->dones)
+		return -1;
+	env->buffers = *buffers;
+	env->hasBuffers = true;
+	env->forEachGame([env](int first, int end) {
+		for (int game = first; game < end; game++)
+		{
+			env->writeObservation(game, 0.0f);
+		}
+	});
+	return 0;
+}
+
+// start new games
+// - param 1: the environment
+// - param 2: envCount seeds, game i is seeded with seeds[i]
+// - param 3: envCount flags, only the games whose flag isn't 0 are reset (nullptr: every game)
+// - return: 0, or -1 if the buffers aren't set
+int32_t tetrisEnvReset(TetrisEnv* env, const uint64_t* seeds, const uint8_t* resetMask)
+{
+	if (!env->hasBuffers)
+		return -1;
+	env->forEachGame([env, seeds, resetMask](int first, int end) {
+		for (int game = first; game < end; game++)
+		{
+			if (!resetMask || resetMask[game])
+			{
+				env->batch.reset(game, seeds[game]);
+				env->writeObservation(game, 0.0f);
+			}
+		}
+	});
+	return 0;
+}
+
+// play one placement in every game
+// - param 1: the environment
+// - param 2: envCount actions, actions[i] for game i (one out of range is a plain hard drop)
+// - return: 0, or -1 if the buffers aren't set
+int32_t tetrisEnvStep(TetrisEnv* env, const int32_t* actions)
+{
+	if (!env->hasBuffers)
+		return -1;
+	env->forEachGame([env, actions](int first, int end) {
+		env->batch.stepPlacements(actions, first, end);
+		const std::int32_t* scores = env->batch.getScores();
+		for (int game = first; game < end; game++)
+		{
+			env->writeObservation(game, static_cast<float>(scores[game] - env->previousScores[game]));
+		}
+	});
+	return 0;
+}
+
+// every game's score (envCount values, valid until the environment is freed)
+const int32_t* tetrisEnvGetScores(const TetrisEnv* env)
+{
+	return env->batch.getScores();
+}
+
+// every game's rows removed (envCount values, valid until the environment is freed)
+const int32_t* tetrisEnvGetLinesCleared(const TetrisEnv* env)
+{
+	return env->batch.getLinesCleared();
+}
@@ -0,0 +1,100 @@
+/* The TetrisEnv API is a C interface (a stable ABI, callable from another language,
+ * eg: Python with ctypes) to many games played placement by placement, for training
+ * bots (reinforcement learning) in a separate trainer process.
+ *
+ * An environment holds envCount games (a BatchEnvironment, so the rules are exactly
+ * those of TetrisEngine).  An action is a placement of the current shape:
+ * rotation * TETRIS_ENV_COLUMNS + x, which rotates the shape, slides it to column x &
+ * hard drops it.  The action mask tells which actions reach their placement exactly.
+ *
+ * The caller owns the observation memory: it passes its buffers once
+ * (tetrisEnvSetBuffers()), and every reset & step writes straight into them (eg: into
+ * numpy arrays), nothing is allocated or copied per step.  For game i:
+ *   board       [i * ROWS * COLUMNS + y * COLUMNS + x], 1 for a locked block, 0 if empty
+ *   shapes      [i * 2] the current shape & [i * 2 + 1] the next one (TetShape values)
+ *   heights     [i * COLUMNS + x], the height of column x
+ *   actionMasks [i * ACTIONS + action], 1 if the action is exact (optional, may be NULL)
+ *   rewards     [i], the score the last step added
+ *   dones       [i], 1 once the game is over
+ *
+ * reset & step are vectorized: one call runs every game, split over the environment's
+ * threads.  A game that is over stays over (its actions are ignored) until it's reset.
+ */
+
+#ifndef TETRISENV_H
+#define TETRISENV_H
+
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(TETRIS_ENV_EXPORTS)
+#define TETRIS_ENV_API __declspec(dllexport)
+#elif defined(__GNUC__)
+#define TETRIS_ENV_API __attribute__((visibility("default")))
+#else
+#define TETRIS_ENV_API
+#endif
+
+#define TETRIS_ENV_VERSION 1		/* changes whenever the interface does */
+#define TETRIS_ENV_ROWS 19			/* Gameboard::MAX_Y */
+#define TETRIS_ENV_COLUMNS 10		/* Gameboard::MAX_X */
+#define TETRIS_ENV_ACTIONS 40		/* the rotations times the columns */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* an environment (opaque) */
+typedef struct TetrisEnv TetrisEnv;
+
+/* the caller's observation buffers (see the layout above) */
+typedef struct TetrisEnvBuffers
+{
+	uint8_t* board;
+	uint8_t* shapes;
+	uint8_t* heights;
+	uint8_t* actionMasks;
+	float* rewards;
+	uint8_t* dones;
+} TetrisEnvBuffers;
+
+/* the TETRIS_ENV_VERSION the library was built with */
+TETRIS_ENV_API int32_t tetrisEnvGetVersion(void);
+
+/* make an environment
+ * - param 1: the number of games (>= 1)
+ * - param 2: the RandomizerPolicy (0: uniform, 1: seven bag, 2: bag with history)
+ * - param 3: the number of threads (0 to use every hardware thread, 1 for the calling thread)
+ * - return: the environment, NULL if a parameter is out of range */
+TETRIS_ENV_API TetrisEnv* tetrisEnvCreate(int32_t envCount, int32_t randomizerPolicy, int32_t threadCount);
+
+/* free an environment (NULL is ignored) */
+TETRIS_ENV_API void tetrisEnvDestroy(TetrisEnv* env);
+
+/* the number of games */
+TETRIS_ENV_API int32_t tetrisEnvGetCount(const TetrisEnv* env);
+
+/* set the buffers every reset & step writes to (they must outlive their use), and
+ * write the current observations into them
+ * - return: 0, or -1 if a required buffer is NULL */
+TETRIS_ENV_API int32_t tetrisEnvSetBuffers(TetrisEnv* env, const TetrisEnvBuffers* buffers);
+
+/* start new games
+ * - param 2: envCount seeds, game i is seeded with seeds[i]
+ * - param 3: envCount flags, only the games whose flag isn't 0 are reset (NULL: every game)
+ * - return: 0, or -1 if the buffers aren't set */
+TETRIS_ENV_API int32_t tetrisEnvReset(TetrisEnv* env, const uint64_t* seeds, const uint8_t* resetMask);
+
+/* play one placement in every game
+ * - param 2: envCount actions, actions[i] for game i (one out of range is a plain hard drop)
+ * - return: 0, or -1 if the buffers aren't set */
+TETRIS_ENV_API int32_t tetrisEnvStep(TetrisEnv* env, const int32_t* actions);
+
+/* every game's score & rows removed (envCount values, valid until the environment is freed) */
+TETRIS_ENV_API const int32_t* tetrisEnvGetScores(const TetrisEnv* env);
+TETRIS_ENV_API const int32_t* tetrisEnvGetLinesCleared(const TetrisEnv* env);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TETRISENV_H */
@@ -3,57 +3,76 @@
 
 const int TetrisGame::BLOCK_WIDTH{32};			  // pixel width of a tetris block, init to 32
 const int TetrisGame::BLOCK_HEIGHT{32};			  // pixel height of a tetris block, int to 32
-const double TetrisGame::MAX_SECONDS_PER_TICK{0.75}; // the slowest "tick" rate (in seconds), init to 0.75
-const double TetrisGame::MIN_SECONDS_PER_TICK{0.20}; // the fastest "tick" rate (in seconds), init to 0.20
 
 // Draw anything to do with the game,
 //   includes the board, currentShape, nextShape, score
 //   called every game loop
+//   The locked board blocks are cached in boardVertices; the moving blocks
+//   (ghost, current & next shape) are batched into blockVertices each frame.
+//   Each batch is drawn with a single window.draw() call.
 // - params: none
 // - return: nothing
 void TetrisGame::draw(){
-	drawTetromino(currentShape, gameboardOffset);
 	drawGameboard();
-	drawTetromino(nextShape, nextShapeOffset, true);
+	window.draw(boardVertices, blockSprite.getTexture());
+
+	blockVertices.clear();
+	drawGhostTetromino(gameboardOffset);
+	drawTetromino(engine.getCurrentShape(), gameboardOffset);
+	drawTetromino(engine.getNextShape(), nextShapeOffset, true);
+	window.draw(blockVertices, blockSprite.getTexture());
+
 	window.draw(scoreText);
 	window.draw(scoreHighlight);
-	drawGhostTetromino(currentShape, gameboardOffset);
 }
 
 // Event and game loop processing
 // handles keypress events (up, left, right, down, space)
+//   by applying the matching GameAction to the engine (& counting the key for finesse).
+//   A toggles the auto player (if there is one); the other keys are ignored while it plays.
 // - param 1: sf::Event event
 // - return: nothing
 void TetrisGame::onKeyPressed(const sf::Event& event){
-	if (event.key.code == sf::Keyboard::Up) {
-		attemptRotate(currentShape);
+	if (event.key.code == sf::Keyboard::A) {
+		if (autoPlayer) {
+			autoPlaying = !autoPlaying;
+			autoPlayer->reset(engine.getSeed());
+		}
+	}
+	else if (autoPlaying) {
+		return;
+	}
+	else if (event.key.code == sf::Keyboard::Up) {
+		applyAction(GameAction::ROTATE);
+		keysForShape++;
 	}
 	else if (event.key.code == sf::Keyboard::Left) {
-		attemptMove(currentShape, -1, 0);
+		applyAction(GameAction::MOVE_LEFT);
+		keysForShape++;
 	}
 	else if (event.key.code == sf::Keyboard::Right) {
-		attemptMove(currentShape, 1, 0);
+		applyAction(GameAction::MOVE_RIGHT);
+		keysForShape++;
 	}
 	else if (event.key.code == sf::Keyboard::Down) {
-		if (!attemptMove(currentShape, 0, 1)) {
-			lock(currentShape);
-		}
+		applyAction(GameAction::SOFT_DROP);
+		keysForShape++;
 	}
-
 	else if (event.key.code == sf::Keyboard::Space) {
-		drop(currentShape);
-		lock(currentShape);
+		applyAction(GameAction::HARD_DROP);
+		keysForShape++;
 	}
 }
 
 // called every game loop to handle ticks & tetromino placement (locking)
+//   Turn the time that passed into whole engine frames & step() the engine
+//   (or, while the auto player plays, apply its action & step every frame), then:
+//   - if the game is over, reset() for a new game
+//   - if a shape was placed, show any rows it cleared, score the player's keys
+//     for it (finesse) & update the score.
 // - param 1: float secondsSinceLastLoop
 // return: nothing
 void TetrisGame::processGameLoop(float secondsSinceLastLoop){
-	secondsSinceLastTick += secondsSinceLastLoop;
-	//double secondsSinceRowClear{ 0.0 };
-	//bool rowClearedSinceLastGameLoop{ false };
-
 	if (rowClearedSinceLastGameLoop) {
 		secondsSinceRowClear += secondsSinceLastLoop;
 		if (secondsSinceRowClear >= 1.25) {
@@ -64,227 +83,197 @@ void TetrisGame::processGameLoop(float secondsSinceLastLoop){
 		}
 	}
 
-	if (secondsSinceLastTick >= secondsPerTick) {
-		secondsSinceLastTick -= secondsPerTick;
-		tick();
+	// the shape that can lock during these frames (ticks only move it down, so it
+	// locks with this rotation & x)
+	const GridTetromino shapeBeforeStep = engine.getCurrentShape();
+
+	// the engine only knows frames: step it once per whole frame that passed
+	secondsSinceLastFrame += secondsSinceLastLoop;
+	const int frames = static_cast<int>(secondsSinceLastFrame * TetrisEngine::FRAMES_PER_SECOND);
+	secondsSinceLastFrame -= static_cast<double>(frames) / TetrisEngine::FRAMES_PER_SECOND;
+	if (autoPlaying) {
+		for (int i{}; i < frames && !engine.isGameOver(); i++) {
+			applyAction(autoPlayer->chooseAction(engine));
+			engine.stepFrame();
+		}
+	}
+	else {
+		engine.step(frames);
 	}
 
-	if (shapePlacedSinceLastGameLoop) {
-		shapePlacedSinceLastGameLoop = false;
-		if (spawnNextShape()) {
-			pickNextShape();
-			int rowsRemoved = board.removeCompletedRows();
-
-			if (rowsRemoved >= 1) {
-				rowClearedSinceLastGameLoop = true;
-			}
-
-			determineSecondsPerTick();
-			switch (rowsRemoved) {
-			case 1:
-				score += 40;
-				scoreText.setCharacterSize(20);
-				scoreHighlight.setString("Nice.");
-				scoreHighlight.setFillColor(sf::Color(0, 0, 255, 255));
-				break;
-			case 2:
-				score += 100;
-				scoreText.setCharacterSize(22);
-				scoreHighlight.setString("Good.");
-				scoreHighlight.setFillColor(sf::Color(0, 255, 0, 255));
-				break;
-			case 3:
-				score += 300;
-				scoreText.setCharacterSize(24);
-				scoreHighlight.setString("Wow!");
-				scoreHighlight.setFillColor(sf::Color(255, 0, 0, 255));
-				break;
-			case 4:
-				score += 1200;
-				scoreText.setCharacterSize(26);
-				scoreHighlight.setFillColor(sf::Color(255, 0, 255, 255));
-				scoreHighlight.setString("Incredible!");
-				break;
-			default:
-				score += 1;
-			}
-			updateScoreDisplay();
+	if (engine.isGameOver()) {
+		replay.finish(engine);
+		if (!replayPath.empty()) {
+			replay.save(replayPath);
 		}
-		else {
-			reset();
+		reset();
+	}
+	else if (engine.getPlacementCount() != placementsShown) {
+		placementsShown = engine.getPlacementCount();
+		if (!autoPlaying) {
+			finesse.addPlacement(shapeBeforeStep.getShape(), shapeBeforeStep.getRotation(), shapeBeforeStep.getGridLoc().getX(), keysForShape);
 		}
+		keysForShape = 0;
+		highlightRowsCleared(engine.getRowsClearedLastPlacement());
+		updateScoreDisplay();
 	}
 }
 
-// A tick() forces the currentShape to move (if there were no tick,
-// the currentShape would float in position forever). This should
-// call attemptMove() on the currentShape.  If not successful, lock() 
-// the currentShape (it can move no further).
-// - params: none
-// - return: nothing
-void TetrisGame::tick(){
-	if (!attemptMove(currentShape, 0, 1)) {
-		lock(currentShape);
-	}
+// the game state & rules this view draws
+const TetrisEngine& TetrisGame::getEngine() const {
+	return engine;
 }
 
-// reset everything for a new game (use existing functions) 
-//  - set the score to 0 and call updateScoreDisplay()
-//  - call determineSecondsPerTick() to determine the tick rate.
-//  - clear the gameboard,
-//  - pick & spawn next shape
-//  - pick next shape again (for the "on-deck" shape)
-// - params: none
+// set the bot that plays when A is pressed (it has to outlive the game)
+// - param 1: a GamePolicy, or nullptr for none
 // - return: nothing
-void TetrisGame::reset(){
-	score = 0;
-	updateScoreDisplay();
-	determineSecondsPerTick();
-	board.empty();
-	pickNextShape();
-	spawnNextShape();
-	pickNextShape();
+void TetrisGame::setAutoPlayer(GamePolicy* player) {
+	autoPlayer = player;
+	autoPlaying = autoPlaying && player;
 }
 
-// assign nextShape.setShape a new random shape  
-// - params: none
+// save every finished game's replay to a file (overwritten by the next game)
+// - param 1: the file's path, or "" not to save replays
 // - return: nothing
-void TetrisGame::pickNextShape(){
-	nextShape.setShape(GridTetromino::getRandomShape());
+void TetrisGame::setReplayPath(const std::string& path) {
+	replayPath = path;
 }
 
-// copy the nextShape into the currentShape (through assignment)
-//   position the currentShape to its spawn location.
+// reset everything for a new game
+//  - reset the engine (from a new seed, derived from the last one) & the finesse counts
+//  - start recording the new game's replay
+//  - clear the score highlight & call updateScoreDisplay()
 // - params: none
-// - return: bool, true/false based on isPositionLegal()
-bool TetrisGame::spawnNextShape() {
-	GridTetromino t = nextShape;
-	t.setGridLoc(board.getSpawnLoc());
-	if (isPositionLegal(t))
-	{
-		currentShape = nextShape;
-		currentShape.setGridLoc(board.getSpawnLoc());
-		return true;
-	}
-	return false;
-}
-
-// Test if a rotation is legal on the tetromino and if so, rotate it. 
-//  To accomplish this:
-//	 1) create a (local) temporary copy of the tetromino
-//	 2) rotate it (temp.rotateClockwise())
-//	 3) test if temp rotation was legal (isPositionLegal()), on
-//      if so - rotate the original tetromino.
-// - param 1: GridTetromino shape
-// - return: bool, true/false to indicate successful movement
-bool TetrisGame::attemptRotate(GridTetromino& shape) { 
-	GridTetromino temp = shape;
-	temp.rotateClockwise();
-	if (isPositionLegal(temp)) {
-		shape.rotateClockwise();
-		return true;
+// - return: nothing
+void TetrisGame::reset(){
+	engine.reset(Random::deriveSeed(engine.getSeed(), 1));
+	replay.start(engine.getSeed(), engine.getRandomizerPolicy());
+	if (autoPlayer) {
+		autoPlayer->reset(engine.getSeed());
 	}
-	return false;
+	placementsShown = engine.getPlacementCount();
+	finesse.reset();
+	keysForShape = 0;
+	rowClearedSinceLastGameLoop = false;
+	secondsSinceRowClear = 0;
+	scoreHighlight.setString("");
+	scoreText.setCharacterSize(characterSize);
+	updateScoreDisplay();
 }
 
-// test if a move is legal on the tetromino, if so, move it.
-//  To do this:
-//	 1) create a (local) temporary copy of the tetromino
-//	 2) move it (temp.move())
-//	 3) test if temp move was legal (isPositionLegal(),
-//      if so - move the original.	
-// - param 1: GridTetromino shape
-// - param 2: int x{}
-// - param 3: int y{}
-// - return: true/false to indicate successful movement
-bool TetrisGame::attemptMove(GridTetromino& shape, int x, int y) { 
-	GridTetromino temp = shape;
-	temp.move(x,y);
-	if (isPositionLegal(temp)) {
-		shape.move(x, y);
-		return true;
+// highlight the rows the last placement cleared (if any)
+//   grow the score text & show a message that fits the number of rows
+// - param 1: int rows removed by the placement
+// - return: nothing
+void TetrisGame::highlightRowsCleared(int rowsRemoved){
+	if (rowsRemoved >= 1) {
+		rowClearedSinceLastGameLoop = true;
 	}
-	return false;
-}
 
-// drops the tetromino vertically as far as it can 
-//   legally go.  Use attemptMove(). This can be done in 1 line.
-// - param 1: GridTetromino shape
-// - return: int of levels dropped.
-int TetrisGame::drop(GridTetromino& shape){
-	int counter{ 0 };
-	while (attemptMove(shape, 0, 1)) {
-		counter++; 
+	switch (rowsRemoved) {
+	case 1:
+		scoreText.setCharacterSize(20);
+		scoreHighlight.setString("Nice.");
+		scoreHighlight.setFillColor(sf::Color(0, 0, 255, 255));
+		break;
+	case 2:
+		scoreText.setCharacterSize(22);
+		scoreHighlight.setString("Good.");
+		scoreHighlight.setFillColor(sf::Color(0, 255, 0, 255));
+		break;
+	case 3:
+		scoreText.setCharacterSize(24);
+		scoreHighlight.setString("Wow!");
+		scoreHighlight.setFillColor(sf::Color(255, 0, 0, 255));
+		break;
+	case 4:
+		scoreText.setCharacterSize(26);
+		scoreHighlight.setFillColor(sf::Color(255, 0, 255, 255));
+		scoreHighlight.setString("Incredible!");
+		break;
 	}
-	return counter;
 }
 
-// copy the contents (color) of the tetromino's mapped block locs to the grid.
-	//	 1) get the tetromino's mapped locs via tetromino.getBlockLocsMappedToGrid()
-	//   2) use the board's setContent() method to set the content at the mapped locations.
-	//   3) record the fact that we placed a shape by setting shapePlacedSinceLastGameLoop
-	//      to true
-	// - param 1: GridTetromino shape
-	// - return: nothing
-void TetrisGame::lock(const GridTetromino& shape){
-	board.setContent(shape.getBlockLocsMappedToGrid(), static_cast<int>(shape.getColor()));
-	shapePlacedSinceLastGameLoop = true;
+// apply a GameAction to the engine & record it in the replay
+// - param 1: the action
+// - return: nothing
+void TetrisGame::applyAction(GameAction action) {
+	replay.addInput(engine.getFrame(), action);
+	engine.applyAction(action);
 }
 
 // Graphics methods ==============================================
 
-// Draw a tetris block sprite on the canvas		
+// precompute the tile (sub-rect) of blockSprite's texture for each TetColor.
+//   The texture itself (images/tiles.png) is loaded once in main() and shared
+//   through blockSprite, so drawing a block never touches the disk.
+// - params: none
+// - return: nothing
+void TetrisGame::setupBlockTextureRects() {
+	assert(blockSprite.getTexture() != nullptr && "blockSprite has no texture (images/tiles.png)");
+	for (int i{}; i < COLOR_COUNT; i++) {
+		blockTextureRects[i] = sf::IntRect(i * BLOCK_WIDTH, 0, BLOCK_WIDTH, BLOCK_HEIGHT);
+	}
+}
+
+// Add a tetris block to a batch of block quads (boardVertices or blockVertices)
 // The block position is specified in terms of 2 offsets: 
 //    1) the top left (of the gameboard in pixels)
 //    2) an x & y offset into the gameboard - in blocks (not pixels)
 //       meaning they need to be multiplied by BLOCK_WIDTH and BLOCK_HEIGHT
 //       to get the pixel offset.
-//	 1) set the block color using blockSprite.setTextureRect()
-//   2) set the block location using blockSprite.setPosition()   
-//	 3) draw the block using window.draw()
-//   For details/instructions on these 3 operations see:
-//       www.sfml-dev.org/tutorials/2.5/graphics-sprite.php
-//       use member variables: window and blockSprite (assigned in constructor)
-// param 1: Point topLeft
-// param 2: int xOffset
-// param 3: int yOffset
-// param 4: TetColor color
+//	 1) the quad's texture coords come from blockTextureRects[color]
+//   2) the quad's corners come from the pixel offset (& block size)
+//	 3) nothing is drawn here, draw() draws the whole batch at once.
+//   For details on vertex arrays see:
+//       www.sfml-dev.org/tutorials/2.5/graphics-vertex-array.php
+// param 1: sf::VertexArray the batch to add the block to
+// param 2: Point topLeft
+// param 3: int xOffset
+// param 4: int yOffset
+// param 5: TetColor color
+// param 6: bool ghost, draw the block translucent (for the ghost tetromino)
 // return: nothing
-void TetrisGame::drawBlock(const Point& topLeft, int xOffset, int yOffset, const TetColor& color, bool ghost){
-	sf::Texture texture;
-
-	int colorIndex{static_cast<int>(color) * BLOCK_WIDTH};
-
-	if (!texture.loadFromFile("images/tiles.png", sf::IntRect(colorIndex, 0, 32, 32)))
-	{
-		std::cout << "Error loading texture.";
-	}
-	texture.setSmooth(false);
-	texture.setRepeated(false);
-
-	sf::Sprite sprite;
-	sprite.setTexture(texture);
-	if(ghost)
-		sprite.setColor(sf::Color(255, 255, 255, 70));
-	sprite.setPosition(topLeft.getX() + (xOffset * BLOCK_WIDTH), topLeft.getY() + (yOffset * BLOCK_WIDTH));
-
-
-	sprite.setTextureRect(sf::IntRect(0, 0, BLOCK_WIDTH, BLOCK_HEIGHT));
-	window.draw(sprite);
+void TetrisGame::drawBlock(sf::VertexArray& vertices, const Point& topLeft, int xOffset, int yOffset, const TetColor& color, bool ghost){
+	const sf::IntRect& tile = blockTextureRects[static_cast<int>(color)];
+	const sf::Color tint = ghost ? sf::Color(255, 255, 255, GHOST_ALPHA) : sf::Color::White;
+
+	const float left = static_cast<float>(topLeft.getX() + (xOffset * BLOCK_WIDTH));
+	const float top = static_cast<float>(topLeft.getY() + (yOffset * BLOCK_HEIGHT));
+	const float right = left + BLOCK_WIDTH;
+	const float bottom = top + BLOCK_HEIGHT;
+
+	const float texLeft = static_cast<float>(tile.left);
+	const float texTop = static_cast<float>(tile.top);
+	const float texRight = static_cast<float>(tile.left + tile.width);
+	const float texBottom = static_cast<float>(tile.top + tile.height);
+
+	vertices.append(sf::Vertex(sf::Vector2f(left, top), tint, sf::Vector2f(texLeft, texTop)));
+	vertices.append(sf::Vertex(sf::Vector2f(right, top), tint, sf::Vector2f(texRight, texTop)));
+	vertices.append(sf::Vertex(sf::Vector2f(right, bottom), tint, sf::Vector2f(texRight, texBottom)));
+	vertices.append(sf::Vertex(sf::Vector2f(left, bottom), tint, sf::Vector2f(texLeft, texBottom)));
 }
 
 
 
 // Draw the gameboard blocks on the window
+//   The blocks are kept in boardVertices, which is only rebuilt when the
+//   board's generation changed (a lock or a row clear):
 //   Iterate through each row & col, use drawBlock() to 
 //   draw a block if it isn't empty.
 // params: none
 // return: nothing
 void TetrisGame::drawGameboard(){
+	const Gameboard& board = engine.getBoard();
+	if (boardVerticesGeneration == board.getGeneration())
+		return;
+	boardVerticesGeneration = board.getGeneration();
+
+	boardVertices.clear();
 	for (int x{}; x < board.MAX_X; x++) {
 		for (int y{}; y < board.MAX_Y; y++) {
 			if (board.getContent(x, y) != board.EMPTY_BLOCK) {
-				drawBlock(gameboardOffset, x, y, static_cast<TetColor>(board.getContent(x,y)));
+				drawBlock(boardVertices, gameboardOffset, x, y, static_cast<TetColor>(board.getContent(x,y)));
 			}
 		}
 	}
@@ -298,22 +287,26 @@ void TetrisGame::drawGameboard(){
 // param 2: Point topLeft
 // return: nothing
 void TetrisGame::drawTetromino(const GridTetromino& tetromino, const Point& topLeft, bool alwaysPrintFull){
-	for (Point p : tetromino.getBlockLocsMappedToGrid()) {
+	for (const Point& p : tetromino.getMappedBlockLocs()) {
 		if (!alwaysPrintFull)
 			if (p.getY() < 0)
 				continue;
-	drawBlock(topLeft, p.getX(), p.getY(), tetromino.getColor());
+	drawBlock(blockVertices, topLeft, p.getX(), p.getY(), tetromino.getColor());
 	}
 }
 
-void TetrisGame::drawGhostTetromino(GridTetromino& tetromino, const Point& topLeft) {
-	GridTetromino ghost = tetromino;
+// Draw the ghost of the current tetromino (where a hard drop would place it)
+//   translucent, unless it is close (less than 5 rows) to the tetromino.
+// param 1: Point topLeft
+// return: nothing
+void TetrisGame::drawGhostTetromino(const Point& topLeft) {
+	const GridTetromino ghost = engine.getGhostShape();
 	
-	int layersDropped = drop(ghost);
+	int layersDropped = ghost.getGridLoc().getY() - engine.getCurrentShape().getGridLoc().getY();
 
 	if (layersDropped >= 5) {
-		for (Point p : ghost.getBlockLocsMappedToGrid()) {
-			drawBlock(topLeft, p.getX(), p.getY(), ghost.getColor(), true);
+		for (const Point& p : ghost.getMappedBlockLocs()) {
+			drawBlock(blockVertices, topLeft, p.getX(), p.getY(), ghost.getColor(), true);
 		}
 	}
 }
@@ -324,62 +317,7 @@ void TetrisGame::drawGhostTetromino(GridTetromino& tetromino, const Point& topLe
 // params: none:
 // return: nothing
 void TetrisGame::updateScoreDisplay(){
-	std::string scoreStr = "score: "  + std::to_string(score);
+	std::string scoreStr = "score: "  + std::to_string(engine.getScore()) +
+		"\nfinesse faults: " + std::to_string(finesse.getFaultCount());
 	scoreText.setString(scoreStr);
 }
-
-// State & gameplay/logic methods ================================
-
-// Determine if a Tetromino can legally be placed at its current position
-// on the gameboard.
-//   Tip: Make use of Gameboard's areLocsEmpty() and pass it the shape's mapped locs.
-// - param 1: GridTetromino shape
-// - return: bool, true if shape is within borders (isWithinBorders()) and 
-//           the shape's mapped board locs are empty (false otherwise).
-bool TetrisGame::isPositionLegal(const GridTetromino& shape) const {
-	if (!isWithinBorders(shape)) { return false; }
-	if (!board.areAllLocsEmpty(shape.getBlockLocsMappedToGrid())) { return false; }
-	return true;
-
-}
-
-
-// Determine if the shape is within the left, right, & bottom gameboard borders
-//   * Ignore the upper border because we want shapes to be able to drop
-//     in from the top of the gameboard.
-//   All of a shape's blocks must be inside these 3 borders to return true
-// - param 1: GridTetromino shape
-// - return: bool, true if the shape is within the left, right, and lower border
-//	         of the grid, but *NOT* the top border (false otherwise)
-bool TetrisGame::isWithinBorders(const GridTetromino& shape) const { 
-	for (Point p : shape.getBlockLocsMappedToGrid()) {
-		if (!(p.getX() < board.MAX_X && p.getX() >= 0)) { return false; }
-		if (!(p.getY() < board.MAX_Y)) { return false; }
-	}
-	return true;
-}
-
-
-// set secsPerTick 
-//   - basic: use MAX_SECS_PER_TICK
-//   - advanced: base it on score (higher score results in lower secsPerTick)
-// params: none
-// return: nothing
-void TetrisGame::determineSecondsPerTick(){
-	if (score <= 100)
-		secondsPerTick = MAX_SECONDS_PER_TICK;
-	else if (score > 100)
-		secondsPerTick = 0.55;
-	else if (score > 300)
-		secondsPerTick = 0.45;
-	else if (score > 500)
-		secondsPerTick = 0.35;
-	else if (score > 1000)
-		secondsPerTick = 0.30;
-	else if (score > 3000)
-		secondsPerTick = 0.25;
-	else if (score > 10000)
-		secondsPerTick = 0.20;
-
-}
-
@@ -1,26 +1,38 @@
-// This class encapsulates the tetris game and its drawing routines, gameplay, & control logic.
+// This class encapsulates the tetris game's drawing routines & control logic.
 // This class was designed so with the idea of potentially instantiating 2 of them
 // and have them run side by side (player vs player).
 // So, anything you would need for an individual tetris game has been included here.
 // Anything you might use between games (like the background, or the sprite used for 
 // rendering a tetromino block) was left in main.cpp
+//
+// The game state and rules (board, shapes, scoring, ticks, locking) live in a
+// TetrisEngine, which has no SFML dependency (and can run without a display).
+// This class is the SFML view on top of it.
 // 
 // This class is responsible for:
-//   - setting up the board,
 //	 - drawing game elements to the screen
-//   - spawning tetrominoes,
-//   - handling user input,
-//   - moving and placing tetrominoes 
+//   - handling user input (turning key presses into GameActions),
+//   - or letting a bot (a GamePolicy, eg: an AIPlayer) play instead, one action per frame,
+//   - feeding the engine the time that passed every game loop,
+//   - highlighting cool stuff the player does (row clears)
+//   - scoring the player's finesse (the keys pressed per shape, see FinesseAnalyzer)
+//   - recording every game (its seed & the actions applied, see Replay)
 //
 //  [expected .cpp size: ~ 275 lines]
 
 #ifndef TETRISGAME_H
 #define TETRISGAME_H
 
+#include "FinesseAnalyzer.h"
+#include "GamePolicy.h"
 #include "Gameboard.h"
 #include "GridTetromino.h"
+#include "Random.h"
+#include "Replay.h"
+#include "TetrisEngine.h"
 #include <SFML/Graphics.hpp>
 #include <assert.h>
+#include <string>
 
 
 class TetrisGame
@@ -29,21 +41,29 @@ public:
 	// STATIC CONSTANTS
 	static const int BLOCK_WIDTH;			  // pixel width of a tetris block, init to 32
 	static const int BLOCK_HEIGHT;			  // pixel height of a tetris block, int to 32
-	static const double MAX_SECONDS_PER_TICK; // the slowest "tick" rate (in seconds), init to 0.75
-	static const double MIN_SECONDS_PER_TICK; // the fastest "tick" rate (in seconds), init to 0.20
+	static const int COLOR_COUNT{ 7 };		  // the number of TetColors (tiles) in images/tiles.png
+	static const int GHOST_ALPHA{ 70 };		  // the alpha (0-255) the ghost tetromino is drawn with
 
 private:	
 	// MEMBER VARIABLES
 
 	// State members ---------------------------------------------
-	int score;					// the current game score.
-    Gameboard board;			// the gameboard (grid) to represent where all the blocks are.
-    GridTetromino nextShape;	// the tetromino shape that is "on deck".
-    GridTetromino currentShape;	// the tetromino that is currently falling.
+	TetrisEngine engine;		// the game state & rules (board, shapes, score, ticks).
+	int placementsShown{ 0 };	// the engine's placement count when we last looked at it.
+	GamePolicy* autoPlayer{ nullptr };	// the bot that can play instead of the keyboard (not owned)
+	bool autoPlaying{ false };			// true while the bot is playing
+	FinesseAnalyzer finesse;			// the player's placements, scored against the fewest keys
+	int keysForShape{ 0 };				// the keys pressed since the current shape spawned
+	Replay replay;						// the game being played, recorded
+	std::string replayPath;				// the file finished games are saved to ("" for none)
 	
 	// Graphics members ------------------------------------------
 	sf::Sprite& blockSprite;		// the sprite used for all the blocks.
 	sf::RenderWindow& window;		// the window that we are drawing on.
+	sf::IntRect blockTextureRects[COLOR_COUNT];	// the tile of blockSprite's texture for each TetColor
+	sf::VertexArray boardVertices{ sf::Quads };	// the locked board blocks, only rebuilt when the board changes
+	unsigned int boardVerticesGeneration{ 0 };	// the board generation boardVertices was built from
+	sf::VertexArray blockVertices{ sf::Quads };	// the moving blocks (ghost, current & next shape) of a frame
 	const Point gameboardOffset;	// pixel XY offset of the gameboard on the screen
 	const Point nextShapeOffset;	// pixel XY offset to the nextShape
 
@@ -54,28 +74,22 @@ private:
 	int highlightCharacterSize = 28;
 									
 	// Time members ----------------------------------------------
-	// Note: a "tick" is the amount of time it takes a block to fall one line.
-	double secondsPerTick = MAX_SECONDS_PER_TICK; // the seconds per tick (changes depending on score)	
-
-	double secondsSinceLastTick{ 0.0 };			// update this every game loop until it is >= secsPerTick,
-												// we then know to trigger a tick.  Reduce this var (by a tick) & repeat.
-	bool shapePlacedSinceLastGameLoop{ false };	// Tracks whether we have placed (locked) a shape on
-												// the gameboard in the current gameloop	
 	double secondsSinceRowClear{0.0};
+	double secondsSinceLastFrame{ 0.0 };	// wall-clock time not yet turned into engine frames
 	bool rowClearedSinceLastGameLoop{ false };
 public:
 	// MEMBER FUNCTIONS
 
 	// constructor
 	//   initialize/assign private member vars names that match param names
-	//   reset() the game
+	//   (the engine resets itself on construction, its shapes are picked from seed)
 	//   load font from file: fonts/RedOctober.ttf
 	//   setup scoreText
 	// - params: already specified
-	TetrisGame(sf::RenderWindow& window, sf::Sprite& blockSprite, const Point& gameboardOffset, const Point& nextShapeOffset):
-	window{ window }, blockSprite{ blockSprite }, gameboardOffset{ gameboardOffset }, nextShapeOffset{ nextShapeOffset } 
+	TetrisGame(sf::RenderWindow& window, sf::Sprite& blockSprite, const Point& gameboardOffset, const Point& nextShapeOffset, std::uint64_t seed = 0):
+	engine{ seed }, window{ window }, blockSprite{ blockSprite }, gameboardOffset{ gameboardOffset }, nextShapeOffset{ nextShapeOffset } 
 	{
-		reset();
+		setupBlockTextureRects();
 		if (!scoreFont.loadFromFile("fonts/RedOctober.ttf"))
 		{
 			assert(false && "Missing font: RedOctober.ttf");
@@ -91,115 +105,103 @@ public:
 		scoreText.setCharacterSize(characterSize);
 		scoreText.setFillColor(sf::Color::White);
 		scoreText.setPosition(425, 325);
+		updateScoreDisplay();
+		replay.start(engine.getSeed(), engine.getRandomizerPolicy());
 	}
 
 	// Draw anything to do with the game,
 	//   includes the board, currentShape, nextShape, score
 	//   called every game loop
+	//   The locked board blocks are cached in boardVertices; the moving blocks
+	//   (ghost, current & next shape) are batched into blockVertices each frame.
+	//   Each batch is drawn with a single window.draw() call.
 	// - params: none
 	// - return: nothing
 	void draw();								
 
 	// Event and game loop processing
 	// handles keypress events (up, left, right, down, space)
+	//   by applying the matching GameAction to the engine (& counting the key for finesse).
+	//   A toggles the auto player (if there is one); the other keys are ignored while it plays.
 	// - param 1: sf::Event event
 	// - return: nothing
 	void onKeyPressed(const sf::Event& event);
 
 	// called every game loop to handle ticks & tetromino placement (locking)
+	//   Turn the time that passed into whole engine frames & step() the engine
+	//   (or, while the auto player plays, apply its action & step every frame), then:
+	//   - if the game is over, reset() for a new game
+	//   - if a shape was placed, show any rows it cleared, score the player's keys
+	//     for it (finesse) & update the score.
 	// - param 1: float secondsSinceLastLoop
 	// return: nothing
 	void processGameLoop(float secondsSinceLastLoop);
 
-	// A tick() forces the currentShape to move (if there were no tick,
-	// the currentShape would float in position forever). This should
-	// call attemptMove() on the currentShape.  If not successful, lock() 
-	// the currentShape (it can move no further).
-	// - params: none
+	// the game state & rules this view draws
+	const TetrisEngine& getEngine() const;
+
+	// set the bot that plays when A is pressed (it has to outlive the game)
+	// - param 1: a GamePolicy, or nullptr for none
 	// - return: nothing
-	void tick();
+	void setAutoPlayer(GamePolicy* player);
+
+	// save every finished game's replay to a file (overwritten by the next game)
+	// - param 1: the file's path, or "" not to save replays
+	// - return: nothing
+	void setReplayPath(const std::string& path);
 
 private:
-	// reset everything for a new game (use existing functions) 
-	//  - set the score to 0 and call updateScoreDisplay()
-	//  - call determineSecondsPerTick() to determine the tick rate.
-	//  - clear the gameboard,
-	//  - pick & spawn next shape
-	//  - pick next shape again (for the "on-deck" shape)
+	// reset everything for a new game
+	//  - reset the engine (from a new seed, derived from the last one) & the finesse counts
+	//  - start recording the new game's replay
+	//  - clear the score highlight & call updateScoreDisplay()
 	// - params: none
 	// - return: nothing
 	void reset();
 
-	// assign nextShape.setShape a new random shape  
-	// - params: none
+	// apply a GameAction to the engine & record it in the replay
+	// - param 1: the action
 	// - return: nothing
-	void pickNextShape();
-	
-	// copy the nextShape into the currentShape (through assignment)
-	//   position the currentShape to its spawn location.
-	// - params: none
-	// - return: bool, true/false based on isPositionLegal()
-	bool spawnNextShape();																	
-
-	// Test if a rotation is legal on the tetromino and if so, rotate it. 
-	//  To accomplish this:
-	//	 1) create a (local) temporary copy of the tetromino
-	//	 2) rotate it (temp.rotateClockwise())
-	//	 3) test if temp rotation was legal (isPositionLegal()), 
-	//      if so - rotate the original tetromino.
-	// - param 1: GridTetromino shape
-	// - return: bool, true/false to indicate successful movement
-	bool attemptRotate(GridTetromino& shape);
-   
-	// test if a move is legal on the tetromino, if so, move it.
-	//  To do this:
-	//	 1) create a (local) temporary copy of the tetromino
-	//	 2) move it (temp.move())
-	//	 3) test if temp move was legal (isPositionLegal(),
-	//      if so - move the original.	
-	// - param 1: GridTetromino shape
-	// - param 2: int x;
-	// - param 3: int y;
-	// - return: true/false to indicate successful movement
-	bool attemptMove(GridTetromino& shape, int x, int y);												
-
-	// drops the tetromino vertically as far as it can 
-	//   legally go.  Use attemptMove(). This can be done in 1 line.
-	// - param 1: GridTetromino shape
-	// - return: nothing;
-	int drop(GridTetromino& shape);
+	void applyAction(GameAction action);
 
-	// copy the contents (color) of the tetromino's mapped block locs to the grid.
-		//	 1) get the tetromino's mapped locs via tetromino.getBlockLocsMappedToGrid()
-		//   2) use the board's setContent() method to set the content at the mapped locations.
-		//   3) record the fact that we placed a shape by setting shapePlacedSinceLastGameLoop
-		//      to true
-		// - param 1: GridTetromino shape
-		// - return: nothing
-	void lock(const GridTetromino& shape);
+	// highlight the rows the last placement cleared (if any)
+	//   grow the score text & show a message that fits the number of rows
+	// - param 1: int rows removed by the placement
+	// - return: nothing
+	void highlightRowsCleared(int rowsRemoved);
 	
 	// Graphics methods ==============================================
+
+	// precompute the tile (sub-rect) of blockSprite's texture for each TetColor.
+	//   The texture itself (images/tiles.png) is loaded once in main() and shared
+	//   through blockSprite, so drawing a block never touches the disk.
+	// - params: none
+	// - return: nothing
+	void setupBlockTextureRects();
 	
-	// Draw a tetris block sprite on the canvas		
+	// Add a tetris block to a batch of block quads (boardVertices or blockVertices)
 	// The block position is specified in terms of 2 offsets: 
 	//    1) the top left (of the gameboard in pixels)
 	//    2) an x & y offset into the gameboard - in blocks (not pixels)
 	//       meaning they need to be multiplied by BLOCK_WIDTH and BLOCK_HEIGHT
 	//       to get the pixel offset.
-	//	 1) set the block color using blockSprite.setTextureRect()
-	//   2) set the block location using blockSprite.setPosition()   
-	//	 3) draw the block using window.draw()
-	//   For details/instructions on these 3 operations see:
-	//       www.sfml-dev.org/tutorials/2.5/graphics-sprite.php
-	//       use member variables: window and blockSprite (assigned in constructor)
-	// param 1: Point topLeft
-	// param 2: int xOffset
-	// param 3: int yOffset
-	// param 4: TetColor color
+	//	 1) the quad's texture coords come from blockTextureRects[color]
+	//   2) the quad's corners come from the pixel offset (& block size)
+	//	 3) nothing is drawn here, draw() draws the whole batch at once.
+	//   For details on vertex arrays see:
+	//       www.sfml-dev.org/tutorials/2.5/graphics-vertex-array.php
+	// param 1: sf::VertexArray the batch to add the block to
+	// param 2: Point topLeft
+	// param 3: int xOffset
+	// param 4: int yOffset
+	// param 5: TetColor color
+	// param 6: bool ghost, draw the block translucent (for the ghost tetromino)
 	// return: nothing
-	void drawBlock(const Point& topLeft, int xOffset, int yOffset, const TetColor& color, bool ghost=false);
+	void drawBlock(sf::VertexArray& vertices, const Point& topLeft, int xOffset, int yOffset, const TetColor& color, bool ghost=false);
 										
 	// Draw the gameboard blocks on the window
+	//   The blocks are kept in boardVertices, which is only rebuilt when the
+	//   board's generation changed (a lock or a row clear):
 	//   Iterate through each row & col, use drawBlock() to 
 	//   draw a block if it isn't empty.
 	// params: none
@@ -215,7 +217,11 @@ private:
 	// return: nothing
 	void drawTetromino(const GridTetromino& tetromino, const Point& topLeft, bool alwaysPrintFull=false);
 
-	void drawGhostTetromino(GridTetromino& tetromino, const Point& topLeft);
+	// Draw the ghost of the current tetromino (where a hard drop would place it)
+	//   translucent, unless it is close (less than 5 rows) to the tetromino.
+	// param 1: Point topLeft
+	// return: nothing
+	void drawGhostTetromino(const Point& topLeft);
 	
 	// update the score display
 	// form a string "score: ##" to display the current score
@@ -224,35 +230,6 @@ private:
 	// return: nothing
 	void updateScoreDisplay();
 
-	// State & gameplay/logic methods ================================
-
-	// Determine if a Tetromino can legally be placed at its current position
-	// on the gameboard.
-	//   Tip: Make use of Gameboard's areLocsEmpty() and pass it the shape's mapped locs.
-	// - param 1: GridTetromino shape
-	// - return: bool, true if shape is within borders (isWithinBorders()) and 
-	//           the shape's mapped board locs are empty (false otherwise).
-	bool isPositionLegal(const GridTetromino& shape) const;
-
-	
-	// Determine if the shape is within the left, right, & bottom gameboard borders
-	//   * Ignore the upper border because we want shapes to be able to drop
-	//     in from the top of the gameboard.
-	//   All of a shape's blocks must be inside these 3 borders to return true
-	// - param 1: GridTetromino shape
-	// - return: bool, true if the shape is within the left, right, and lower border
-	//	         of the grid, but *NOT* the top border (false otherwise)
-	bool isWithinBorders(const GridTetromino& shape) const;
-
-
-	// set secsPerTick 
-	//   - basic: use MAX_SECS_PER_TICK
-	//   - advanced: base it on score (higher score results in lower secsPerTick)
-	// params: none
-	// return: nothing
-	void determineSecondsPerTick();
-
-
 };
 
 #endif /* TETRISGAME_H */
@@ -1,4 +1,71 @@
 #include "Tetromino.h"
+#include <assert.h>
+
+namespace
+{
+    // the color of each TetShape (indexed by TetShape)
+    constexpr TetColor SHAPE_COLORS[Tetromino::SHAPE_COUNT] = {
+        TetColor::RED,          // S
+        TetColor::GREEN,        // Z
+        TetColor::ORANGE,       // L
+        TetColor::BLUE_DARK,    // J
+        TetColor::YELLOW,       // O
+        TetColor::BLUE_LIGHT,   // I
+        TetColor::PURPLE        // T
+    };
+
+    // the blocks of each TetShape in its spawn orientation (indexed by TetShape)
+    constexpr BlockOffset SPAWN_OFFSETS[Tetromino::SHAPE_COUNT][Tetromino::BLOCK_COUNT] = {
+        { { 0, 1 }, { 0, 0 }, { 1, 1 }, { -1, 0 } },    // S
+        { { 0, 1 }, { 0, 0 }, { 1, 0 }, { -1, 1 } },    // Z
+        { { 0, 1 }, { 0, 0 }, { 0, -1 }, { 1, -1 } },   // L
+        { { 0, 1 }, { 0, 0 }, { -1, -1 }, { 0, -1 } },  // J
+        { { 0, 0 }, { 0, 1 }, { 1, 1 }, { 1, 0 } },     // O
+        { { 0, -1 }, { 0, 0 }, { 0, 1 }, { 0, 2 } },    // I
+        { { 0, -1 }, { 0, 0 }, { 1, 0 }, { -1, 0 } }    // T
+    };
+
+    // the blocks of every TetShape in each of its 4 rotation states
+    struct RotationTable
+    {
+        BlockOffset offsets[Tetromino::SHAPE_COUNT][Tetromino::ROTATION_COUNT][Tetromino::BLOCK_COUNT];
+    };
+
+    // build the rotation table (at compile time) from the spawn offsets:
+    //   each rotation state is the previous one rotated 90 degrees clockwise
+    //   around [0,0] ([x,y] becomes [y,-x]).  TetShape::O doesn't rotate, so
+    //   all of its states hold the spawn offsets.
+    constexpr RotationTable buildRotationTable()
+    {
+        RotationTable table{};
+        for (int shape = 0; shape < Tetromino::SHAPE_COUNT; shape++)
+        {
+            for (int block = 0; block < Tetromino::BLOCK_COUNT; block++)
+            {
+                table.offsets[shape][0][block] = SPAWN_OFFSETS[shape][block];
+            }
+            for (int rotation = 1; rotation < Tetromino::ROTATION_COUNT; rotation++)
+            {
+                for (int block = 0; block < Tetromino::BLOCK_COUNT; block++)
+                {
+                    const BlockOffset& previous = table.offsets[shape][rotation - 1][block];
+                    if (shape == static_cast<int>(TetShape::O))
+                        table.offsets[shape][rotation][block] = previous;
+                    else
+                        table.offsets[shape][rotation][block] = BlockOffset{ previous.y, -previous.x };
+                }
+            }
+        }
+        return table;
+    }
+
+    constexpr RotationTable ROTATION_TABLE = buildRotationTable();
+
+    // a T rotated clockwise once points its stem left ([0,-1] becomes [-1,0])
+    static_assert(ROTATION_TABLE.offsets[static_cast<int>(TetShape::T)][1][0].x == -1 &&
+        ROTATION_TABLE.offsets[static_cast<int>(TetShape::T)][1][0].y == 0,
+        "rotation table is not built at compile time");
+}
 
 Tetromino::Tetromino()
 {
@@ -19,91 +86,82 @@ TetShape Tetromino::getShape() const
 }
 
 // - set the shape
-// - set the blockLocs for the shape
+// - set the rotation to 0 (the spawn orientation)
+// - set the blockLocs for the shape (from the rotation table)
 // - set the color for the shape
 void Tetromino::setShape(TetShape shape)
 {
-    blockLocs.clear();
+    this->shape = shape;
+    color = getShapeColor(shape);
+    rotation = 0;
+    loadBlockLocs();
+}
+
+// the rotation state (0-3) of the shape, 0 being the spawn orientation.
+// (shape, rotation) identifies a shape's blocks, eg: as a cache key.
+int Tetromino::getRotation() const
+{
+    return rotation;
+}
+
+// set the rotation state (0-3) & the blockLocs for it (from the rotation table)
+// a TetShape::O always stays at rotation 0.
+void Tetromino::setRotation(int rotation)
+{
+    assert(rotation >= 0 && rotation < ROTATION_COUNT);
+    if (shape == TetShape::O)
+        return;
+    this->rotation = rotation;
+    loadBlockLocs();
+}
+
+// look up the block offsets of a shape in a given rotation state
+// in the (compile-time) rotation table
+// - param 1: TetShape the shape
+// - param 2: int the rotation state (0-3)
+// - return: a pointer to the BLOCK_COUNT offsets of the shape
+const BlockOffset* Tetromino::getRotationOffsets(TetShape shape, int rotation)
+{
+    return ROTATION_TABLE.offsets[static_cast<int>(shape)][rotation];
+}
+
+// gets the color a shape is drawn with
+TetColor Tetromino::getShapeColor(TetShape shape)
+{
+    return SHAPE_COLORS[static_cast<int>(shape)];
+}
 
-    switch (shape)
+// copy the (shape, rotation) blocks from the rotation table into blockLocs
+void Tetromino::loadBlockLocs()
+{
+    const BlockOffset* offsets = getRotationOffsets(shape, rotation);
+    blockLocs.clear();
+    for (int i = 0; i < BLOCK_COUNT; i++)
     {
-    case TetShape::S:
-        color = TetColor::RED;
-        blockLocs.push_back(Point(0, 1));
-        blockLocs.push_back(Point(0, 0));
-        blockLocs.push_back(Point(1, 1));
-        blockLocs.push_back(Point(-1, 0));
-        break;
-    case TetShape::Z:
-        color = TetColor::GREEN;
-        blockLocs.push_back(Point(0, 1));
-        blockLocs.push_back(Point(0, 0));
-        blockLocs.push_back(Point(1, 0));
-        blockLocs.push_back(Point(-1, 1));
-        break;
-    case TetShape::L:
-        color = TetColor::ORANGE;
-        blockLocs.push_back(Point(0, 1));
-        blockLocs.push_back(Point(0, 0));
-        blockLocs.push_back(Point(0, -1));
-        blockLocs.push_back(Point(1, -1));
-        break;
-    case TetShape::J:
-        color = TetColor::BLUE_DARK;
-        blockLocs.push_back(Point(0, 1));
-        blockLocs.push_back(Point(0, 0));
-        blockLocs.push_back(Point(-1, -1));
-        blockLocs.push_back(Point(0, -1));
-        break;
-    case TetShape::O:
-        color = TetColor::YELLOW;
-        blockLocs.push_back(Point(0, 0));
-        blockLocs.push_back(Point(0, 1));
-        blockLocs.push_back(Point(1, 1));
-        blockLocs.push_back(Point(1, 0));
-        break;
-    case TetShape::I:
-        color = TetColor::BLUE_LIGHT;
-        blockLocs.push_back(Point(0, -1));
-        blockLocs.push_back(Point(0, 0));
-        blockLocs.push_back(Point(0, 1));
-        blockLocs.push_back(Point(0, 2));
-        break;
-    case TetShape::T:
-        color = TetColor::PURPLE;
-        blockLocs.push_back(Point(0, -1));
-        blockLocs.push_back(Point(0, 0));
-        blockLocs.push_back(Point(1, 0));
-        blockLocs.push_back(Point(-1, 0));
-        break;
+        blockLocs.push_back(Point(offsets[i].x, offsets[i].y));
     }
-    this->shape = shape;
 }
 
 // gets a random shape for use on the board
 // returns a TetShape
 TetShape Tetromino::getRandomShape() {
-    return static_cast<TetShape>(rand() % 7);
+    return static_cast<TetShape>(rand() % SHAPE_COUNT);
 }
 
 // rotate the shape 90 degrees around [0,0] (clockwise)
 // to do this:
-// - iterate through blockLocs
-// - rotate each Point 90 degrees clockwise around [0,0]
-// hint: as you rotate the point [1,2] clockwise around [0,0], note
-// how the x,y values change. Once you find the pattern you can use
-// a couple existing methods in the Point class to accomplish this.
+// - advance the rotation state (wrapping from 3 back to 0)
+// - load the blockLocs of the new rotation from the rotation table
+//   (each rotation state holds the previous state's points rotated
+//   90 degrees clockwise around [0,0]: [x,y] becomes [y,-x])
 // make it so that the TetShape::O doesn’t rotate
 void Tetromino::rotateClockwise()
 {
     if (shape == TetShape::O)
         return;
 
-    for (int i = 0; i < blockLocs.size(); i++)
-    {
-        blockLocs.at(i).multiplyX(-1);
-        blockLocs.at(i).swapXY();
-    }
+    rotation = (rotation + 1) % ROTATION_COUNT;
+    loadBlockLocs();
 }
 
 // print a grid to display the current shape
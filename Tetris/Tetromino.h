@@ -2,6 +2,7 @@
 #define TETROMINO_H
 
 #include <vector>
+#include "BlockList.h"
 #include "Point.h"
 
 enum class TetColor
@@ -25,14 +26,30 @@ enum class TetShape
     T
 };
 
+// a block's [x,y] offset from a tetromino's origin ([0,0]), as stored in the
+// rotation table.  (A plain struct so the table can be built at compile time.)
+struct BlockOffset
+{
+    int x;
+    int y;
+};
+
 class Tetromino
 {
     //friend class GridTetromino;
+    friend class TestSuite;
+
+public:
+    // CONSTANTS
+    static const int SHAPE_COUNT{ 7 };      // the number of TetShapes
+    static const int ROTATION_COUNT{ 4 };   // the number of rotation states of a shape
+    static const int BLOCK_COUNT{ 4 };      // the number of blocks in a shape
 
 protected:
     TetColor color;
     TetShape shape;
-    std::vector<Point> blockLocs;
+    int rotation;           // the rotation state (0 - spawn, each clockwise turn adds 1)
+    BlockList blockLocs;    // the 4 blocks, stored inline (copying a Tetromino never allocates)
 
 public:
     Tetromino();
@@ -40,25 +57,49 @@ public:
     TetColor getColor() const;
     TetShape getShape() const;
 
+    // the rotation state (0-3) of the shape, 0 being the spawn orientation.
+    // (shape, rotation) identifies a shape's blocks, eg: as a cache key.
+    int getRotation() const;
+
     // - set the shape
-    // - set the blockLocs for the shape
+    // - set the rotation to 0 (the spawn orientation)
+    // - set the blockLocs for the shape (from the rotation table)
     // - set the color for the shape
     void setShape(TetShape shape);
 
+    // set the rotation state (0-3) & the blockLocs for it (from the rotation table)
+    // a TetShape::O always stays at rotation 0.
+    void setRotation(int rotation);
+
+    // look up the block offsets of a shape in a given rotation state
+    // in the (compile-time) rotation table
+    // - param 1: TetShape the shape
+    // - param 2: int the rotation state (0-3)
+    // - return: a pointer to the BLOCK_COUNT offsets of the shape
+    static const BlockOffset* getRotationOffsets(TetShape shape, int rotation);
+
+    // gets the color a shape is drawn with
+    static TetColor getShapeColor(TetShape shape);
+
     // gets a random shape for use on the board
     // returns a TetShape
     static TetShape getRandomShape();
 
     // rotate the shape 90 degrees around [0,0] (clockwise)
     // to do this:
-    // - iterate through blockLocs
-    // - rotate each Point 90 degrees clockwise around [0,0]
-    // hint: as you rotate the point [1,2] clockwise around [0,0], note
-    // how the x,y values change. Once you find the pattern you can use
-    // a couple existing methods in the Point class to accomplish this.
+    // - advance the rotation state (wrapping from 3 back to 0)
+    // - load the blockLocs of the new rotation from the rotation table
+    //   (each rotation state holds the previous state's points rotated
+    //   90 degrees clockwise around [0,0]: [x,y] becomes [y,-x])
     // make it so that the TetShape::O doesn’t rotate
     void rotateClockwise();
 
+private:
+    // copy the (shape, rotation) blocks from the rotation table into blockLocs
+    void loadBlockLocs();
+
+public:
+
     // print a grid to display the current shape
     // to do this: print out a “grid” of text to represent a co-ordinate
     // system. Start at top left [-3,3] go to bottom right [3,-3]
@@ -0,0 +1,113 @@
+#include "TranspositionTable.h"
+#include <cstring>
+#include "Random.h"
+
+namespace
+{
+	// the keys mixed into a board hash for the current (0) & next (1) shapes,
+	// & for a board alone (a fixed splitmix64 stream, like the board's keys)
+	struct ShapeKeys
+	{
+		std::uint64_t shapes[2][Tetromino::SHAPE_COUNT];
+		std::uint64_t boardOnly;
+
+		ShapeKeys()
+		{
+			std::uint64_t state = 0x7A8E5EEDull;
+			for (auto& keys : shapes)
+			{
+				for (std::uint64_t& key : keys)
+				{
+					key = Random::splitMix64(state);
+				}
+			}
+			boardOnly = Random::splitMix64(state);
+		}
+	};
+
+	const ShapeKeys& getShapeKeys()
+	{
+		static const ShapeKeys keys;
+		return keys;
+	}
+
+	// an empty entry's words agree with key 0, so 0 is never a key
+	std::uint64_t nonZero(std::uint64_t key)
+	{
+		return key ? key : 1;
+	}
+}
+
+// constructor, an empty table
+// - param 1: the log2 of the number of entries (eg: 16 for 65536 entries)
+TranspositionTable::TranspositionTable(int sizeBits) :
+	entries{ new Entry[std::size_t(1) << sizeBits] }, indexMask{ (std::uint64_t(1) << sizeBits) - 1 }
+{
+	clear();
+}
+
+// the key of a position: a board & the shapes to place on it
+// - param 1: the board's hash (Gameboard::getHash())
+// - param 2: the current shape
+// - param 3: the next shape
+// - return: a 64 bit key (never 0)
+std::uint64_t TranspositionTable::makeKey(std::uint64_t boardHash, TetShape current, TetShape next)
+{
+	const ShapeKeys& keys = getShapeKeys();
+	return nonZero(boardHash ^ keys.shapes[0][static_cast<int>(current)] ^ keys.shapes[1][static_cast<int>(next)]);
+}
+
+// the key of a board alone (for results that don't depend on the shapes)
+// - param 1: the board's hash (Gameboard::getHash())
+// - return: a 64 bit key (never 0, & never the key of a position)
+std::uint64_t TranspositionTable::makeKey(std::uint64_t boardHash)
+{
+	return nonZero(boardHash ^ getShapeKeys().boardOnly);
+}
+
+// look a key up
+// - param 1: the key
+// - param 2: the value stored with the key (only set on a hit)
+// - return: bool, true if the key's value was found
+bool TranspositionTable::probe(std::uint64_t key, double& value) const
+{
+	// the entry is picked with the high bits, so the low bits still tell keys apart
+	const Entry& entry = entries[(key >> 32) & indexMask];
+	const std::uint64_t check = entry.check.load(std::memory_order_relaxed);
+	const std::uint64_t bits = entry.value.load(std::memory_order_relaxed);
+	if ((check ^ bits) != key)
+		return false;
+	std::memcpy(&value, &bits, sizeof(value));
+	return true;
+}
+
+// store a value, replacing the entry the key maps to
+// - param 1: the key
+// - param 2: the value
+// - return: nothing
+void TranspositionTable::store(std::uint64_t key, double value)
+{
+	std::uint64_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	Entry& entry = entries[(key >> 32) & indexMask];
+	entry.value.store(bits, std::memory_order_relaxed);
+	entry.check.store(key ^ bits, std::memory_order_relaxed);
+}
+
+// forget every value (not thread safe: no search may be using the table)
+// - params: none
+// - return: nothing
+void TranspositionTable::clear()
+{
+	for (std::size_t i = 0; i <= indexMask; i++)
+	{
+		entries[i].check.store(0, std::memory_order_relaxed);
+		entries[i].value.store(0, std::memory_order_relaxed);
+	}
+}
+
+// the number of entries
+std::size_t TranspositionTable::getSize() const
+{
+	return static_cast<std::size_t>(indexMask + 1);
+}
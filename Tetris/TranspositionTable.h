@@ -0,0 +1,80 @@
+// The TranspositionTable class caches search results by position, so a search that
+// reaches a position it has already scored (eg: the same board, reached by placing
+// two pieces in the other order) can reuse the score instead of computing it again.
+//
+// A position is keyed on a board's occupancy hash (Gameboard::getHash()) combined with
+// the current & next shapes (makeKey()), or on the board alone for results that only
+// depend on the board (eg: a board evaluation).  The table has a fixed number of
+// entries (a power of 2), chosen at construction: nothing is allocated while searching.
+// A key always maps to the same entry, and a store replaces whatever the entry held.
+//
+// The table is shared by the threads of a search without any lock: each entry is two
+// atomic 64 bit words, the value & (key XOR value).  A probe only reports a hit if
+// the words it read agree with the key, so a probe that races with a store (and reads
+// one word of each) sees a miss, never a wrong value.
+
+#ifndef TRANSPOSITIONTABLE_H
+#define TRANSPOSITIONTABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include "Tetromino.h"
+
+class TranspositionTable
+{
+public:
+	// CONSTANTS
+	static const int DEFAULT_SIZE_BITS{ 16 };	// the default table: 2^16 entries (1 MB)
+
+private:
+	// one cached result: the value, & the key XOR the value (see probe())
+	struct Entry
+	{
+		std::atomic<std::uint64_t> check;
+		std::atomic<std::uint64_t> value;
+	};
+
+	// MEMBER VARIABLES
+	std::unique_ptr<Entry[]> entries;	// the table
+	std::uint64_t indexMask;			// the entry count - 1
+
+public:
+	// constructor, an empty table
+	// - param 1: the log2 of the number of entries (eg: 16 for 65536 entries)
+	explicit TranspositionTable(int sizeBits = DEFAULT_SIZE_BITS);
+
+	// the key of a position: a board & the shapes to place on it
+	// - param 1: the board's hash (Gameboard::getHash())
+	// - param 2: the current shape
+	// - param 3: the next shape
+	// - return: a 64 bit key (never 0)
+	static std::uint64_t makeKey(std::uint64_t boardHash, TetShape current, TetShape next);
+
+	// the key of a board alone (for results that don't depend on the shapes)
+	// - param 1: the board's hash (Gameboard::getHash())
+	// - return: a 64 bit key (never 0, & never the key of a position)
+	static std::uint64_t makeKey(std::uint64_t boardHash);
+
+	// look a key up
+	// - param 1: the key
+	// - param 2: the value stored with the key (only set on a hit)
+	// - return: bool, true if the key's value was found
+	bool probe(std::uint64_t key, double& value) const;
+
+	// store a value, replacing the entry the key maps to
+	// - param 1: the key
+	// - param 2: the value
+	// - return: nothing
+	void store(std::uint64_t key, double value);
+
+	// forget every value (not thread safe: no search may be using the table)
+	// - params: none
+	// - return: nothing
+	void clear();
+
+	// the number of entries
+	std::size_t getSize() const;
+};
+
+#endif /* TRANSPOSITIONTABLE_H */
@@ -0,0 +1,98 @@
+#include "UndoStack.h"
+#include <algorithm>
+#include <cassert>
+
+// lock a shape's blocks onto a board (remembering what the locations held)
+// - param 1: the board
+// - param 2: the locations (eg: GridTetromino::getMappedBlockLocs(), invalid ones are ignored)
+// - param 3: the content to lock (eg: the shape's color)
+// - return: nothing
+void UndoStack::lock(Gameboard& board, const BlockList& cells, int value)
+{
+	if (depth == records.size())
+		records.emplace_back();
+	Record& record = records[depth++];
+	record.cells = cells;
+	record.rowsRemoved = Gameboard::RowClearResult{ 0, 0 };
+	for (int i = 0; i < cells.size(); i++)
+	{
+		const Point& p = cells[i];
+		const bool valid = p.getX() >= 0 && p.getX() < Gameboard::MAX_X && p.getY() >= 0 && p.getY() < Gameboard::MAX_Y;
+		record.previous[i] = static_cast<std::int8_t>(valid ? board.getContent(p) : Gameboard::EMPTY_BLOCK);
+	}
+	board.setContent(cells, value);
+}
+
+// remove the rows the last lock() completed (remembering their contents)
+//   Call it at most once per lock(), before the next lock().
+// - param 1: the board
+// - return: int, the number of rows removed
+int UndoStack::removeCompletedRows(Gameboard& board)
+{
+	assert(depth > 0 && "UndoStack::removeCompletedRows() - nothing was locked");
+	Record& record = records[depth - 1];
+
+	// only the rows of the locked blocks can be completed (the board had none before)
+	int top = Gameboard::MAX_Y;
+	int bottom = -1;
+	for (const Point& p : record.cells)
+	{
+		top = std::min(top, p.getY());
+		bottom = std::max(bottom, p.getY());
+	}
+	int saved = 0;
+	for (int y = std::max(top, 0); y <= bottom && y < Gameboard::MAX_Y; y++)
+	{
+		if (board.getRowMask(y) != Gameboard::FULL_ROW_MASK)
+			continue;
+		assert(saved < MAX_ROWS_REMOVED);
+		for (int x = 0; x < Gameboard::MAX_X; x++)
+		{
+			record.removedRows[saved][x] = static_cast<std::int8_t>(board.getContent(x, y));
+		}
+		saved++;
+	}
+	if (saved == 0)
+		return 0;
+
+	record.rowsRemoved = board.compactCompletedRows();
+	assert(record.rowsRemoved.count == saved && "UndoStack - the board had a completed row before the placement");
+	return record.rowsRemoved.count;
+}
+
+// lock() then removeCompletedRows()
+// - params: see lock()
+// - return: int, the number of rows removed
+int UndoStack::place(Gameboard& board, const BlockList& cells, int value)
+{
+	lock(board, cells, value);
+	return removeCompletedRows(board);
+}
+
+// take back the last placement: put back the rows it removed & empty its locations
+// - param 1: the board the placement was made on
+// - return: nothing
+void UndoStack::undo(Gameboard& board)
+{
+	assert(depth > 0 && "UndoStack::undo() - nothing to undo");
+	const Record& record = records[--depth];
+	board.restoreCompletedRows(record.rowsRemoved, record.removedRows);
+	for (int i = 0; i < record.cells.size(); i++)
+	{
+		board.setContent(record.cells[i], record.previous[i]);
+	}
+}
+
+// the number of placements that can be undone
+std::size_t UndoStack::size() const
+{
+	return depth;
+}
+
+// forget every placement (they can't be undone anymore)
+// - params: none
+// - return: nothing
+void UndoStack::clear()
+{
+	depth = 0;
+}
@@ -0,0 +1,76 @@
+// The UndoStack class makes placements on a Gameboard that can be taken back, so a
+// search can walk down a line of placements on a single board and back up it again,
+// instead of copying the board for every placement it tries.
+//
+// For each placement it records only what the placement changed: the (at most 4)
+// locations the shape's blocks were locked onto, with what they held before, and the
+// contents of the rows the placement completed (which were removed).  Undoing puts
+// the removed rows back (Gameboard::restoreCompletedRows()) and then empties the
+// locked locations.  The records are kept in a vector that only ever grows to the
+// deepest line searched, so placing & undoing don't allocate.
+//
+// The board must have no completed row before a placement (like a game's board), so
+// a placement removes at most 4 rows.  Placements are undone in the reverse order
+// they were made (a stack), on the board they were made on.
+
+#ifndef UNDOSTACK_H
+#define UNDOSTACK_H
+
+#include <cstdint>
+#include <vector>
+#include "BlockList.h"
+#include "Gameboard.h"
+
+class UndoStack
+{
+private:
+	// CONSTANTS
+	static const int MAX_ROWS_REMOVED{ BlockList::CAPACITY };	// a placement completes at most one row per block
+
+	// how to undo one placement
+	struct Record
+	{
+		BlockList cells;									// the locations the blocks were locked onto
+		std::int8_t previous[BlockList::CAPACITY];			// what each location held before
+		Gameboard::RowClearResult rowsRemoved;				// the rows the placement removed (if any)
+		std::int8_t removedRows[MAX_ROWS_REMOVED][Gameboard::MAX_X];	// their contents, top row first
+	};
+
+	// MEMBER VARIABLES
+	std::vector<Record> records;	// the placements made, the last one on top
+	std::size_t depth{ 0 };			// the number of records in use
+
+public:
+	// lock a shape's blocks onto a board (remembering what the locations held)
+	// - param 1: the board
+	// - param 2: the locations (eg: GridTetromino::getMappedBlockLocs(), invalid ones are ignored)
+	// - param 3: the content to lock (eg: the shape's color)
+	// - return: nothing
+	void lock(Gameboard& board, const BlockList& cells, int value);
+
+	// remove the rows the last lock() completed (remembering their contents)
+	//   Call it at most once per lock(), before the next lock().
+	// - param 1: the board
+	// - return: int, the number of rows removed
+	int removeCompletedRows(Gameboard& board);
+
+	// lock() then removeCompletedRows()
+	// - params: see lock()
+	// - return: int, the number of rows removed
+	int place(Gameboard& board, const BlockList& cells, int value);
+
+	// take back the last placement: put back the rows it removed & empty its locations
+	// - param 1: the board the placement was made on
+	// - return: nothing
+	void undo(Gameboard& board);
+
+	// the number of placements that can be undone
+	std::size_t size() const;
+
+	// forget every placement (they can't be undone anymore)
+	// - params: none
+	// - return: nothing
+	void clear();
+};
+
+#endif /* UNDOSTACK_H */
@@ -0,0 +1,109 @@
+// Variable length integers (LEB128) for the compact binary formats (eg: Replay):
+// 7 bits per byte, low bits first, the high bit of a byte set when more bytes follow.
+// Values below 128 take 1 byte, below 16384 take 2, and a 64 bit value at most 10.
+
+#ifndef VARINT_H
+#define VARINT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// the most bytes a 64 bit varint takes
+const int MAX_VARINT_BYTES{ 10 };
+
+// append a varint to a byte buffer
+// - param 1: the buffer
+// - param 2: the value
+// - return: nothing
+inline void appendVarint(std::vector<std::uint8_t>& bytes, std::uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		bytes.push_back(static_cast<std::uint8_t>(value | 0x80));
+		value >>= 7;
+	}
+	bytes.push_back(static_cast<std::uint8_t>(value));
+}
+
+// read a varint from a byte range
+// - param 1: the next byte to read (moved past the varint)
+// - param 2: the end of the range
+// - param 3: the value read
+// - return: bool, false if the range ends inside the varint (or it is longer than 10 bytes)
+inline bool readVarint(const std::uint8_t*& at, const std::uint8_t* end, std::uint64_t& value)
+{
+	value = 0;
+	for (int shift = 0; shift < 7 * MAX_VARINT_BYTES && at < end; shift += 7)
+	{
+		const std::uint8_t byte = *at++;
+		value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+		if (!(byte & 0x80))
+			return true;
+	}
+	return false;
+}
+
+// append a 64 bit value to a byte buffer (8 bytes, little endian: for values that are
+// random, like seeds & hashes, which a varint would make longer)
+// - param 1: the buffer
+// - param 2: the value
+// - return: nothing
+inline void appendFixed64(std::vector<std::uint8_t>& bytes, std::uint64_t value)
+{
+	for (int i = 0; i < 8; i++)
+	{
+		bytes.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+	}
+}
+
+// read a 64 bit value written by appendFixed64()
+// - param 1: the next byte to read (moved past the value)
+// - param 2: the end of the range
+// - param 3: the value read
+// - return: bool, false if the range is too short
+inline bool readFixed64(const std::uint8_t*& at, const std::uint8_t* end, std::uint64_t& value)
+{
+	if (end - at < 8)
+		return false;
+	value = 0;
+	for (int i = 0; i < 8; i++)
+	{
+		value |= static_cast<std::uint64_t>(at[i]) << (8 * i);
+	}
+	at += 8;
+	return true;
+}
+
+// append a 32 bit value to a byte buffer (4 bytes, little endian: for the fixed size
+// records of an index, which are read in place)
+// - param 1: the buffer
+// - param 2: the value
+// - return: nothing
+inline void appendFixed32(std::vector<std::uint8_t>& bytes, std::uint32_t value)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		bytes.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+	}
+}
+
+// read a 32 bit value written by appendFixed32()
+// - param 1: the next byte to read (moved past the value)
+// - param 2: the end of the range
+// - param 3: the value read
+// - return: bool, false if the range is too short
+inline bool readFixed32(const std::uint8_t*& at, const std::uint8_t* end, std::uint32_t& value)
+{
+	if (end - at < 4)
+		return false;
+	value = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		value |= static_cast<std::uint32_t>(at[i]) << (8 * i);
+	}
+	at += 4;
+	return true;
+}
+
+#endif /* VARINT_H */
@@ -0,0 +1,149 @@
+#include "WorkStealingPool.h"
+#include <algorithm>
+
+// constructor, start the worker threads
+// - param 1: the number of threads (0 to use every hardware thread)
+WorkStealingPool::WorkStealingPool(int threadCount)
+{
+	if (threadCount <= 0)
+		threadCount = static_cast<int>(std::thread::hardware_concurrency());
+	this->threadCount = std::max(threadCount, 1);
+
+	queues.reset(new WorkerQueue[this->threadCount]);
+	threads.reserve(this->threadCount);
+	for (int worker = 0; worker < this->threadCount; worker++)
+	{
+		threads.emplace_back(&WorkStealingPool::workerLoop, this, worker);
+	}
+}
+
+// destructor, stop & join the worker threads
+WorkStealingPool::~WorkStealingPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		stopping = true;
+	}
+	jobStarted.notify_all();
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+}
+
+// the number of worker threads
+int WorkStealingPool::getThreadCount() const
+{
+	return threadCount;
+}
+
+// run task(index, worker) for every index in [0, count) on the workers,
+// and wait until every iteration is done.
+//   Iterations are handed out grainSize at a time. Must not be called from a task.
+// - param 1: the number of iterations
+// - param 2: the loop body
+// - param 3: the number of iterations per chunk (>= 1)
+// - return: nothing
+void WorkStealingPool::parallelFor(std::int64_t count, const Task& task, std::int64_t grainSize)
+{
+	if (count <= 0)
+		return;
+	grainSize = std::max<std::int64_t>(grainSize, 1);
+
+	std::lock_guard<std::mutex> parallelForLock(parallelForMutex);
+	std::unique_lock<std::mutex> lock(jobMutex);
+
+	// deal the chunks out: worker w gets the w'th contiguous run of them
+	const std::int64_t chunkCount = (count + grainSize - 1) / grainSize;
+	for (int worker = 0; worker < threadCount; worker++)
+	{
+		const std::int64_t first = chunkCount * worker / threadCount;
+		const std::int64_t last = chunkCount * (worker + 1) / threadCount;
+
+		std::lock_guard<std::mutex> queueLock(queues[worker].mutex);
+		for (std::int64_t c = first; c < last; c++)
+		{
+			queues[worker].chunks.push_back(Chunk{ c * grainSize, std::min(count, (c + 1) * grainSize) });
+		}
+	}
+
+	this->task = &task;
+	remainingChunks = chunkCount;
+	jobGeneration++;
+	jobStarted.notify_all();
+
+	// wait for the last chunk, and for every worker to leave the job (so none of them
+	// can take a chunk of the next job while still holding this job's task)
+	jobFinished.wait(lock, [this] { return remainingChunks == 0 && busyWorkers == 0; });
+	this->task = nullptr;
+}
+
+// a worker thread's loop: wait for a job, run chunks until none are left, repeat
+// - param 1: the worker's index
+// - return: nothing
+void WorkStealingPool::workerLoop(int worker)
+{
+	std::uint64_t generationSeen = 0;
+	while (true)
+	{
+		const Task* job;
+		{
+			std::unique_lock<std::mutex> lock(jobMutex);
+			jobStarted.wait(lock, [&] { return stopping || jobGeneration != generationSeen; });
+			if (stopping)
+				return;
+			generationSeen = jobGeneration;
+			job = task;
+			if (job == nullptr)		// woke up after the job was over
+				continue;
+			busyWorkers++;
+		}
+
+		Chunk chunk;
+		while (takeChunk(worker, chunk))
+		{
+			for (std::int64_t index = chunk.begin; index < chunk.end; index++)
+			{
+				(*job)(index, worker);
+			}
+			remainingChunks--;
+		}
+
+		std::lock_guard<std::mutex> lock(jobMutex);
+		busyWorkers--;
+		if (busyWorkers == 0 && remainingChunks == 0)
+			jobFinished.notify_all();
+	}
+}
+
+// take a chunk from the worker's own queue (newest first), or steal one
+// from another worker's queue (oldest first)
+// - param 1: the worker's index
+// - param 2: the chunk taken (set when true is returned)
+// - return: bool, false if every queue is empty
+bool WorkStealingPool::takeChunk(int worker, Chunk& chunk)
+{
+	{
+		WorkerQueue& own = queues[worker];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.chunks.empty())
+		{
+			chunk = own.chunks.back();
+			own.chunks.pop_back();
+			return true;
+		}
+	}
+
+	for (int i = 1; i < threadCount; i++)
+	{
+		WorkerQueue& victim = queues[(worker + i) % threadCount];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.chunks.empty())
+		{
+			chunk = victim.chunks.front();
+			victim.chunks.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,106 @@
+// The WorkStealingPool class is a set of persistent worker threads that run the
+// iterations of a parallel loop (parallelFor()).
+//
+// The iterations are cut into chunks, and the chunks are dealt out to one queue per
+// worker up front (contiguous runs, so neighbouring iterations stay on one thread).
+// A worker takes chunks from the back of its own queue; when it runs out it steals
+// from the front of another worker's queue.  So the load balances itself when some
+// iterations (eg: games) take much longer than others, while the queues are only
+// contended when a worker is stealing.
+//
+// Every worker has a fixed index in [0, getThreadCount()), passed to the loop body,
+// so callers can give each worker its own (thread-local) state by indexing an array.
+// The threads are started once and reused by every parallelFor() call.
+
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkStealingPool
+{
+public:
+	// the body of a parallel loop
+	// - param 1: the iteration index
+	// - param 2: the index of the worker running it, in [0, getThreadCount())
+	using Task = std::function<void(std::int64_t index, int worker)>;
+
+private:
+	// a run of iterations [begin, end)
+	struct Chunk
+	{
+		std::int64_t begin;
+		std::int64_t end;
+	};
+
+	// one worker's queue of chunks (padded onto its own cache lines, so the
+	// workers don't slow each other down when they take from their own queues)
+	struct WorkerQueue
+	{
+		std::mutex mutex;
+		std::deque<Chunk> chunks;
+		char padding[64];
+	};
+
+	// MEMBER VARIABLES
+	std::vector<std::thread> threads;					// the worker threads
+	std::unique_ptr<WorkerQueue[]> queues;				// a queue per worker
+	int threadCount;									// the number of worker threads
+
+	std::mutex jobMutex;								// guards the job members below
+	std::condition_variable jobStarted;					// signalled when a job is posted (or on shutdown)
+	std::condition_variable jobFinished;				// signalled when the last chunk of a job is done
+	const Task* task{ nullptr };						// the body of the running job
+	std::uint64_t jobGeneration{ 0 };					// bumped for every job, so a worker runs each one once
+	std::atomic<std::int64_t> remainingChunks{ 0 };		// the chunks of the running job not done yet
+	int busyWorkers{ 0 };								// the workers running chunks of the job
+	bool stopping{ false };								// set by the destructor
+
+	std::mutex parallelForMutex;						// one parallelFor() at a time
+
+public:
+	// constructor, start the worker threads
+	// - param 1: the number of threads (0 to use every hardware thread)
+	explicit WorkStealingPool(int threadCount = 0);
+
+	// destructor, stop & join the worker threads
+	~WorkStealingPool();
+
+	WorkStealingPool(const WorkStealingPool&) = delete;
+	WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+	// the number of worker threads
+	int getThreadCount() const;
+
+	// run task(index, worker) for every index in [0, count) on the workers,
+	// and wait until every iteration is done.
+	//   Iterations are handed out grainSize at a time. Must not be called from a task.
+	// - param 1: the number of iterations
+	// - param 2: the loop body
+	// - param 3: the number of iterations per chunk (>= 1)
+	// - return: nothing
+	void parallelFor(std::int64_t count, const Task& task, std::int64_t grainSize = 1);
+
+private:
+	// a worker thread's loop: wait for a job, run chunks until none are left, repeat
+	// - param 1: the worker's index
+	// - return: nothing
+	void workerLoop(int worker);
+
+	// take a chunk from the worker's own queue (newest first), or steal one
+	// from another worker's queue (oldest first)
+	// - param 1: the worker's index
+	// - param 2: the chunk taken (set when true is returned)
+	// - return: bool, false if every queue is empty
+	bool takeChunk(int worker, Chunk& chunk);
+};
+
+#endif /* WORKSTEALINGPOOL_H */